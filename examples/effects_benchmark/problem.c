@@ -0,0 +1,210 @@
+/**
+ * Effects benchmark with hardware performance counters
+ *
+ * This example times representative REBOUNDx kernels for increasing numbers of particles:
+ * the center-of-mass force path (rebx_com_force, through modify_orbits_forces), gr, the
+ * iterative gr_full solver, and the particle parameter lookup (rebx_get_param).
+ * On Linux, each kernel is also wrapped with perf_event_open counters for cycles,
+ * instructions, cache misses and branch misses, and the table reports instructions per
+ * cycle (IPC) and misses per particle alongside the throughput. If the counters can't be
+ * opened (other operating systems, containers, or /proc/sys/kernel/perf_event_paranoid
+ * too high), the affected columns print "-" and only timings are reported.
+ *
+ * Counters measure the calling thread only, so run with OMP_NUM_THREADS=1 when compiling
+ * with OPENMP=1 to get meaningful per-particle counts.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <sys/time.h>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#include "rebound.h"
+#include "reboundx.h"
+
+enum counter {CYCLES, INSTRUCTIONS, CACHE_MISSES, BRANCH_MISSES, NCOUNTERS};
+
+static int counter_fds[NCOUNTERS] = {-1, -1, -1, -1};
+
+static double walltime(){
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + 1.e-6*tv.tv_usec;
+}
+
+// Opens each counter separately, so e.g. cache misses missing in a VM doesn't disable the others
+static void open_counters(){
+#ifdef __linux__
+    const uint64_t configs[NCOUNTERS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+    for (int i=0; i<NCOUNTERS; i++){
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = configs[i];
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        counter_fds[i] = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0); // this thread, any cpu
+    }
+#endif
+}
+
+static void close_counters(){
+#ifdef __linux__
+    for (int i=0; i<NCOUNTERS; i++){
+        if (counter_fds[i] >= 0){
+            close(counter_fds[i]);
+        }
+    }
+#endif
+}
+
+static void start_counters(){
+#ifdef __linux__
+    for (int i=0; i<NCOUNTERS; i++){
+        if (counter_fds[i] >= 0){
+            ioctl(counter_fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(counter_fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+}
+
+// Stores the counts in counts, or -1 for counters that aren't available
+static void stop_counters(double* counts){
+    for (int i=0; i<NCOUNTERS; i++){
+        counts[i] = -1.;
+#ifdef __linux__
+        uint64_t value;
+        if (counter_fds[i] >= 0){
+            ioctl(counter_fds[i], PERF_EVENT_IOC_DISABLE, 0);
+            if (read(counter_fds[i], &value, sizeof(value)) == sizeof(value)){
+                counts[i] = (double)value;
+            }
+        }
+#endif
+    }
+}
+
+struct benchmark {
+    const char* name;
+    int Nmax;                                           // skip larger N (e.g., for O(N^2) kernels)
+    int quadratic;                                      // 1 if the kernel costs O(N^2) per call rather than O(N)
+    struct rebx_force* (*setup)(struct reb_simulation* sim, struct rebx_extras* rebx);
+    void (*run)(struct reb_simulation* sim, struct rebx_force* force);
+};
+
+static struct rebx_force* setup_com_force(struct reb_simulation* sim, struct rebx_extras* rebx){
+    struct rebx_force* mof = rebx_load_force(rebx, "modify_orbits_forces");
+    for (int i=1; i<sim->N; i++){
+        rebx_set_param_double(rebx, &sim->particles[i].ap, "tau_a", -1.e4);
+        rebx_set_param_double(rebx, &sim->particles[i].ap, "tau_e", -1.e3);
+    }
+    return mof;
+}
+
+static struct rebx_force* setup_gr(struct reb_simulation* sim, struct rebx_extras* rebx){
+    struct rebx_force* gr = rebx_load_force(rebx, "gr");
+    rebx_set_param_double(rebx, &gr->ap, "c", 10065.32);
+    return gr;
+}
+
+static struct rebx_force* setup_gr_full(struct reb_simulation* sim, struct rebx_extras* rebx){
+    struct rebx_force* gr_full = rebx_load_force(rebx, "gr_full");
+    rebx_set_param_double(rebx, &gr_full->ap, "c", 10065.32);
+    return gr_full;
+}
+
+static void run_force(struct reb_simulation* sim, struct rebx_force* force){
+    force->update_accelerations(sim, force, sim->particles, sim->N);
+}
+
+static volatile double param_sum; // keeps the lookups from being optimized away
+
+static void run_param_lookup(struct reb_simulation* sim, struct rebx_force* force){
+    double sum = 0.;
+    for (int i=0; i<sim->N; i++){
+        const double* const tau_a = rebx_get_param(sim->extras, sim->particles[i].ap, "tau_a");
+        if (tau_a != NULL){
+            sum += *tau_a;
+        }
+    }
+    param_sum = sum;
+}
+
+static void print_count(const double count, const double norm){
+    if (count < 0.){
+        printf(" %12s", "-");
+    }
+    else{
+        printf(" %12.3f", count/norm);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    struct benchmark benchmarks[] = {
+        {"com_force", 1000000, 0, setup_com_force, run_force},
+        {"gr", 1000000, 0, setup_gr, run_force},
+        {"gr_full", 1000, 1, setup_gr_full, run_force},
+        {"get_param", 1000000, 0, setup_com_force, run_param_lookup},
+    };
+    const int Nbenchmarks = sizeof(benchmarks)/sizeof(benchmarks[0]);
+
+    open_counters();
+    if (counter_fds[CYCLES] < 0 && counter_fds[INSTRUCTIONS] < 0){
+        printf("Hardware counters not available, reporting timings only.\n");
+    }
+    printf("%10s %8s %12s %14s %12s %12s %12s\n", "effect", "N", "time [s]", "particles/s", "IPC", "cache/part", "branch/part");
+    for (int b=0; b<Nbenchmarks; b++){
+        for (int N=100; N<=benchmarks[b].Nmax; N*=10){
+            struct reb_simulation* sim = reb_create_simulation();
+            struct reb_particle star = {0};
+            star.m = 1.;
+            reb_add(sim, star);
+            for (int i=1; i<N; i++){
+                double a = 0.5 + 3.*(double)rand()/RAND_MAX;
+                double f = 2.*M_PI*(double)rand()/RAND_MAX;
+                struct reb_particle p = reb_tools_orbit_to_particle(sim->G, star, 1.e-9, a, 0.1, 0.05, 0., 0., f);
+                reb_add(sim, p);
+            }
+            struct rebx_extras* rebx = rebx_attach(sim);
+            struct rebx_force* force = benchmarks[b].setup(sim, rebx);
+
+            benchmarks[b].run(sim, force); // warm up caches and any parameter caches the effect builds
+            // Aim for about 1e7 particle (or pair) evaluations per kernel, so O(N^2) kernels don't run for minutes
+            const double cost = benchmarks[b].quadratic ? N*(double)N : N;
+            const int reps = 1e7/cost > 3 ? 1e7/cost : 3;
+            double counts[NCOUNTERS];
+            double start = walltime();
+            start_counters();
+            for (int r=0; r<reps; r++){
+                benchmarks[b].run(sim, force);
+            }
+            stop_counters(counts);
+            double t = (walltime() - start)/reps;
+
+            printf("%10s %8d %12.4e %14.4e", benchmarks[b].name, N, t, N/t);
+            if (counts[CYCLES] > 0. && counts[INSTRUCTIONS] >= 0.){
+                printf(" %12.3f", counts[INSTRUCTIONS]/counts[CYCLES]);
+            }
+            else{
+                printf(" %12s", "-");
+            }
+            print_count(counts[CACHE_MISSES], (double)reps*N);
+            print_count(counts[BRANCH_MISSES], (double)reps*N);
+            printf("\n");
+
+            rebx_free(rebx);
+            reb_free_simulation(sim);
+        }
+    }
+    close_counters();
+}
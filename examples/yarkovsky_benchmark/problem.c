@@ -0,0 +1,303 @@
+/**
+ * Yarkovsky effect benchmark
+ *
+ * This example times the Yarkovsky force evaluation for N = 10^3 to 10^6 asteroids,
+ * comparing the current implementation (cached parameters and batched kernels) with a copy
+ * of the original one (baseline_yarkovsky_effect below, which looks up every parameter on
+ * every call and processes one particle at a time), for both the simple (ye_flag = 1) and
+ * full (ye_flag = 0) versions of the effect. It also reports the largest relative difference
+ * between the two accelerations. It calls the forces directly so the timings don't include
+ * the integrator. Compile with OPENMP=1 to also thread the batched kernels across cores.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <sys/time.h>
+#include "rebound.h"
+#include "reboundx.h"
+
+static double walltime(){
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + 1.e-6*tv.tv_usec;
+}
+
+// Copy of the original implementation, for comparison
+
+static void baseline_calculate_yarkovsky_effect(struct reb_simulation* sim, struct reb_particle* target, struct reb_particle* star, double G, double *density, double *lstar, double *rotation_period, double *Gamma, double *albedo, double *emissivity, double *k, double *c, double *stef_boltz, int *yark_flag, double *sx, double *sy, double *sz){
+    
+    int i; //variables needed for future iteration loops
+    int j;
+    double unit_matrix[3][3] = {{1.0, 0.0, 0.0},{0.0, 1.0, 0.0},{0.0, 0.0, 1.0}};
+
+    double radius = target->r;
+    
+    double q_yar = 1.0-(*albedo);
+    
+    double dx = target->x - star->x;
+    double dy = target->y - star->y;
+    double dz = target->z - star->z;
+    
+    double dvx = target->vx - star->vx;
+    double dvy = target->vy - star->vy;
+    double dvz = target->vz - star->vz;
+    
+    double distance = sqrt((dx*dx)+(dy*dy)+(dz*dz)); //distance of asteroid from the star
+    
+    double rdotv = ((dx*dvx)+(dy*dvy)+(dz*dvz))/((*c)*distance); //dot product of position and velocity vectors- the term in the denominator is needed when calculating the i-vector
+    
+    double i_vector[3][1];
+    
+    i_vector[0][0] = ((1-rdotv)*(dx/distance))-(dvx/(*c));
+    i_vector[1][0] = ((1-rdotv)*(dy/distance))-(dvy/(*c));
+    i_vector[2][0] = ((1-rdotv)*(dz/distance))-(dvz/(*c));
+    
+    double yarkovsky_magnitude; //magnitude of force created by the effect
+
+    double yark_matrix[3][3] = {{0.0, 0.0, 0.0},{0.0, 0.0, 0.0},{0.0, 0.0, 0.0}};
+    
+    
+    if (*yark_flag == 1) {
+        
+        yark_matrix[1][0] = 1.0; // maximizes the effect pushing outwards
+        
+        yarkovsky_magnitude = (3*q_yar*(*lstar))/(64*M_PI*radius*(*density)*(*c)*distance*distance);
+    }
+    
+    if (*yark_flag == -1) {
+        
+        yark_matrix[0][1] = 1.0; //maximizes the effect pushing inwards
+        
+        yarkovsky_magnitude = (3*q_yar*(*lstar))/(64*M_PI*radius*(*density)*(*c)*distance*distance);
+    }
+    
+    //will run through full equations to create the yark_matrix
+    if (*yark_flag == 0) {
+        
+        //makes sure all necessary parameters have been entered
+        if (stef_boltz == NULL || rotation_period == NULL || Gamma == NULL || albedo == NULL || emissivity == NULL || k == NULL || sx == NULL || sy == NULL || sz == NULL) {
+            reb_error(sim, "REBOUNDx Error: One or more parameters missing for this version of the Yarkovsky effect in Rebx. Please make sure you've given values to all variables for this version before running simulations. See documentation and YarkovskyEffect.ipynb. If you'd rather use the simplified version of this effect (requires fewer parameters), then please set 'yark_flag' to -1 or 1.\n\n");
+            return;
+        }
+        
+        struct reb_orbit o = reb_tools_particle_to_orbit(G, *target, *star);
+        
+        yarkovsky_magnitude = (3*(*k)*q_yar*(*lstar))/(16*M_PI*radius*(*density)*(*c)*distance*distance);
+
+        double Smag = sqrt(((*sx)*(*sx))+ (*sy)*(*sy) + (*sz)*(*sz));
+    
+        double hx = (dy*dvz)-(dz*dvy);
+        double hy = (dz*dvx)-(dx*dvz);
+        double hz = (dx*dvy)-(dy*dvx);
+        double Hmag = sqrt((hx*hx)+ (hy*hy) + (hz*hz));
+    
+        double inv_smag = 1.0/Smag;
+        double inv_mag_sqrd = 1.0/(Smag*Smag);
+        double inv_hmag = 1.0/Hmag;
+        double inv_hmag_sqrd = 1.0/(Hmag*Hmag);
+    
+        double R1s[3][3] = {{0.0, -(*sz)*inv_smag, (*sy)*inv_smag},{(*sz)*inv_smag, 0.0, -(*sx)*inv_smag},{-(*sy)*inv_smag, (*sx)*inv_smag, 0.0}};
+        
+        double R2s[3][3] = {{(*sx)*(*sx)*inv_mag_sqrd, (*sx)*(*sy)*inv_mag_sqrd, (*sx)*(*sz)*inv_mag_sqrd},{(*sx)*(*sy)*inv_mag_sqrd, (*sy)*(*sy)*inv_mag_sqrd, (*sy)*(*sz)*inv_mag_sqrd},{(*sx)*(*sz)*inv_mag_sqrd, (*sy)*(*sz)*inv_mag_sqrd, (*sz)*(*sz)*inv_mag_sqrd}};
+        
+        double R1h[3][3] = {{0.0, -hz*inv_hmag, hy*inv_hmag},{hz*inv_hmag, 0.0, -hx*inv_hmag},{-hy*inv_hmag, hx*inv_hmag, 0.0}};
+        
+        double R2h[3][3] = {{hx*hx*inv_hmag_sqrd, hx*hy*inv_hmag_sqrd, hx*hz*inv_hmag_sqrd},{hx*hy*inv_hmag_sqrd, hy*hy*inv_hmag_sqrd, hy*hz*inv_hmag_sqrd},{hx*hz*inv_hmag_sqrd, hy*hz*inv_hmag_sqrd, hz*hz*inv_hmag_sqrd}};
+
+        double tanPhi = 1.0/(1.0+(.5*pow(((*stef_boltz)*(*emissivity))/(M_PI*M_PI*M_PI*M_PI*M_PI), .25))*sqrt((*rotation_period)/((*Gamma)*(*Gamma)))*pow((*lstar*q_yar)/(distance*distance), .75));
+    
+        double tanEpsilon = 1.0/(1.0+(.5*pow((*stef_boltz*(*emissivity))/(M_PI*M_PI*M_PI*M_PI*M_PI), .25))*sqrt((o.P)/((*Gamma)*(*Gamma)))*pow((*lstar*q_yar)/(distance*distance), .75));
+    
+        double Phi = atan(tanPhi);
+        double Epsilon = atan(tanEpsilon);
+        
+        double cos_phi = cos(Phi);
+        double sin_phi = sin(Phi);
+        double cos_epsilon = cos(Epsilon);
+        double sin_epsilon = sin(Epsilon);
+    
+        double Rys[3][3]; //diurnal conntribution for effect
+    
+        for (i=0; i<3; i++){
+            for (j=0; j<3; j++){
+                Rys[i][j] = (cos_phi*unit_matrix[i][j]) + (sin_phi*R1s[i][j]) + ((1.0-cos_phi)*R2s[i][j]);
+            }
+        }
+    
+        double Ryh[3][3];
+    
+        for (i=0; i<3; i++){ //seasonal contribution for effect
+            for (j=0; j<3; j++){
+                Ryh[i][j] = (cos_epsilon*unit_matrix[i][j]) - (sin_epsilon*R1h[i][j]) + ((1-cos_epsilon)*R2h[i][j]);
+            }
+        }
+    
+        for (i=0; i<3; i++){
+            for(j=0; j<3; j++){
+                yark_matrix[i][j] = (Rys[i][0]*Ryh[0][j]) + (Rys[i][1]*Ryh[1][j]) + (Rys[i][2]*Ryh[2][j]);
+            }
+        }
+    }
+    
+    double direction_matrix[3][1];
+    
+ 
+    
+    //calcuates a vector which gives the direction of the acceleration created by the effect
+    for (i=0; i<3; i++){
+        direction_matrix[i][0] = (yark_matrix[i][0]*i_vector[0][0]) + (yark_matrix[i][1]*i_vector[1][0]) + (yark_matrix[i][2]*i_vector[2][0]);
+    }
+    
+    double yarkovsky_acceleration[3][1];
+    
+    for (i=0; i<3; i++){
+     
+        //final result for particle's change in acceleration due to the effect
+        yarkovsky_acceleration[i][0] = (yarkovsky_magnitude*direction_matrix[i][0]);
+        
+    }
+    
+        //adds Yarkovsky aceleration to the asteroid's acceleration in the sim
+        target->ax += yarkovsky_acceleration[0][0];
+        target->ay += yarkovsky_acceleration[1][0];
+        target->az += yarkovsky_acceleration[2][0];
+    
+    
+    
+    }
+
+static void baseline_yarkovsky_effect(struct reb_simulation* const sim, struct rebx_force* const force, struct reb_particle* const particles, const int N){
+        
+    struct rebx_extras* const rebx = sim->extras;
+    double G = sim->G;
+    
+    
+    for (int i=1; i<N; i++){
+        
+        struct reb_particle* target = &particles[i];
+        struct reb_particle* star = &particles[0];
+        
+        double* density = rebx_get_param(rebx, target->ap, "ye_body_density");
+        double* lstar = rebx_get_param(rebx, force->ap, "ye_lstar");
+        double* rotation_period = rebx_get_param(rebx, target->ap, "ye_rotation_period");
+        double* Gamma = rebx_get_param(rebx, target->ap, "ye_thermal_inertia");
+        double* albedo = rebx_get_param(rebx, target->ap, "ye_albedo");
+        double* emissivity = rebx_get_param(rebx, target->ap, "ye_emissivity");
+        double* k = rebx_get_param(rebx, target->ap, "ye_k");
+        double* c = rebx_get_param(rebx, force->ap, "ye_c");
+        double* stef_boltz = rebx_get_param(rebx, force->ap, "ye_stef_boltz");
+        int* yark_flag = rebx_get_param(rebx, target->ap, "ye_flag");
+        double* sx = rebx_get_param(rebx, target->ap, "ye_spin_axis_x");
+        double* sy = rebx_get_param(rebx, target->ap, "ye_spin_axis_y");
+        double* sz = rebx_get_param(rebx, target->ap, "ye_spin_axis_z");
+        
+        //if these necessary conditions are met the Yarkovsky effect will be calculated for a particle in the sim
+        if (density != NULL && target->r != 0 && albedo != NULL && lstar != NULL && c != NULL && yark_flag != NULL){
+            baseline_calculate_yarkovsky_effect(sim, target, star, G, density, lstar, rotation_period, Gamma, albedo, emissivity, k, c, stef_boltz, yark_flag, sx, sy, sz);
+        }
+    }
+}
+
+static void zero_accelerations(struct reb_simulation* sim){
+    for (int i=0; i<sim->N; i++){
+        sim->particles[i].ax = 0.;
+        sim->particles[i].ay = 0.;
+        sim->particles[i].az = 0.;
+    }
+}
+
+// Average time per force evaluation
+static double time_force(struct reb_simulation* sim, struct rebx_force* yark, void (*update_accelerations)(struct reb_simulation* const sim, struct rebx_force* const force, struct reb_particle* const particles, const int N), int reps){
+    update_accelerations(sim, yark, sim->particles, sim->N); // builds the parameter cache
+    double start = walltime();
+    for (int r=0; r<reps; r++){
+        update_accelerations(sim, yark, sim->particles, sim->N);
+    }
+    return (walltime() - start)/reps;
+}
+
+// Largest difference between the two implementations' accelerations, relative to the largest acceleration
+static double max_rel_diff(struct reb_simulation* sim, struct rebx_force* yark){
+    const int N = sim->N;
+    double* a = malloc(3*N*sizeof(*a));
+    zero_accelerations(sim);
+    baseline_yarkovsky_effect(sim, yark, sim->particles, N);
+    for (int i=0; i<N; i++){
+        a[3*i] = sim->particles[i].ax;
+        a[3*i+1] = sim->particles[i].ay;
+        a[3*i+2] = sim->particles[i].az;
+    }
+    zero_accelerations(sim);
+    yark->update_accelerations(sim, yark, sim->particles, N);
+    double amax = 0.;
+    double dmax = 0.;
+    for (int i=0; i<N; i++){
+        const double diff[3] = {sim->particles[i].ax - a[3*i], sim->particles[i].ay - a[3*i+1], sim->particles[i].az - a[3*i+2]};
+        for (int j=0; j<3; j++){
+            amax = fmax(amax, fabs(a[3*i+j]));
+            dmax = fmax(dmax, fabs(diff[j]));
+        }
+    }
+    free(a);
+    return amax > 0. ? dmax/amax : 0.;
+}
+
+int main(int argc, char* argv[]) {
+    double au_conv = 1.495978707e11;
+    double msun_conv = 1.9885e30;
+    double yr_conv = 31557600.0;
+
+    double density = (3000.0*au_conv*au_conv*au_conv)/msun_conv;
+    double c = (2.998e8*yr_conv)/au_conv;
+    double lstar = (3.828e26*yr_conv*yr_conv*yr_conv)/(msun_conv*au_conv*au_conv);
+    double stef_boltz = ((5.670e-8)*yr_conv*yr_conv*yr_conv)/(msun_conv);
+    double Gamma = (310*sqrt(yr_conv)*yr_conv*yr_conv)/msun_conv;
+    double rotation_period = 15470.9/yr_conv;
+
+    printf("%8s %6s %14s %14s %8s %12s\n", "N", "flag", "baseline [s]", "current [s]", "speedup", "max rel diff");
+    for (int N=1000; N<=1000000; N*=10){
+        for (int flag=1; flag>=0; flag--){
+            struct reb_simulation* sim = reb_create_simulation();
+            sim->G = 4*M_PI*M_PI;  // use units of AU, yr and solar masses
+            
+            struct reb_particle star = {0};
+            star.m = 1.;
+            reb_add(sim, star);
+            for (int i=1; i<N; i++){
+                double a = 0.5 + 3.*(double)rand()/RAND_MAX;
+                double f = 2.*M_PI*(double)rand()/RAND_MAX;
+                struct reb_particle asteroid = reb_tools_orbit_to_particle(sim->G, star, 0., a, 0.1, 0.05, 0., 0., f);
+                asteroid.r = 1000/au_conv;
+                reb_add(sim, asteroid);
+            }
+
+            struct rebx_extras* rebx = rebx_attach(sim);
+            struct rebx_force* yark = rebx_load_force(rebx, "yarkovsky_effect");
+            rebx_set_param_double(rebx, &yark->ap, "ye_lstar", lstar);
+            rebx_set_param_double(rebx, &yark->ap, "ye_c", c);
+            rebx_set_param_double(rebx, &yark->ap, "ye_stef_boltz", stef_boltz);
+            for (int i=1; i<N; i++){
+                struct reb_particle* p = &sim->particles[i];
+                rebx_set_param_int(rebx, &p->ap, "ye_flag", flag);
+                rebx_set_param_double(rebx, &p->ap, "ye_body_density", density);
+                rebx_set_param_double(rebx, &p->ap, "ye_albedo", .017);
+                rebx_set_param_double(rebx, &p->ap, "ye_emissivity", .9);
+                rebx_set_param_double(rebx, &p->ap, "ye_k", .25);
+                rebx_set_param_double(rebx, &p->ap, "ye_thermal_inertia", Gamma);
+                rebx_set_param_double(rebx, &p->ap, "ye_rotation_period", rotation_period);
+                rebx_set_param_double(rebx, &p->ap, "ye_spin_axis_x", (double)rand()/RAND_MAX);
+                rebx_set_param_double(rebx, &p->ap, "ye_spin_axis_y", (double)rand()/RAND_MAX);
+                rebx_set_param_double(rebx, &p->ap, "ye_spin_axis_z", 1.);
+            }
+
+            int reps = 1e7/N > 3 ? 1e7/N : 3;
+            double t_baseline = time_force(sim, yark, baseline_yarkovsky_effect, reps);
+            double t_current = time_force(sim, yark, yark->update_accelerations, reps);
+            printf("%8d %6d %14.4e %14.4e %8.2f %12.3e\n", N, flag, t_baseline, t_current, t_baseline/t_current, max_rel_diff(sim, yark));
+
+            rebx_free(rebx);
+            reb_free_simulation(sim);
+        }
+    }
+}
@@ -1,14 +1,16 @@
 from . import clibreboundx
-from ctypes import Structure, c_double, POINTER, c_int, c_uint, c_long, c_ulong, c_void_p, c_char_p, CFUNCTYPE, byref, c_uint32, c_uint, cast, c_char
+from ctypes import Structure, c_double, POINTER, c_int, c_uint, c_long, c_ulong, c_void_p, c_char_p, CFUNCTYPE, byref, c_uint32, c_uint, cast, c_char, c_size_t, string_at
 import rebound
 import reboundx
 import warnings
+import weakref
 
 integrators = {"implicit_midpoint": 0, "rk4":1, "euler": 2, "rk2": 3, "none": -1}
 
 REBX_TIMING = {"pre":-1, "post":1}
 REBX_FORCE_TYPE = {"none":0, "pos":1, "vel":2}
 REBX_OPERATOR_TYPE = {"none":0, "updater":1, "recorder":2}
+REBX_TRIGGER_QUANTITIES = {"t":0, "a":1, "e":2, "inc":3, "d":4}
 
 REBX_BINARY_WARNINGS = [
     (True, 1, "REBOUNDx: Cannot open binary file. Check filename."),
@@ -36,22 +38,26 @@ class Extras(Structure):
     The fastest way to understand it is to follow the examples at :ref:`ipython_examples`.  
     """
     
-    def __new__(cls, sim, filename=None):
+    def __new__(cls, sim, filename=None, binary=None):
         rebx = super(Extras,cls).__new__(cls)
         return rebx
 
-    def __init__(self, sim, filename=None):
+    def __init__(self, sim, filename=None, binary=None):
         sim._extras_ref = self # add a reference to this instance in sim to make sure it's not garbage collected_ 
+        self._sim_ref = weakref.ref(sim) # python object (not just the C pointer) so pickling (sim, rebx) together doesn't copy sim twice
         clibreboundx.rebx_initialize(byref(sim), byref(self))
         # Create simulation
-        if filename==None:
+        if filename==None and binary==None:
             # Create a new rebx instance
            clibreboundx.rebx_register_default_params(byref(self))
         else:
             # Recreate existing simulation.
-            # Load registered parameters from binary
+            # Load registered parameters from binary (either a file or its contents already read into memory)
             w = c_int(0)
-            clibreboundx.rebx_init_extras_from_binary(byref(self), c_char_p(filename.encode('ascii')), byref(w))
+            if binary is not None:
+                clibreboundx.rebx_init_extras_from_buffer(byref(self), c_char_p(binary), c_size_t(len(binary)), byref(w))
+            else:
+                clibreboundx.rebx_init_extras_from_binary(byref(self), c_char_p(filename.encode('ascii')), byref(w))
             for majorerror, value, message in REBX_BINARY_WARNINGS:
                 if w.value & value:
                     if majorerror:
@@ -64,6 +70,20 @@ class Extras(Structure):
         if self._b_needsfree_ == 1:
             clibreboundx.rebx_free_pointers(byref(self))
 
+    def __reduce__(self):
+        """
+        Pickles the REBOUNDx state (and the simulation it is attached to) as an in-memory binary, so configured
+        Extras can be sent to multiprocessing workers without writing files. Effects implemented in Python are
+        not saved, same as for rebx.save. If rebx is pickled without its simulation, the unpickled Extras keeps
+        the unpickled simulation alive.
+        """
+        sim = self._sim_ref() if hasattr(self, "_sim_ref") else None
+        if sim is None:
+            if not self._sim:
+                raise RuntimeError("REBOUNDx Error: Can't pickle Extras that are not attached to a simulation.")
+            sim = self._sim.contents
+        return (_extras_from_buffer, (sim, self.save_to_buffer()))
+
     def detach(self, sim):
         sim._extras_ref = None # remove reference to rebx so it can be garbage collected 
         clibreboundx.rebx_detach(byref(sim), byref(self))
@@ -107,10 +127,18 @@ class Extras(Structure):
         clibreboundx.rebx_add_force(byref(self), byref(force))
         self.process_messages()
 
-    def add_operator(self, operator, dtfraction=None, timing="post"):
+    def add_operator(self, operator, dtfraction=None, timing="post", interval=None):
+        """
+        Adds an operator to the simulation. By default it is applied every timestep (with a scheme appropriate for the integrator).
+        If interval is passed, the operator is instead applied at fixed intervals in simulation time. With IAS15 the particle
+        states at those times are interpolated within the adaptive timesteps, so sim.ri_ias15.epsilon need not be set to 0.
+        Intervals require IAS15; velocity kicks are carried over to the end of each timestep to first order.
+        """
         if not isinstance(operator, reboundx.extras.Operator):
             raise TypeError("REBOUNDx Error: Object passed to rebx.add_operator is not a reboundx.Operator instance.")
-        if dtfraction is None:
+        if interval is not None:
+            clibreboundx.rebx_add_operator_interval(byref(self), byref(operator), c_double(interval))
+        elif dtfraction is None:
             clibreboundx.rebx_add_operator(byref(self), byref(operator))
         else:
             timingint = REBX_TIMING[timing]
@@ -158,6 +186,43 @@ class Extras(Structure):
         clibreboundx.rebx_output_binary(byref(self), c_char_p(filename.encode("ascii")))
         self.process_messages()
 
+    def save_to_buffer(self):
+        """
+        Returns the same binary as rebx.save writes to a file as a bytes object. Load with reboundx.Extras(sim, binary=...).
+        """
+        buf = c_char_p()
+        size = c_size_t()
+        clibreboundx.rebx_output_binary_to_stream(byref(self), byref(buf), byref(size))
+        self.process_messages()
+        binary = string_at(buf, size.value)
+        clibreboundx.rebx_output_free_stream(buf)
+        return binary
+
+    def trace_start(self, capacity=100000):
+        """
+        Starts recording a timeline of every force evaluation and pre/post timestep operator step, with up to
+        capacity events per thread. Export it with rebx.trace_export. Restarting discards earlier events.
+        """
+        clibreboundx.rebx_trace_start(byref(self), c_int(capacity))
+        self.process_messages()
+
+    def trace_stop(self):
+        """
+        Stops recording timeline events. Recorded events are kept for rebx.trace_export.
+        """
+        clibreboundx.rebx_trace_stop(byref(self))
+
+    def trace_export(self, filename):
+        """
+        Writes the recorded timeline to filename in Chrome Trace Event JSON format, which can be opened in
+        chrome://tracing or https://ui.perfetto.dev. Returns the number of events written; events dropped
+        because a buffer was full are listed under "otherData". Force events have an "evaluation" arg, the number of
+        earlier force evaluations in the same timestep (with IAS15 this counts all predictor-corrector iterations).
+        """
+        clibreboundx.rebx_trace_export(byref(self), c_char_p(filename.encode("ascii")))
+        self.process_messages()
+        return clibreboundx.rebx_trace_N(byref(self))
+
     #######################################
     # Convenience Functions
     #######################################
@@ -202,6 +267,85 @@ class Extras(Structure):
         clibreboundx.rebx_gravitational_harmonics_potential.restype = c_double
         return clibreboundx.rebx_gravitational_harmonics_potential(byref(self))
 
+    def energy(self):
+        clibreboundx.rebx_energy.restype = c_double
+        return clibreboundx.rebx_energy(byref(self))
+
+    def max_dt(self):
+        clibreboundx.rebx_max_dt.restype = c_double
+        return clibreboundx.rebx_max_dt(byref(self))
+
+    def energy_monitor_set_output(self, operator, filename):
+        clibreboundx.rebx_energy_monitor_set_output(byref(self), byref(operator), c_char_p(filename.encode("ascii")))
+        self.process_messages()
+
+    def encounter_events_drain(self, operator):
+        """
+        Removes all events stored by an encounter_events operator and returns them as numpy arrays.
+
+        :returns: Tuple (t, hash1, hash2, distance, v_rel) of numpy arrays with one entry per event, oldest first.
+        """
+        import numpy as np
+        clibreboundx.rebx_encounter_events_N.restype = c_int
+        N = clibreboundx.rebx_encounter_events_N(byref(self), byref(operator))
+        t = np.zeros(N, dtype=np.float64)
+        hash1 = np.zeros(N, dtype=np.uint32)
+        hash2 = np.zeros(N, dtype=np.uint32)
+        distance = np.zeros(N, dtype=np.float64)
+        v_rel = np.zeros(N, dtype=np.float64)
+        clibreboundx.rebx_encounter_events_drain(byref(self), byref(operator), t.ctypes.data_as(POINTER(c_double)), hash1.ctypes.data_as(POINTER(c_uint32)), hash2.ctypes.data_as(POINTER(c_uint32)), distance.ctypes.data_as(POINTER(c_double)), v_rel.ctypes.data_as(POINTER(c_double)), c_int(N))
+        return t, hash1, hash2, distance, v_rel
+
+    def add_trigger(self, operator, quantity, threshold, particle=None, primary=None, above=True):
+        """
+        Adds a condition to a triggers operator. Actions are added with trigger_enable_force, trigger_disable_force and trigger_set_param,
+        and are carried out the first time the condition is met.
+
+        :param quantity: One of "t", "a", "e", "inc" or "d" (distance from primary).
+        :param particle: Particle whose orbit is monitored (a Particle, its name or its hash). Ignored for "t".
+        :param primary: Primary that orbital elements are calculated relative to. Defaults to sim.particles[0].
+        :param above: If True the condition is met once quantity >= threshold, otherwise once quantity <= threshold.
+        :returns: Index of the condition, to pass to the functions adding actions.
+        """
+        clibreboundx.rebx_trigger_add.restype = c_int
+        trigger = clibreboundx.rebx_trigger_add(byref(self), byref(operator), c_int(REBX_TRIGGER_QUANTITIES[quantity]), c_double(threshold), c_int(above), self._trigger_hash(particle), self._trigger_hash(primary))
+        self.process_messages()
+        return trigger
+
+    def trigger_enable_force(self, operator, trigger, force):
+        clibreboundx.rebx_trigger_enable_force(byref(self), byref(operator), c_int(trigger), byref(force))
+        self.process_messages()
+
+    def trigger_disable_force(self, operator, trigger, force):
+        clibreboundx.rebx_trigger_disable_force(byref(self), byref(operator), c_int(trigger), byref(force))
+        self.process_messages()
+
+    def trigger_set_param(self, operator, trigger, target, name, value):
+        """
+        Sets parameter name of target (a Force, Operator or Particle) to value when the condition is first met.
+        """
+        if isinstance(target, (Force, Operator)):
+            apptr = byref(target, type(target).ap.offset)
+            particle_hash = c_uint32(0)
+        else:
+            apptr = None
+            particle_hash = self._trigger_hash(target)
+        clibreboundx.rebx_trigger_set_param(byref(self), byref(operator), c_int(trigger), apptr, particle_hash, c_char_p(name.encode('ascii')), c_double(value))
+        self.process_messages()
+
+    def trigger_fired(self, operator, trigger):
+        clibreboundx.rebx_trigger_fired.restype = c_int
+        return bool(clibreboundx.rebx_trigger_fired(byref(self), byref(operator), c_int(trigger)))
+
+    def _trigger_hash(self, particle):
+        if particle is None:
+            return c_uint32(0)
+        if isinstance(particle, rebound.Particle):
+            return c_uint32(particle.hash.value)
+        if isinstance(particle, str):
+            return c_uint32(rebound.hash(particle).value)
+        return c_uint32(particle)
+
     def process_messages(self):
         try:
             self._sim.contents.process_messages()
@@ -294,7 +438,21 @@ Extras._fields_ =  [("_sim", POINTER(rebound.Simulation)),
                     ("_post_timestep_modifications", POINTER(Node)),
                     ("_registered_params", POINTER(Node)),
                     ("_allocated_forces", POINTER(Node)),
-                    ("_allocated_operators", POINTER(Node))]
+                    ("_allocated_operators", POINTER(Node)),
+                    ("_workspace", c_void_p),
+                    ("_workspace_size", c_size_t),
+                    ("_gravity_acc", c_void_p),
+                    ("_gravity_acc_N", c_int),
+                    ("_gravity_acc_valid", c_int),
+                    ("_dense_particles", c_void_p),
+                    ("_dense_particles_N", c_int),
+                    ("_trace", c_void_p),
+                    ("_geometry", c_void_p)]
+
+def _extras_from_buffer(sim, binary):
+    rebx = Extras(sim, binary=binary)
+    rebx._sim_owner = sim # Extras otherwise only holds a weak reference, so an Extras unpickled on its own would lose its simulation
+    return rebx
 
 class Interpolator(Structure):
     def __new__(cls, rebx, times, values, interpolation):
@@ -319,7 +477,28 @@ class Interpolator(Structure):
         DblArr = c_double * Nvalues
         clibreboundx.rebx_init_interpolator(byref(rebx), byref(self), c_int(Nvalues), DblArr(*times), DblArr(*values), c_int(interp)) 
 
+    @classmethod
+    def from_table(cls, table):
+        """
+        Returns an Interpolator that reads from a shared InterpolatorTable. Only its cursor is private, so many
+        simulations can interpolate the same data without copying it.
+        """
+        interp = super(Interpolator, cls).__new__(cls)
+        clibreboundx.rebx_init_interpolator_from_table(byref(interp), table._table)
+        return interp
+
     def interpolate(self, rebx, t):
+        """
+        Returns the interpolated value at time t. If t is a list or array, returns a numpy array of values
+        evaluated with a single C call (fastest if t is sorted).
+        """
+        if hasattr(t, '__len__'):
+            import numpy as np
+            times = np.ascontiguousarray(t, dtype=np.float64)
+            values = np.empty_like(times)
+            clibreboundx.rebx_interpolate_array(byref(rebx), byref(self), times.ctypes.data_as(POINTER(c_double)), values.ctypes.data_as(POINTER(c_double)), c_int(times.size))
+            rebx.process_messages()
+            return values
         clibreboundx.rebx_interpolate.restype = c_double
         return clibreboundx.rebx_interpolate(byref(rebx), byref(self), c_double(t))
     
@@ -327,17 +506,49 @@ class Interpolator(Structure):
         if self._b_needsfree_ == 1:
             clibreboundx.rebx_free_interpolator_pointers(byref(self))
         
+class InterpolatorTable(object):
+    """
+    Read-only, reference-counted interpolation table (times, values and spline coefficients) that can be shared
+    by Interpolators in many simulations. Create Interpolators from it with Interpolator.from_table.
+    """
+    def __init__(self, times, values, interpolation="spline"):
+        try:
+            Nvalues = len(times)
+            Nvalues2 = len(values)
+        except:
+            raise TypeError("REBOUNDx Error: Times and values passed to InterpolatorTable must be lists or arrays")
+        if Nvalues != Nvalues2:
+            raise ValueError("REBOUNDx Error: Times and values must be same length)")
+
+        interpolation = interpolation.lower()
+        if interpolation in INTERPOLATION_TYPE:
+            interp = INTERPOLATION_TYPE[interpolation]
+        else:
+            raise ValueError("REBOUNDx Error: Interpolation type not supported")
+
+        DblArr = c_double * Nvalues
+        clibreboundx.rebx_create_interpolator_table.restype = c_void_p
+        self._table = c_void_p(clibreboundx.rebx_create_interpolator_table(c_int(Nvalues), DblArr(*times), DblArr(*values), c_int(interp)))
+        if not self._table:
+            raise MemoryError("REBOUNDx Error: Could not allocate InterpolatorTable")
+
+    def __del__(self):
+        if getattr(self, "_table", None):
+            clibreboundx.rebx_free_interpolator_table(self._table)
+            self._table = None
+
 Interpolator._fields_ = [  ("interpolation", c_int),
                     ("times", POINTER(c_double)),
                     ("values", POINTER(c_double)),
                     ("Nvalues", c_int),
                     ("y2", POINTER(c_double)),
-                    ("klo", c_int)]
+                    ("klo", c_int),
+                    ("table", c_void_p)]
 
 INTERPOLATION_TYPE = {"none":0, "spline":1}
 
 # This list keeps pairing from C rebx_param_type enum to ctypes type 1-to-1. Derive the required mappings from it
-REBX_C_TO_CTYPES = [["REBX_TYPE_NONE", None], ["REBX_TYPE_DOUBLE", c_double], ["REBX_TYPE_INT",c_int], ["REBX_TYPE_POINTER", c_void_p], ["REBX_TYPE_FORCE", Force], ["REBX_TYPE_UNIT32", c_uint32], ["REBX_TYPE_ORBIT", rebound.Orbit]]
+REBX_C_TO_CTYPES = [["REBX_TYPE_NONE", None], ["REBX_TYPE_DOUBLE", c_double], ["REBX_TYPE_INT",c_int], ["REBX_TYPE_POINTER", c_void_p], ["REBX_TYPE_FORCE", Force], ["REBX_TYPE_UNIT32", c_uint32], ["REBX_TYPE_ORBIT", rebound.Orbit], ["REBX_TYPE_INTERPOLATOR", Interpolator]]
 REBX_CTYPES = {} # maps int value of rebx_param_type enum to ctypes type
 REBX_C_PARAM_TYPES = {} # maps string of rebx_param_type enum to int
 for i, pair in enumerate(REBX_C_TO_CTYPES):
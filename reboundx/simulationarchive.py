@@ -16,14 +16,21 @@ class SimulationArchive(rebound.SimulationArchive):
         """
         super(SimulationArchive, self).__init__(filename, *args, **kwargs)
         self.rebxfilename = rebxfilename
+        # Read the REBOUNDx binary once and reuse it for every snapshot. This saves reopening the file, but each
+        # snapshot still parses the cached bytes into a new Extras, since effects and params can't be cloned.
+        try:
+            with open(rebxfilename, 'rb') as f:
+                self.rebxbinary = f.read()
+        except IOError:
+            self.rebxbinary = None # let Extras raise its usual error below
         sim, rebx = self[0] # test you can open rebxfilename to warn user if not
 
     def __getitem__(self, key):
         sim = super(SimulationArchive, self).__getitem__(key)
-        rebx = reboundx.Extras(sim, self.rebxfilename)
+        rebx = reboundx.Extras(sim, self.rebxfilename, binary=self.rebxbinary)
         return sim, rebx
 
     def getSimulation(self, *args, **kwargs):
         sim = super(SimulationArchive, self).getSimulation(*args, **kwargs)
-        rebx = reboundx.Extras(sim, self.rebxfilename)
+        rebx = reboundx.Extras(sim, self.rebxfilename, binary=self.rebxbinary)
         return sim, rebx
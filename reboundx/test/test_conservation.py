@@ -80,5 +80,21 @@ class TestConservation(unittest.TestCase):
         H = sim.calculate_energy() + rebx.gravitational_harmonics_potential()
         self.assertLess(abs((H-H0)/H0), 1.e-12)
 
+    def test_energy_monitor(self):
+        sim = rebound.Simulation(binary)
+        sim.integrator = "ias15"
+        rebx = reboundx.Extras(sim)
+        force = rebx.load_force('gr_potential')
+        rebx.add_force(force)
+        force.params['c'] = 1.e4
+        self.assertAlmostEqual(rebx.energy(), sim.calculate_energy() + rebx.gr_potential_potential(force), delta=1.e-15*abs(rebx.energy()))
+        em = rebx.load_operator('energy_monitor')
+        em.params['emon_interval'] = 1.e3
+        rebx.add_operator(em)
+        rebx.energy_monitor_set_output(em, 'test_em.bin')
+        sim.integrate(1.e4)
+        self.assertGreater(em.params['emon_Nrecords'], 5)
+        self.assertLess(abs(em.params['emon_dE']), 1.e-12)
+
 if __name__ == '__main__':
     unittest.main()
@@ -1,6 +1,12 @@
 import rebound
 import reboundx
 import unittest
+import warnings
+import numpy as np
+import os
+import json
+import subprocess
+import sys
 
 class TestForces(unittest.TestCase):
     def setUp(self):
@@ -82,6 +88,180 @@ class TestForces(unittest.TestCase):
         with self.assertRaises(AttributeError):
             self.rebx.remove_force(gr)
 
+    def test_gr_reuse_gravity(self):
+        # massive test particle: REBOUND skips its pull on the active bodies, so gr must fall back to its own sum
+        for N_active in [-1, 3]:
+            xs = []
+            for reuse in [0, 1]:
+                sim = rebound.Simulation()
+                sim.add(m=1.)
+                sim.add(m=1.e-3, a=1., e=0.2)
+                sim.add(m=1.e-3, a=2., e=0.1)
+                sim.add(m=1.e-4, a=3., e=0.05)
+                sim.N_active = N_active
+                sim.integrator = 'whfast'
+                sim.dt = 0.05
+                rebx = reboundx.Extras(sim)
+                gr = rebx.load_force('gr')
+                rebx.add_force(gr)
+                gr.params['c'] = 10.
+                gr.params['gr_reuse_gravity'] = reuse
+                sim.integrate(10.)
+                xs.append(sim.particles[1].x)
+            self.assertLess(abs(xs[1]-xs[0]), 1.e-12)
+
+    def test_gr_full_hamiltonian(self):
+        # Compare with the original in-place (Gauss-Seidel) solve for vtilde, which is converged after its 10 iterations here
+        sim = rebound.Simulation()
+        sim.add(m=1.)
+        sim.add(m=0.3, a=1., e=0.3)
+        sim.add(m=1.e-3, a=3., e=0.1, inc=0.2)
+        sim.move_to_com()
+        rebx = reboundx.Extras(sim)
+        force = rebx.load_force('gr_full')
+        C = 30.
+        force.params['c'] = C
+        G, C2 = sim.G, C*C
+        m = np.array([p.m for p in sim.particles])
+        x = np.array([[p.x, p.y, p.z] for p in sim.particles])
+        v = np.array([[p.vx, p.vy, p.vz] for p in sim.particles])
+        N = len(m)
+        vt = v.copy()
+        sumk = np.array([sum(-2.*G*m[k]/np.linalg.norm(x[k]-x[i]) for k in range(N) if k != i) for i in range(N)])
+        for q in range(10):
+            for i in range(N):
+                A = 1. - 0.5*np.dot(vt[i], vt[i])/C2
+                dv = np.zeros(3)
+                for j in range(N):
+                    if j != i:
+                        xij = x[j]-x[i]
+                        rij = np.linalg.norm(xij)
+                        dv += m[j]/rij*(6.*vt[i] - 7.*vt[j] - np.dot(vt[j], xij)*xij/rij**2)
+                vt[i] = (v[i] + G/(2.*C2)*dv)/A
+        H = 0.
+        for i in range(N):
+            vi2 = np.dot(vt[i], vt[i])
+            H += 0.5*m[i]*vi2 - m[i]/(8.*C2)*vi2*vi2
+            for j in range(N):
+                if j != i:
+                    xij = x[j]-x[i]
+                    rij = np.linalg.norm(xij)
+                    H -= G/(4.*C2)*m[i]*m[j]/rij*(6.*vi2 - 7.*np.dot(vt[i], vt[j]) - np.dot(vt[i], xij)*np.dot(vt[j], xij)/rij**2 + sumk[i])
+                    if j > i:
+                        H -= G*m[i]*m[j]/rij
+        self.assertAlmostEqual(rebx.gr_full_hamiltonian(force), H, delta=1.e-13*abs(H))
+
+    def test_gr_full_tree(self):
+        # gr_full_theta -> 0 should reproduce the exact pair sum, and theta=0.5 should capture the GR shift to 1e-3
+        xs = {}
+        for theta in [None, 1.e-6, 0.5, 'nogr']:
+            sim = rebound.Simulation()
+            sim.add(m=1.)
+            np.random.seed(0)
+            for i in range(100):
+                sim.add(m=1.e-7, a=np.random.uniform(0.5, 2.), e=0.05*np.random.rand(), inc=0.05*np.random.rand(), f=2*np.pi*np.random.rand(), Omega=2*np.pi*np.random.rand())
+            sim.move_to_com()
+            sim.integrator = "ias15"
+            sim.ri_ias15.epsilon = 0
+            sim.dt = 1.e-3
+            rebx = reboundx.Extras(sim)
+            if theta != 'nogr':
+                force = rebx.load_force('gr_full')
+                force.params['c'] = 1.e2
+                if theta is not None:
+                    force.params['gr_full_theta'] = theta
+                rebx.add_force(force)
+            sim.integrate(0.1)
+            xs[theta] = np.array([[p.x, p.y, p.z] for p in sim.particles])
+        self.assertLess(np.max(np.abs(xs[None]-xs[1.e-6])), 1.e-13)
+        shift = np.sqrt(np.sum((xs[None]-xs['nogr'])**2, axis=1))
+        err = np.sqrt(np.sum((xs[None]-xs[0.5])**2, axis=1))
+        for i in range(len(shift)):
+            self.assertLessEqual(err[i], 1.e-3*shift[i])
+
+    def test_gr_statistics(self):
+        self.sim.add(m=1.e-3, a=2., e=0.1)
+        self.sim.particles[1].m = 1.e-3
+        self.sim.move_to_com()
+        self.sim.dt = 1.e-3
+        gr = self.rebx.load_force('gr')
+        gr.params['c'] = 1.e2
+        gr.params['gr_iterations'] = 0.
+        self.rebx.add_force(gr)
+        self.sim.integrate(0.1)
+        self.assertGreater(gr.params['gr_solves'], 0.)
+        self.assertEqual(gr.params['gr_solves'] % 2, 0.) # two bodies solved per call
+        self.assertGreaterEqual(gr.params['gr_iterations'], gr.params['gr_solves'])
+        self.assertLessEqual(gr.params['gr_iterations'], 10*gr.params['gr_solves'])
+        self.assertEqual(gr.params['gr_unconverged'], 0.)
+
+    def test_yarkovsky_cache(self):
+        # batched kernels should match the one-particle-at-a-time implementation, and changing a param after the cache is built should take effect
+        for flag in [-1, 0, 1]:
+            xs = []
+            for scalar, albedo in [(0, 0.1), (1, 0.1), (0, 0.5)]:
+                sim = rebound.Simulation()
+                sim.units = ('yr', 'AU', 'Msun')
+                sim.add(m=1.)
+                sim.add(a=1.)
+                sim.add(a=1.5, e=0.1, inc=0.1)
+                rebx = reboundx.Extras(sim)
+                yark = rebx.load_force('yarkovsky_effect')
+                rebx.add_force(yark)
+                yark.params['ye_c'] = 63197.8
+                yark.params['ye_lstar'] = 1.23e-4
+                yark.params['ye_stef_boltz'] = 1.9e-13
+                for i, p in enumerate(sim.particles[1:]):
+                    p.r = 1.e-8
+                    p.params['ye_flag'] = flag
+                    p.params['ye_body_density'] = 2.e9
+                    p.params['ye_albedo'] = 0.1
+                    p.params['ye_emissivity'] = 0.9
+                    p.params['ye_k'] = 0.25
+                    p.params['ye_thermal_inertia'] = 2.5e-7
+                    p.params['ye_rotation_period'] = 5.e-4
+                    p.params['ye_spin_axis_x'] = 0.3*i
+                    p.params['ye_spin_axis_y'] = 0.1
+                    p.params['ye_spin_axis_z'] = 1.
+                if scalar:
+                    os.environ['REBX_YE_SCALAR'] = '1' # read when the force is first evaluated
+                sim.integrate(1.)
+                os.environ.pop('REBX_YE_SCALAR', None)
+                sim.particles[1].params['ye_albedo'] = albedo
+                sim.integrate(10.)
+                xs.append(np.array([[p.x, p.y, p.z] for p in sim.particles]))
+            self.assertLess(np.max(np.abs(xs[0]-xs[1])), 1.e-12)
+            self.assertGreater(np.max(np.abs(xs[0]-xs[2])), 1.e-12)
+
+    def test_testparticle_fast_path(self):
+        # effects' loops over test particles (N_active) should give the same result as the general path over all particles
+        sims = []
+        for N_active in [-1, 3]:
+            sim = rebound.Simulation()
+            sim.add(m=1.)
+            sim.add(m=1.e-3, a=1., e=0.1)
+            sim.add(m=1.e-3, a=2., e=0.1, inc=0.1)
+            for i in range(20):
+                sim.add(a=1.3+0.1*i, e=0.05, inc=0.01*i, f=0.5*i)
+            sim.N_active = N_active
+            sim.move_to_com()
+            sim.dt = 0.05
+            rebx = reboundx.Extras(sim)
+            gh = rebx.load_force('gravitational_harmonics')
+            rebx.add_force(gh)
+            sim.particles[0].params['J2'] = 1.e-3
+            sim.particles[0].params['R_eq'] = 0.1
+            mof = rebx.load_force('modify_orbits_forces')
+            rebx.add_force(mof)
+            for p in sim.particles[1:]:
+                p.params['tau_a'] = -1.e3
+            sim.integrate(10.)
+            sims.append(sim)
+        for p1, p2 in zip(sims[0].particles, sims[1].particles):
+            self.assertLess(abs(p1.x-p2.x), 1.e-12)
+            self.assertLess(abs(p1.y-p2.y), 1.e-12)
+            self.assertLess(abs(p1.vz-p2.vz), 1.e-12)
+
 class TestOperators(unittest.TestCase):
     def setUp(self):
         self.sim = rebound.Simulation()
@@ -176,6 +356,96 @@ class TestOperators(unittest.TestCase):
         with self.assertRaises(AttributeError):
             self.rebx.remove_operator(mm)
 
+    def test_modify_orbits_direct_exact(self):
+        for dt in [1.e-2, 3.]: # result shouldn't depend on timestep
+            sim = rebound.Simulation()
+            sim.add(m=1.)
+            sim.add(a=1., e=0.2, inc=0.1)
+            sim.integrator = "whfast"
+            sim.dt = dt
+            rebx = reboundx.Extras(sim)
+            mod = rebx.load_operator('modify_orbits_direct')
+            rebx.add_operator(mod)
+            mod.params['p'] = 1.
+            p = sim.particles[1]
+            p.params['tau_a'] = -100.
+            p.params['tau_e'] = -50.
+            p.params['tau_inc'] = -20.
+            sim.integrate(30., exact_finish_time=0)
+            o = sim.particles[1].calculate_orbit()
+            e = 0.2*np.exp(-sim.t/50.)
+            self.assertAlmostEqual(o.e, e, delta=1.e-12)
+            self.assertAlmostEqual(o.inc, 0.1*np.exp(-sim.t/20.), delta=1.e-12)
+            self.assertAlmostEqual(o.a, np.exp(-sim.t/100.)*(1.-0.2**2)/(1.-e**2), delta=1.e-12)
+
+    def test_modify_orbits_direct_afin(self):
+        self.sim.integrator = "whfast"
+        self.sim.dt = 0.5
+        mod = self.rebx.load_operator('modify_orbits_direct')
+        self.rebx.add_operator(mod)
+        p = self.sim.particles[1]
+        p.params['tau_afin'] = 10.
+        p.params['afin'] = 2.
+        p.params['em_tau_a'] = 1. # exponential_migration's params shouldn't affect this operator
+        self.sim.integrate(30., exact_finish_time=0)
+        o = self.sim.particles[1].calculate_orbit()
+        self.assertAlmostEqual(o.a, 2. - np.exp(-self.sim.t/10.), delta=1.e-12)
+
+    def test_modify_mass_exact(self):
+        sim = self.sim
+        sim.particles[1].m = 1.e-3
+        sim.add(m=1.e-3, a=2., e=0.1, inc=0.1)
+        sim.add(a=3.)
+        sim.move_to_com()
+        sim.integrator = "whfast"
+        sim.dt = 0.05
+        mm = self.rebx.load_operator('modify_mass')
+        self.rebx.add_operator(mm)
+        mm.params['mm_exact'] = 1
+        sim.particles[0].params['tau_mass'] = -100.
+        sim.particles[2].params['tau_mass'] = 50.
+        sim.integrate(10., exact_finish_time=0)
+        ps = sim.particles
+        self.assertAlmostEqual(ps[0].m, np.exp(-sim.t/100.), delta=1.e-13)
+        self.assertAlmostEqual(ps[2].m, 1.e-3*np.exp(sim.t/50.), delta=1.e-15)
+        self.assertEqual(ps[1].m, 1.e-3)
+        com = sim.calculate_com()
+        for q in [com.x, com.y, com.z, com.vx, com.vy, com.vz]:
+            self.assertLess(abs(q), 1.e-13)
+
+        t1 = sim.t
+        m0 = ps[0].m
+        ps[0].params['tau_mass'] = -10. # new value read on the next step
+        sim.integrate(20., exact_finish_time=0)
+        self.assertAlmostEqual(ps[0].m, m0*np.exp(-(sim.t-t1)/10.), delta=1.e-13)
+        com = sim.calculate_com()
+        for q in [com.x, com.y, com.z, com.vx, com.vy, com.vz]:
+            self.assertLess(abs(q), 1.e-13)
+
+    def test_modify_mass_full_com(self):
+        sims = []
+        for full_com in [0, 1]:
+            sim = rebound.Simulation()
+            sim.add(m=1.)
+            sim.add(m=1.e-3, a=1., e=0.2)
+            sim.add(m=1.e-3, a=2., e=0.1, inc=0.1)
+            sim.move_to_com()
+            sim.integrator = "whfast"
+            sim.dt = 0.05
+            rebx = reboundx.Extras(sim)
+            mm = rebx.load_operator('modify_mass')
+            rebx.add_operator(mm)
+            mm.params['mm_full_com'] = full_com
+            sim.particles[0].params['tau_mass'] = -100.
+            sim.particles[2].params['tau_mass'] = 50.
+            sim.integrate(10., exact_finish_time=0)
+            sims.append((sim, rebx))
+        ps, ps_full = sims[0][0].particles, sims[1][0].particles
+        for i in range(sims[0][0].N):
+            self.assertEqual(ps[i].m, ps_full[i].m)
+            for q in ['x', 'y', 'z', 'vx', 'vy', 'vz']:
+                self.assertAlmostEqual(getattr(ps[i], q), getattr(ps_full[i], q), delta=1.e-13)
+
 class TestAddOperator(unittest.TestCase):
     def setUp(self):
         self.sim = rebound.Simulation()
@@ -230,6 +500,266 @@ class TestAddOperator(unittest.TestCase):
         self.sim.step()
         self.assertEqual(self.cust.params['ctr'], 1)
 
+class TestOperatorInterval(unittest.TestCase):
+    def setUp(self):
+        self.sim = rebound.Simulation()
+        self.sim.add(m=1.)
+        self.sim.add(a=1., e=0.7)
+        self.sim.move_to_com()
+        self.rebx = reboundx.Extras(self.sim)
+        self.mod = self.rebx.load_operator('modify_orbits_direct')
+        self.sim.particles[1].params['tau_a'] = -100.
+
+    def test_grid_with_adaptive_ias15(self):
+        self.rebx.add_operator(self.mod, interval=0.1)
+        a0 = self.sim.particles[1].a
+        self.sim.integrate(10.)
+        self.assertAlmostEqual(self.mod.params['operator_next_time'], 10.1, delta=1.e-10)
+        self.assertAlmostEqual(self.sim.particles[1].a, a0*np.exp(-10./100.), delta=1.e-3)
+
+    def test_invalid_interval(self):
+        with self.assertRaises(RuntimeError):
+            self.rebx.add_operator(self.mod, interval=-1.)
+
+    def test_non_ias15(self):
+        self.sim.integrator = "whfast"
+        with self.assertRaises(RuntimeError):
+            self.rebx.add_operator(self.mod, interval=0.1)
+
+class TestTimestepControl(unittest.TestCase):
+    def setUp(self):
+        self.sim = rebound.Simulation()
+        self.sim.add(m=1.)
+        self.sim.add(m=1.e-3, a=1.)
+        self.sim.move_to_com()
+        self.sim.integrator = "whfast"
+        self.sim.dt = 0.5
+        self.rebx = reboundx.Extras(self.sim)
+        sf = self.rebx.load_force('stochastic_forces')
+        self.rebx.add_force(sf)
+        self.sim.particles[1].params['kappa'] = 1.e-5
+        self.sim.particles[1].params['tau_kappa'] = 0.01
+        self.tau = 0.01*self.sim.particles[1].P
+
+    def test_max_dt(self):
+        self.assertAlmostEqual(self.rebx.max_dt(), self.tau, delta=1.e-3*self.tau)
+
+    def test_cap(self):
+        self.sim.integrator = "ias15"
+        tc = self.rebx.load_operator('timestep_control')
+        tc.params['tc_safety_factor'] = 0.5
+        self.rebx.add_operator(tc)
+        self.sim.integrate(1.)
+        self.assertLess(self.sim.dt, 0.5*self.tau*1.01)
+        self.assertAlmostEqual(tc.params['tc_max_dt'], 0.5*self.rebx.max_dt(), delta=1.e-3*self.tau)
+
+    def test_fixed_timestep(self):
+        tc = self.rebx.load_operator('timestep_control')
+        self.rebx.add_operator(tc)
+        with warnings.catch_warnings(record=True) as w:
+            warnings.simplefilter("always")
+            self.sim.integrate(1.)
+        self.assertEqual(self.sim.dt, 0.5)
+        self.assertLess(tc.params['tc_max_dt'], 0.5)
+        self.assertEqual(sum('timestep_control' in str(x.message) for x in w), 1)
+
+    def test_suggest(self):
+        tc = self.rebx.load_operator('timestep_control')
+        tc.params['tc_suggest'] = 1
+        self.rebx.add_operator(tc)
+        self.sim.integrate(1.)
+        self.assertEqual(self.sim.dt, 0.5)
+        self.assertLess(tc.params['tc_max_dt'], 0.5)
+
+class TestEncounterEvents(unittest.TestCase):
+    def setUp(self):
+        # Massless particles move on straight lines, so the closest approach is known exactly
+        self.sim = rebound.Simulation()
+        self.sim.add(m=0., x=-1., vx=1., hash="a1")
+        self.sim.add(m=0., x=1., y=0.02, vx=-1., hash="a2")
+        self.sim.add(m=0., x=10., y=10., hash="far")
+        self.sim.integrator = "leapfrog"
+        self.sim.dt = 0.013
+        self.rebx = reboundx.Extras(self.sim)
+        self.ee = self.rebx.load_operator('encounter_events')
+        self.rebx.add_operator(self.ee)
+        self.ee.params['ee_distance'] = 0.05
+        self.ee.params['ee_skin'] = 0.03
+
+    def test_events(self):
+        self.sim.integrate(2.)
+        t, hash1, hash2, distance, v_rel = self.rebx.encounter_events_drain(self.ee)
+        self.assertEqual(len(t), 1)
+        self.assertEqual({hash1[0], hash2[0]}, {self.sim.particles["a1"].hash.value, self.sim.particles["a2"].hash.value})
+        self.assertAlmostEqual(t[0], 1., delta=1.e-12)
+        self.assertAlmostEqual(distance[0], 0.02, delta=1.e-12)
+        self.assertAlmostEqual(v_rel[0], 2., delta=1.e-12)
+        self.assertEqual(self.ee.params['ee_Nevents'], 1)
+        t, hash1, hash2, distance, v_rel = self.rebx.encounter_events_drain(self.ee)
+        self.assertEqual(len(t), 0)
+
+    def test_track(self):
+        self.sim.particles["a1"].params['ee_track'] = 1
+        self.sim.particles["far"].params['ee_track'] = 1
+        self.sim.integrate(2.)
+        t, hash1, hash2, distance, v_rel = self.rebx.encounter_events_drain(self.ee)
+        self.assertEqual(len(t), 0)
+
+    def test_overflow(self):
+        self.ee.params['ee_capacity'] = 1
+        self.sim.add(m=0., x=-1., y=-0.01, vx=1., hash="a3")
+        self.sim.integrate(2.)
+        t, hash1, hash2, distance, v_rel = self.rebx.encounter_events_drain(self.ee)
+        self.assertEqual(len(t), 1)
+        self.assertEqual(self.ee.params['ee_Nevents'], 2)
+        self.assertEqual(self.ee.params['ee_Ndropped'], 1)
+
+class TestTriggers(unittest.TestCase):
+    def setUp(self):
+        self.sim = rebound.Simulation()
+        self.sim.add(m=1.)
+        self.sim.add(m=1.e-4, a=1., hash="planet")
+        self.sim.move_to_com()
+        self.sim.integrator = "whfast"
+        self.sim.dt = 0.01
+        self.rebx = reboundx.Extras(self.sim)
+        self.mof = self.rebx.load_force('modify_orbits_forces')
+        self.rebx.add_force(self.mof)
+        self.sim.particles[1].params['tau_a'] = -100.
+        self.trig = self.rebx.load_operator('triggers')
+        self.rebx.add_operator(self.trig)
+
+    def test_time(self):
+        t = self.rebx.add_trigger(self.trig, "t", 10.)
+        self.rebx.trigger_disable_force(self.trig, t, self.mof)
+        self.sim.integrate(10.-self.sim.dt/2.)
+        self.assertFalse(self.rebx.trigger_fired(self.trig, t))
+        self.sim.integrate(10.5)
+        self.assertTrue(self.rebx.trigger_fired(self.trig, t))
+        a = self.sim.particles[1].a
+        self.sim.integrate(20.)
+        self.assertAlmostEqual(self.sim.particles[1].a, a, delta=1.e-6)
+
+    def test_semimajor_axis(self):
+        t = self.rebx.add_trigger(self.trig, "a", 0.95, particle="planet", above=False)
+        self.rebx.trigger_set_param(self.trig, t, self.sim.particles["planet"], 'tau_a', -1.e10)
+        self.sim.integrate(20.)
+        self.assertTrue(self.rebx.trigger_fired(self.trig, t))
+        self.assertEqual(self.sim.particles[1].params['tau_a'], -1.e10)
+        self.assertLess(self.sim.particles[1].a, 0.95)
+        self.assertGreater(self.sim.particles[1].a, 0.94)
+
+    def test_enable(self):
+        self.rebx.remove_force(self.mof)
+        mof = self.rebx.load_force('modify_orbits_forces')
+        t = self.rebx.add_trigger(self.trig, "t", 5.)
+        self.rebx.trigger_enable_force(self.trig, t, mof)
+        self.sim.integrate(5.)
+        self.assertAlmostEqual(self.sim.particles[1].a, 1., delta=1.e-6)
+        self.sim.integrate(10.)
+        self.assertLess(self.sim.particles[1].a, 0.99)
+
+    def test_pointer_param(self):
+        t = self.rebx.add_trigger(self.trig, "t", 5.)
+        with self.assertRaises(RuntimeError):
+            self.rebx.trigger_set_param(self.trig, t, self.mof, 'free_arrays', 1.)
+
+    def test_particle_without_hash(self):
+        t = self.rebx.add_trigger(self.trig, "t", 5.)
+        with self.assertRaises(RuntimeError):
+            self.rebx.trigger_set_param(self.trig, t, None, 'tau_a', -1.e10)
+
+class TestTrace(unittest.TestCase):
+    def setUp(self):
+        self.sim = rebound.Simulation()
+        self.sim.add(m=1.)
+        self.sim.add(m=1.e-3, a=1., e=0.1)
+        self.sim.integrator = "ias15"
+        self.sim.ri_ias15.epsilon = 0
+        self.sim.dt = 0.01
+        self.rebx = reboundx.Extras(self.sim)
+        gr = self.rebx.load_force("gr")
+        self.rebx.add_force(gr)
+        gr.params["c"] = 100.
+        mm = self.rebx.load_operator("modify_mass")
+        self.rebx.add_operator(mm)
+        self.sim.particles[1].params["tau_mass"] = -1.e4
+
+    def test_export(self):
+        self.rebx.trace_start()
+        self.sim.integrate(0.1)
+        self.rebx.trace_stop()
+        self.sim.integrate(0.2)
+        N = self.rebx.trace_export("trace.json")
+        with open("trace.json") as f:
+            events = json.load(f)["traceEvents"]
+        self.assertEqual(len(events), N)
+        forces = [e for e in events if e["name"] == "gr"]
+        operators = [e for e in events if e["name"] == "modify_mass"]
+        self.assertEqual(len(forces) + len(operators), N)
+        self.assertTrue(len(operators) > 0)
+        self.assertTrue(all(e["ph"] == "X" and e["dur"] >= 0. and e["args"]["t"] <= 0.1 + 1.e-12 for e in events))
+        self.assertEqual(min(e["args"]["evaluation"] for e in forces), 0)
+        self.assertTrue(max(e["args"]["evaluation"] for e in forces) >= 7) # IAS15 evaluates forces at least 8 times per step
+
+    def test_overflow(self):
+        self.rebx.trace_start(capacity=5)
+        self.sim.integrate(0.1)
+        N = self.rebx.trace_export("trace.json")
+        self.assertEqual(N, 5)
+        with open("trace.json") as f:
+            self.assertTrue(json.load(f)["otherData"]["dropped"] > 0)
+
+    def test_no_trace(self):
+        with self.assertRaises(RuntimeError):
+            self.rebx.trace_export("trace.json")
+
+class TestISADispatch(unittest.TestCase):
+    script = """
+import rebound, reboundx
+from ctypes import c_char_p
+sim = rebound.Simulation()
+sim.add(m=1.)
+for i in range(20):
+    sim.add(m=1.e-5, a=1.+0.1*i, e=0.05, inc=0.02*i, f=0.3*i)
+sim.move_to_com()
+rebx = reboundx.Extras(sim)
+gh = rebx.load_force('gravitational_harmonics')
+rebx.add_force(gh)
+sim.particles[0].params['J2'] = 1.e-3
+sim.particles[0].params['R_eq'] = 0.01
+cf = rebx.load_force('central_force')
+rebx.add_force(cf)
+sim.particles[0].params['Acentral'] = 1.e-5
+sim.particles[0].params['gammacentral'] = -2.5
+rf = rebx.load_force('radiation_forces')
+rebx.add_force(rf)
+rf.params['c'] = 1.e4
+sim.particles[3].params['beta'] = 0.1
+mof = rebx.load_force('modify_orbits_forces')
+rebx.add_force(mof)
+sim.particles[5].params['tau_a'] = -1.e3
+sim.integrate(10.)
+reboundx.clibreboundx.rebx_get_isa_name.restype = c_char_p
+print(reboundx.clibreboundx.rebx_get_isa_name().decode('ascii'))
+print([p.x.hex() for p in sim.particles])
+"""
+    def run_isa(self, isa):
+        env = dict(os.environ)
+        env['REBX_ISA'] = isa
+        out = subprocess.check_output([sys.executable, '-c', self.script], env=env).decode('ascii').splitlines()
+        return out[0], out[1]
+
+    def test_variants_identical(self):
+        name, generic = self.run_isa('generic')
+        self.assertEqual(name, 'generic')
+        order = ['generic', 'avx2', 'avx512']
+        for isa in ['avx2', 'avx512']:
+            name, result = self.run_isa(isa)
+            self.assertIn(name, order)
+            self.assertLessEqual(order.index(name), order.index(isa)) # can only lower the variant the CPU supports
+            self.assertEqual(result, generic)
+
 if __name__ == '__main__':
     unittest.main()
 
@@ -3,6 +3,7 @@ import reboundx
 import unittest
 import os
 import numpy as np
+from ctypes import addressof
 
 THIS_DIR = os.path.dirname(os.path.abspath(__file__))
 binary = os.path.join(THIS_DIR, 'binaries/twoplanets.bin')
@@ -71,6 +72,58 @@ class TestConservation(unittest.TestCase):
             sim.move_to_com() # lost mass had momentum, so need to move back to COM frame
         self.assertLess(abs((ps[0].m-m0)/m0), 1.e-2)
         self.assertLess(abs((ps[1].a-a10)/a10), 1.e-2)
-    
+
+    def test_array(self):
+        sim = rebound.Simulation(binary)
+        rebx = reboundx.Extras(sim)
+        times = [0, 2000., 4000., 6000., 8000., 10000.]
+        values = [1., 0.8, 0.6, 0.4, 0.3, 0.2]
+        starmass = reboundx.Interpolator(rebx, times, values, "spline")
+        ts = np.linspace(0., 1.e4, 1001)
+        for t in [ts, ts[::-1], np.random.RandomState(3).permutation(ts)]:
+            ms = starmass.interpolate(rebx, t)
+            for i in range(0, len(t), 50):
+                self.assertEqual(ms[i], starmass.interpolate(rebx, t=t[i]))
+
+    def test_param_saveload(self):
+        sim = rebound.Simulation(binary)
+        rebx = reboundx.Extras(sim)
+        rebx.register_param('starmass', 'REBX_TYPE_INTERPOLATOR')
+        times = [0, 2000., 4000., 6000., 8000., 10000.]
+        values = [1., 0.8, 0.6, 0.4, 0.3, 0.2]
+        starmass = reboundx.Interpolator(rebx, times, values, "spline")
+        sim.particles[0].params['starmass'] = starmass
+        del starmass # param holds its own copy
+        sim.save('test.bin')
+        rebx.save('test.rebx')
+
+        sim2 = rebound.Simulation('test.bin')
+        rebx2 = reboundx.Extras(sim2, 'test.rebx')
+        interp = sim.particles[0].params['starmass']
+        interp2 = sim2.particles[0].params['starmass']
+        self.assertEqual(interp2.Nvalues, len(times))
+        for i in range(interp.Nvalues):
+            self.assertEqual(interp.y2[i], interp2.y2[i])
+        for t in [0., 1234., 5000., 9999.]:
+            self.assertEqual(interp.interpolate(rebx, t), interp2.interpolate(rebx2, t))
+
+    def test_shared_table(self):
+        times = [0, 2000., 4000., 6000., 8000., 10000.]
+        values = [1., 0.8, 0.6, 0.4, 0.3, 0.2]
+        table = reboundx.InterpolatorTable(times, values, "spline")
+        sim1 = rebound.Simulation(binary)
+        rebx1 = reboundx.Extras(sim1)
+        sim2 = rebound.Simulation(binary)
+        rebx2 = reboundx.Extras(sim2)
+        interp1 = reboundx.Interpolator.from_table(table)
+        interp2 = reboundx.Interpolator.from_table(table)
+        del table # interpolators keep the table alive
+        self.assertEqual(addressof(interp1.y2.contents), addressof(interp2.y2.contents))
+        private = reboundx.Interpolator(rebx1, times, values, "spline")
+        interp1.interpolate(rebx1, t=9000.)
+        for t in [9999., 5000., 100.]:
+            self.assertEqual(interp2.interpolate(rebx2, t=t), private.interpolate(rebx1, t=t))
+        self.assertNotEqual(interp1.klo, interp2.klo)
+
 if __name__ == '__main__':
     unittest.main()
@@ -3,6 +3,8 @@ import reboundx
 from reboundx import data
 import unittest
 import math
+import pickle
+import gc
 import numpy as np
 from ctypes import c_uint, c_uint8, c_uint32, c_uint64
 
@@ -184,6 +186,47 @@ class TestParams(unittest.TestCase):
         self.gr.params['my_new_int'] = 2
         self.assertEqual(self.gr.params["my_new_int"], 2)
 
+    def test_registerbuiltin_forcename(self):
+        with self.assertRaises(RuntimeError):
+            self.rebx.register_param('tau_mass', 'REBX_TYPE_INT')
+
+    def test_registry_lookup(self):
+        # every entry of the built-in tables must be found by name, which fails if registry_hash.h wasn't regenerated after editing registry.h
+        self.assertEqual(reboundx.clibreboundx.rebx_registry_check(), 0)
+
+    def test_newparam_saveload(self):
+        self.rebx.register_param('my_new_double', 'REBX_TYPE_DOUBLE')
+        self.gr.params['my_new_double'] = 1.2
+        self.gr.params['c'] = 3.
+        self.sim.save('test.bin')
+        self.rebx.save('test.rebx')
+        sim = rebound.Simulation('test.bin')
+        rebx = reboundx.Extras(sim, 'test.rebx')
+        gr = rebx.get_force("gr")
+        self.assertAlmostEqual(gr.params["my_new_double"], 1.2, delta=1.e-15)
+        self.assertAlmostEqual(gr.params["c"], 3., delta=1.e-15)
+
+    def test_pickle(self):
+        self.gr.params['c'] = 3.
+        self.sim.particles[1].params['tau_mass'] = -1.e4
+        sim, rebx = pickle.loads(pickle.dumps((self.sim, self.rebx)))
+        self.assertIs(sim._extras_ref, rebx)
+        gr = rebx.get_force("gr")
+        self.assertAlmostEqual(gr.params["c"], 3., delta=1.e-15)
+        self.assertAlmostEqual(sim.particles[1].params["tau_mass"], -1.e4, delta=1.e-15)
+
+    def test_pickle_alone(self):
+        self.gr.params['c'] = 1.e4
+        self.rebx.add_force(self.gr)
+        rebx = pickle.loads(pickle.dumps(self.rebx))
+        gc.collect()
+        sim = rebx._sim_ref()
+        self.assertIsNotNone(sim)
+        self.assertIs(sim._extras_ref, rebx)
+        sim.integrate(1.)
+        self.assertAlmostEqual(rebx.get_force("gr").params["c"], 1.e4, delta=1.e-15)
+        self.assertAlmostEqual(sim.t, 1., delta=1.e-15)
+
     def test_length(self):
         self.gr.params['c'] = 1.3
         self.gr.params['gr_source'] = 7
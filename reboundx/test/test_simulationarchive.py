@@ -143,6 +143,22 @@ class TestSimulationArchive(unittest.TestCase):
                 sim.integrate(tmax)
                 self.assertEqual(self.sim.particles[1].x, sim.particles[1].x, msg='REB integrator: {0}, REBX integrator: {1}'.format(integrator, rebxintegrator))
 
+    def test_cached_binary(self):
+        self.rebx.add_force(self.gr)
+        self.sim.simulationarchive_snapshot('test.sa', deletefile=True)
+        self.rebx.save('test.rebx')
+        self.sim.integrate(100)
+        self.sim.simulationarchive_snapshot('test.sa')
+
+        sa = reboundx.SimulationArchive('test.sa', 'test.rebx')
+        with open('test.rebx', 'rb') as f:
+            self.assertEqual(sa.rebxbinary, f.read())
+        for i in range(2):
+            sim, rebx = sa[i]
+            rebxfile = reboundx.Extras(sim, 'test.rebx')
+            self.assertEqual(rebx.gr_hamiltonian(rebx.get_force('gr')), rebxfile.gr_hamiltonian(rebxfile.get_force('gr')))
+            self.assertEqual(rebx.get_force('gr').params['c'], 1e2)
+
 if __name__ == '__main__':
     unittest.main()
 
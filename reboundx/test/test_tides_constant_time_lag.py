@@ -66,6 +66,36 @@ class TestTides(unittest.TestCase):
         self.assertLess(abs((H-H0)/H0), 1.e-12)
         self.assertGreater(self.sim.particles[1].pomega, 1.e-6)
 
+    def test_conservation_pairs(self):
+        self.sim = rebound.Simulation()
+        self.sim.add(m=1.)
+        self.sim.add(m=1.e-3, a=1., r=0.0005)
+        self.sim.add(m=1.e-5, a=0.005, e=0.1, r=0.0001, primary=self.sim.particles[1])
+        self.sim.add(m=1.e-3, a=2., r=0.0005)
+        self.sim.move_to_com()
+        self.rebx = reboundx.Extras(self.sim)
+        self.force = self.rebx.load_force("tides_constant_time_lag")
+        self.rebx.add_force(self.force)
+        ps = self.sim.particles
+        ps[1].params['tctl_k2'] = 0.4
+        ps[2].params['tctl_k2'] = 0.4
+        ps[3].params['tctl_k2'] = 0.4
+        H_primary = self.rebx.tides_constant_time_lag_potential(self.force)
+        self.force.params['tctl_cutoff'] = 0.05
+        self.assertLess(self.rebx.tides_constant_time_lag_potential(self.force), H_primary) # planet-moon tides now included
+
+        H0 = self.sim.calculate_energy() + self.rebx.tides_constant_time_lag_potential(self.force)
+        self.sim.integrate(1.e2*self.sim.particles[1].P)
+        H = self.sim.calculate_energy() + self.rebx.tides_constant_time_lag_potential(self.force)
+        self.assertLess(abs((H-H0)/H0), 1.e-12)
+
+    def test_negative_skin(self):
+        self.sim.particles[1].params['tctl_k2'] = 0.4
+        self.force.params['tctl_cutoff'] = 0.05
+        self.force.params['tctl_skin'] = -0.01
+        with self.assertRaises(RuntimeError):
+            self.sim.integrate(1.)
+
 class TestTidesAnalytic(unittest.TestCase):
     def setUp(self):
         self.sim = rebound.Simulation()
@@ -0,0 +1,75 @@
+#!/usr/bin/python
+# Call this after adding, removing or renaming an entry in src/registry.h.  It writes perfect hash tables for the built-in
+# parameters, forces and operators to src/registry_hash.h, so that registry.c can look up any name with a single string comparison.
+
+import re
+
+def fnv1a(name, seed):
+    # Must match rebx_registry_hash in src/registry.c
+    h = (2166136261 ^ seed) & 0xffffffff
+    for c in name.encode('ascii'):
+        h ^= c
+        h = (h*16777619) & 0xffffffff
+    h ^= h >> 16
+    h = (h*0x85ebca6b) & 0xffffffff
+    h ^= h >> 13
+    return h
+
+def next_pow2(n):
+    m = 1
+    while m < n:
+        m *= 2
+    return m
+
+def perfect_hash(names):
+    # Hash and displace: names are split into G buckets by fnv1a(name, 0), and each bucket gets the first seed d
+    # (tried in order of decreasing bucket size) for which fnv1a(name, d) sends all its names to free slots out of M.
+    M = next_pow2(len(names))
+    G = max(1, M//2)
+    buckets = [[] for _ in range(G)]
+    for i, name in enumerate(names):
+        buckets[fnv1a(name, 0) & (G-1)].append(i)
+    displacements = [0]*G
+    slots = [-1]*M
+    for b in sorted(range(G), key=lambda b: -len(buckets[b])):
+        if not buckets[b]:
+            break
+        d = 1
+        while True:
+            trial = [fnv1a(names[i], d) & (M-1) for i in buckets[b]]
+            if len(set(trial)) == len(trial) and all(slots[s] == -1 for s in trial):
+                break
+            d += 1
+            if d > 1<<20:
+                raise RuntimeError("Could not find a perfect hash for {0}".format([names[i] for i in buckets[b]]))
+        displacements[b] = d
+        for i, s in zip(buckets[b], trial):
+            slots[s] = i
+    return M, G, displacements, slots
+
+def c_array(ctype, name, values):
+    lines = []
+    for i in range(0, len(values), 12):
+        lines.append("    " + ", ".join(str(v) for v in values[i:i+12]))
+    return "static const {0} {1}[{2}] = {{\n{3}\n}};\n".format(ctype, name, len(values), ",\n".join(lines))
+
+with open("../src/registry.h") as f:
+    registry = f.read()
+
+out = "/* Generated by scripts/generate_registry.py from registry.h. Do not edit manually. */\n\n"
+for macro, prefix in [("REBX_PARAM", "PARAM"), ("REBX_FORCE", "FORCE"), ("REBX_OPERATOR", "OPERATOR")]:
+    names = re.findall(r'^' + macro + r'\("([^"]+)"', registry, re.M)
+    if len(set(names)) != len(names):
+        raise ValueError("Duplicate name in {0} entries of registry.h".format(macro))
+    M, G, displacements, slots = perfect_hash(names)
+    lower = prefix.lower()
+    out += "#define REBX_{0}_TABLE_N {1}\n".format(prefix, len(names))
+    out += "#define REBX_{0}_HASH_M {1}\n".format(prefix, M)
+    out += "#define REBX_{0}_HASH_G {1}\n".format(prefix, G)
+    out += c_array("uint32_t", "rebx_{0}_hash_displacements".format(lower), displacements)
+    out += c_array("int16_t", "rebx_{0}_hash_slots".format(lower), slots)
+    out += "\n"
+
+with open("../src/registry_hash.h", "w") as f:
+    f.write(out)
+print("Wrote perfect hash tables to src/registry_hash.h")
@@ -59,29 +59,72 @@
 #include <float.h>
 #include "rebound.h"
 #include "reboundx.h"
+#include "core.h"
+#include "rebxtools.h"
 
-static void rebx_calculate_central_force(struct reb_simulation* const sim, struct reb_particle* const particles, const int N, const double A, const double gamma, const int source_index){
+// Independent per-particle terms go in w (4*N doubles) in a loop the compiler can vectorize. The back reactions on the source are then added in order
+REBX_KERNEL void rebx_calculate_central_force_kernel_body(struct reb_particle* const particles, const int N, const double A, const double gamma, const int source_index, double* const w){
     const struct reb_particle source = particles[source_index];
+    double* const wx = w;
+    double* const wy = w + N;
+    double* const wz = w + 2*N;
+    double* const wprefac = w + 3*N;
+#pragma omp simd
+    for (int i=0; i<N; i++){
+        const double dx = particles[i].x - source.x;
+        const double dy = particles[i].y - source.y;
+        const double dz = particles[i].z - source.z;
+        const double r2 = dx*dx + dy*dy + dz*dz;
+        wx[i] = dx;
+        wy[i] = dy;
+        wz[i] = dz;
+        wprefac[i] = A*pow(r2, (gamma-1.)/2.);
+    }
     for (int i=0; i<N; i++){
         if(i == source_index){
             continue;
         }
-        const struct reb_particle p = particles[i];
-        const double dx = p.x - source.x;
-        const double dy = p.y - source.y;
-        const double dz = p.z - source.z;
+        const double prefac = wprefac[i];
+        particles[i].ax += prefac*wx[i];
+        particles[i].ay += prefac*wy[i];
+        particles[i].az += prefac*wz[i];
+        particles[source_index].ax -= particles[i].m/source.m*prefac*wx[i];
+        particles[source_index].ay -= particles[i].m/source.m*prefac*wy[i];
+        particles[source_index].az -= particles[i].m/source.m*prefac*wz[i];
+    }
+}
+
+REBX_MULTIVERSION(rebx_calculate_central_force_kernel, (struct reb_particle* const particles, const int N, const double A, const double gamma, const int source_index, double* const w), (particles, N, A, gamma, source_index, w))
+
+// Test particles don't act back on the source, so each one is independent
+static void rebx_calculate_central_force_test_particles(struct reb_particle* const particles, const int N_massive, const int N, const double A, const double gamma, const int source_index){
+    const struct reb_particle source = particles[source_index];
+#pragma omp parallel for schedule(static)
+    for (int i=N_massive; i<N; i++){
+        const double dx = particles[i].x - source.x;
+        const double dy = particles[i].y - source.y;
+        const double dz = particles[i].z - source.z;
         const double r2 = dx*dx + dy*dy + dz*dz;
         const double prefac = A*pow(r2, (gamma-1.)/2.);
-
         particles[i].ax += prefac*dx;
         particles[i].ay += prefac*dy;
         particles[i].az += prefac*dz;
-        particles[source_index].ax -= p.m/source.m*prefac*dx;
-        particles[source_index].ay -= p.m/source.m*prefac*dy;
-        particles[source_index].az -= p.m/source.m*prefac*dz;
     }
 }
 
+static void rebx_calculate_central_force(struct reb_simulation* const sim, struct reb_particle* const particles, const int N, const double A, const double gamma, const int source_index){
+    int N_massive = rebx_get_N_massive(sim, N);
+    if (source_index >= N_massive){
+        N_massive = N;
+    }
+    double* const w = rebx_get_workspace(sim->extras, 4*N_massive*sizeof(*w));
+    if (w == NULL){
+        return;
+    }
+    rebx_calculate_central_force_kernel(particles, N_massive, A, gamma, source_index, w);
+    rebx_calculate_central_force_test_particles(particles, N_massive, N, A, gamma, source_index);
+}
+
 void rebx_central_force(struct reb_simulation* const sim, struct rebx_force* const force, struct reb_particle* const particles, const int N){
     for (int i=0; i<N; i++){
         const double* const Acentral = rebx_get_param(sim->extras, particles[i].ap, "Acentral");
@@ -94,29 +137,39 @@ void rebx_central_force(struct reb_simulation* const sim, struct rebx_force* con
     }
 }
 
-static double rebx_calculate_central_force_potential(struct reb_simulation* const sim, const double A, const double gamma, const int source_index){
+// geometry holds the distances from the source if they were already computed for another effect, otherwise NULL
+static double rebx_calculate_central_force_potential(struct reb_simulation* const sim, const double A, const double gamma, const int source_index, const struct rebx_source_geometry* const geometry, double* const H){
     const struct reb_particle* const particles = sim->particles;
 	const int _N_real = sim->N - sim->N_var;
     const struct reb_particle source = particles[source_index];
-    double H = 0.;
+    const int log_potential = fabs(gamma+1.) < DBL_EPSILON; // F propto 1/r
+    // Per-particle terms in parallel, then summed serially so the result doesn't depend on the number of threads
+#pragma omp parallel for schedule(static)
 	for (int i=0;i<_N_real;i++){
 		if(i == source_index){
+            H[i] = 0.;
             continue;
         }
         const struct reb_particle p = particles[i];
-        const double dx = p.x - source.x;
-        const double dy = p.y - source.y;
-        const double dz = p.z - source.z;
-        const double r2 = dx*dx + dy*dy + dz*dz;
+        double r2;
+        if (geometry != NULL){
+            r2 = geometry->r2[i];
+        }
+        else{
+            const double dx = p.x - source.x;
+            const double dy = p.y - source.y;
+            const double dz = p.z - source.z;
+            r2 = dx*dx + dy*dy + dz*dz;
+        }
 
-        if (fabs(gamma+1.) < DBL_EPSILON){ // F propto 1/r
-            H -= p.m*A*log(sqrt(r2));
+        if (log_potential){
+            H[i] = -p.m*A*log(sqrt(r2));
         }
         else{
-            H -= p.m*A*pow(r2, (gamma+1.)/2.)/(gamma+1.);
+            H[i] = -p.m*A*pow(r2, (gamma+1.)/2.)/(gamma+1.);
         }
     }		
-    return H;
+    return rebx_compensated_sum(H, _N_real);
 }
 
 double rebx_central_force_potential(struct rebx_extras* const rebx){
@@ -127,17 +180,22 @@ double rebx_central_force_potential(struct rebx_extras* const rebx){
     struct reb_simulation* sim = rebx->sim;
     const int N_real = sim->N - sim->N_var;
     struct reb_particle* const particles = sim->particles;
+    double* const H = rebx_get_workspace(rebx, N_real*sizeof(*H));
+    if (H == NULL){
+        return 0;
+    }
     double Htot = 0.;
+    double c = 0.;
     for (int i=0; i<N_real; i++){
         const double* const Acentral = rebx_get_param(rebx, particles[i].ap, "Acentral");
         if (Acentral != NULL){
             const double* const gammacentral = rebx_get_param(rebx, particles[i].ap, "gammacentral");
             if (gammacentral != NULL){
-                Htot += rebx_calculate_central_force_potential(sim, *Acentral, *gammacentral, i);
+                rebx_neumaier_add(&Htot, &c, rebx_calculate_central_force_potential(sim, *Acentral, *gammacentral, i, rebx_get_source_geometry(rebx, i), H));
             }
         }
     }
-    return Htot;
+    return Htot + c;
 }
 
 double rebx_central_force_Acentral(const struct reb_particle p, const struct reb_particle primary, const double pomegadot, const double gamma){
@@ -31,6 +31,9 @@
 #include <string.h>
 #include <limits.h>
 #include <float.h>
+#if defined(REBX_HUGEPAGES) && defined(__linux__)
+#include <sys/mman.h>
+#endif
 #include "core.h"
 #include "rebound.h"
 #include "linkedlist.h"
@@ -49,84 +52,12 @@ const char* rebx_githash_str = STRINGIFY(REBXGITHASH);             // This line
  ****************************/
 
 void rebx_register_default_params(struct rebx_extras* rebx){
-    rebx_register_param(rebx, "c", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "gr_source", REBX_TYPE_INT);
-    rebx_register_param(rebx, "tau_mass", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "force", REBX_TYPE_FORCE);
-    rebx_register_param(rebx, "particle", REBX_TYPE_POINTER);
-    rebx_register_param(rebx, "Acentral", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "gammacentral", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "max_iterations", REBX_TYPE_INT);
-    rebx_register_param(rebx, "J2", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "J4", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "R_eq", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "coordinates", REBX_TYPE_INT);
-    rebx_register_param(rebx, "p", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "tau_a", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "tau_e", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "tau_inc", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "tau_omega", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "tau_Omega", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "em_tau_a", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "em_aini", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "em_afin", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "primary", REBX_TYPE_INT);
-    rebx_register_param(rebx, "radiation_source", REBX_TYPE_INT);
-    rebx_register_param(rebx, "kappa", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "kappa_x", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "kappa_y", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "kappa_z", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "tau_kappa", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "tau_kappa_x", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "tau_kappa_y", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "tau_kappa_z", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "stochastic_force_r", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "stochastic_force_phi", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "stochastic_force_x", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "stochastic_force_y", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "stochastic_force_z", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "beta", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "tides_primary", REBX_TYPE_INT);
-    rebx_register_param(rebx, "R_tides", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "tctl_k2", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "tctl_tau", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "Omega", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "integrator", REBX_TYPE_INT);
-    rebx_register_param(rebx, "free_arrays", REBX_TYPE_POINTER);
-    rebx_register_param(rebx, "im_ps_final", REBX_TYPE_POINTER);
-    rebx_register_param(rebx, "im_ps_prev", REBX_TYPE_POINTER);
-    rebx_register_param(rebx, "im_ps_avg", REBX_TYPE_POINTER);
-    rebx_register_param(rebx, "rk2_k2", REBX_TYPE_POINTER);
-    rebx_register_param(rebx, "rk4_k2", REBX_TYPE_POINTER);
-    rebx_register_param(rebx, "rk4_k3", REBX_TYPE_POINTER);
-    rebx_register_param(rebx, "min_distance", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "min_distance_from", REBX_TYPE_UINT32);
-    rebx_register_param(rebx, "min_distance_orbit", REBX_TYPE_ORBIT);
-    rebx_register_param(rebx, "luminosity", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "ide_position", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "ide_width", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "tIm_flaring_index", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "tIm_scale_height_1", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "tIm_surface_density_1", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "tIm_surface_density_exponent", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "ye_c", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "ye_body_density", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "ye_lstar", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "ye_flag", REBX_TYPE_INT);
-    rebx_register_param(rebx, "ye_rotation_period", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "ye_thermal_inertia", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "ye_albedo", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "ye_emissivity", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "ye_k", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "ye_stef_boltz", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "ye_spin_axis_x", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "ye_spin_axis_y", REBX_TYPE_DOUBLE);
-    rebx_register_param(rebx, "ye_spin_axis_z", REBX_TYPE_DOUBLE);
+    // Built-in params are in the static table generated from registry.h (see registry.c), so there is nothing to register per instance.
 }
 
 void rebx_register_param(struct rebx_extras* const rebx, const char* name, enum rebx_param_type type){
     
-    // check registered_params for entry
+    // check built-in table and registered_params for entry
     enum rebx_param_type reg_type = rebx_get_type(rebx, name);
     
     if (reg_type != REBX_TYPE_NONE){
@@ -200,6 +131,15 @@ void rebx_initialize(struct reb_simulation* sim, struct rebx_extras* rebx){
     rebx->post_timestep_modifications=NULL;
     rebx->allocated_forces=NULL;
     rebx->allocated_operators=NULL;
+    rebx->workspace=NULL;
+    rebx->workspace_size=0;
+    rebx->gravity_acc=NULL;
+    rebx->gravity_acc_N=0;
+    rebx->gravity_acc_valid=0;
+    rebx->dense_particles=NULL;
+    rebx->dense_particles_N=0;
+    rebx->trace=NULL;
+    rebx->geometry=NULL;
     rebx->registered_params=NULL;
     
     sim->free_particle_ap = rebx_free_particle_ap;
@@ -262,53 +202,10 @@ struct rebx_force* rebx_load_force(struct rebx_extras* const rebx, const char* n
     if (force == NULL){
         return NULL;
     }
-    if(strcmp(name, "gr") == 0){
-        force->update_accelerations = rebx_gr;
-        force->force_type = REBX_FORCE_VEL;
-    }
-    else if (strcmp(name, "central_force") == 0){
-        force->update_accelerations = rebx_central_force;
-        force->force_type = REBX_FORCE_POS;
-    }
-    else if (strcmp(name, "modify_orbits_forces") == 0){
-        force->update_accelerations = rebx_modify_orbits_forces;
-        force->force_type = REBX_FORCE_VEL;
-    }
-    else if (strcmp(name, "exponential_migration") == 0){
-        force->update_accelerations = rebx_exponential_migration;
-        force->force_type = REBX_FORCE_VEL;
-    }
-    else if (strcmp(name, "gr_full") == 0){
-        force->update_accelerations = rebx_gr_full;
-        force->force_type = REBX_FORCE_VEL;
-    }
-    else if (strcmp(name, "gravitational_harmonics") == 0){
-        force->update_accelerations = rebx_gravitational_harmonics;
-        force->force_type = REBX_FORCE_POS;
-    }
-    else if (strcmp(name, "gr_potential") == 0){
-        force->update_accelerations = rebx_gr_potential;
-        force->force_type = REBX_FORCE_POS;
-    }
-    else if (strcmp(name, "radiation_forces") == 0){
-        force->update_accelerations = rebx_radiation_forces;
-        force->force_type = REBX_FORCE_VEL;
-    }
-    else if (strcmp(name, "stochastic_forces") == 0){
-        force->update_accelerations = rebx_stochastic_forces;
-        force->force_type = REBX_FORCE_VEL;
-    }
-    else if (strcmp(name, "tides_constant_time_lag") == 0){
-        force->update_accelerations = rebx_tides_constant_time_lag;
-        force->force_type = REBX_FORCE_VEL;
-    }
-    else if (strcmp(name, "type_I_migration") == 0){
-        force->update_accelerations = rebx_modify_orbits_with_type_I_migration;
-        force->force_type = REBX_FORCE_VEL;
-    }
-    else if (strcmp(name, "yarkovsky_effect") == 0){
-        force->update_accelerations = rebx_yarkovsky_effect;
-        force->force_type = REBX_FORCE_VEL;
+    const struct rebx_registry_force* const entry = rebx_registry_get_force(name);
+    if (entry != NULL){
+        force->update_accelerations = entry->update_accelerations;
+        force->force_type = entry->force_type;
     }
     else{
         char str[300];
@@ -338,7 +235,7 @@ struct rebx_operator* rebx_create_operator(struct rebx_extras* const rebx, const
     if(name != NULL){
         operator->name = rebx_malloc(rebx, strlen(name) + 1); // +1 for \0 at end
         if (operator->name == NULL){
-            rebx_free_operator(operator);
+            rebx_free_operator(rebx, operator);
             return NULL;
         }
         else{
@@ -349,7 +246,7 @@ struct rebx_operator* rebx_create_operator(struct rebx_extras* const rebx, const
     // Add operator to allocated_operators list for later freeing
     struct rebx_node* node = rebx_create_node(rebx);
     if (node == NULL){
-        rebx_free_operator(operator);
+        rebx_free_operator(rebx, operator);
         return NULL;
     }
     node->object = operator;
@@ -363,45 +260,10 @@ struct rebx_operator* rebx_load_operator(struct rebx_extras* const rebx, const c
     if (operator == NULL){
         return NULL;
     }
-    if (strcmp(name, "modify_mass") == 0){
-        operator->step_function = rebx_modify_mass;
-        operator->operator_type = REBX_OPERATOR_UPDATER;
-    }
-    else if (strcmp(name, "integrate_force") == 0){
-        operator->step_function = rebx_integrate_force;
-        operator->operator_type = REBX_OPERATOR_UPDATER;
-    }
-    else if (strcmp(name, "drift") == 0){
-        operator->step_function = rebx_drift_step;
-        operator->operator_type = REBX_OPERATOR_UPDATER;
-    }
-    else if (strcmp(name, "kick") == 0){
-        operator->step_function = rebx_kick_step;
-        operator->operator_type = REBX_OPERATOR_UPDATER;
-    }
-    else if (strcmp(name, "kepler") == 0){
-        operator->step_function = rebx_kepler_step;
-        operator->operator_type = REBX_OPERATOR_UPDATER;
-    }
-    else if (strcmp(name, "jump") == 0){
-        operator->step_function = rebx_jump_step;
-        operator->operator_type = REBX_OPERATOR_UPDATER;
-    }
-    else if (strcmp(name, "interaction") == 0){
-        operator->step_function = rebx_interaction_step;
-        operator->operator_type = REBX_OPERATOR_UPDATER;
-    }
-    else if (strcmp(name, "ias15") == 0){
-        operator->step_function = rebx_ias15_step;
-        operator->operator_type = REBX_OPERATOR_UPDATER;
-    }
-    else if (strcmp(name, "modify_orbits_direct") == 0){
-        operator->step_function = rebx_modify_orbits_direct;
-        operator->operator_type = REBX_OPERATOR_UPDATER;
-    }
-    else if (strcmp(name, "track_min_distance") == 0){
-        operator->step_function = rebx_track_min_distance;
-        operator->operator_type = REBX_OPERATOR_RECORDER;
+    const struct rebx_registry_operator* const entry = rebx_registry_get_operator(name);
+    if (entry != NULL){
+        operator->step_function = entry->step_function;
+        operator->operator_type = entry->operator_type;
     }
     else{
         char str[300];
@@ -504,6 +366,28 @@ int rebx_add_operator_step(struct rebx_extras* rebx, struct rebx_operator* opera
     return 0;
 }
     
+int rebx_add_operator_interval(struct rebx_extras* rebx, struct rebx_operator* operator, const double interval){
+    if (rebx->sim == NULL){
+        rebx_error(rebx, ""); // rebx_error gives meaningful err
+        return 0;
+    }
+    if (operator == NULL){
+        rebx_error(rebx, "REBOUNDx error: Passed NULL pointer to rebx_add_operator_interval.\n");
+        return 0;
+    }
+    if (!(interval > 0.)){
+        rebx_error(rebx, "REBOUNDx error: Interval passed to rebx_add_operator_interval must be positive.\n");
+        return 0;
+    }
+    if (rebx->sim->integrator != REB_INTEGRATOR_IAS15){
+        rebx_error(rebx, "REBOUNDx error: rebx_add_operator_interval requires the IAS15 integrator, which can interpolate the particle states to the grid times. For other integrators, use rebx_add_operator_step with a fixed timestep instead.\n");
+        return 0;
+    }
+    rebx_set_param_double(rebx, &operator->ap, "operator_interval", interval);
+    rebx_set_param_double(rebx, &operator->ap, "operator_next_time", rebx->sim->t + interval);
+    return rebx_add_operator_step(rebx, operator, 1., REBX_TIMING_POST);
+}
+
 int rebx_add_operator(struct rebx_extras* rebx, struct rebx_operator* operator){
     if (rebx->sim == NULL){
         rebx_error(rebx, ""); // rebx_error gives meaningful err
@@ -639,6 +523,28 @@ void rebx_set_param_uint32(struct rebx_extras* const rebx, struct rebx_node** ap
     return;
 }
 
+void rebx_set_param_interpolator(struct rebx_extras* const rebx, struct rebx_node** apptr, const char* const param_name, const struct rebx_interpolator* const interpolator){
+    if (rebx_get_type(rebx, param_name) != REBX_TYPE_INTERPOLATOR){
+        char str[300];
+        sprintf(str, "REBOUNDx Error: Parameter '%.100s' needs to be registered with type REBX_TYPE_INTERPOLATOR.\n", param_name);
+        rebx_error(rebx, str);
+        return;
+    }
+    struct rebx_param* param = rebx_get_or_add_param(rebx, apptr, param_name);
+    if (param == NULL){
+        return;
+    }
+    struct rebx_interpolator* const copy = rebx_copy_interpolator(rebx, interpolator);
+    if (copy == NULL){
+        return;
+    }
+    if (param->value != NULL){
+        rebx_free_interpolator(param->value);
+    }
+    param->value = copy;
+    return;
+}
+
 /*******************************************************************
  User interface for getting REBOUNDx objects and parameters
  *******************************************************************/
@@ -742,7 +648,7 @@ static int rebx_remove_step_node(struct rebx_node** head, struct rebx_operator*
 int rebx_remove_operator(struct rebx_extras* rebx, struct rebx_operator* operator){
     int allocated = rebx_remove_node(&rebx->allocated_operators, operator);
     if(allocated){
-        rebx_free_operator(operator);
+        rebx_free_operator(rebx, operator);
         
     }
     
@@ -782,16 +688,64 @@ void* rebx_malloc(struct rebx_extras* const rebx, size_t memsize){
     return ptr;
 }
 
+/* Per-particle buffers above this size are aligned to huge pages (and, if compiled with -DREBX_HUGEPAGES, hinted for
+ * transparent huge pages on Linux). Below it, plain malloc is cheaper. */
+#ifndef REBX_LARGE_ALLOC_THRESHOLD
+#define REBX_LARGE_ALLOC_THRESHOLD (2*1024*1024)
+#endif
+#define REBX_HUGE_PAGE_SIZE (2*1024*1024)
+#if (defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE >= 200112L) || defined(__APPLE__)
+#define REBX_HAVE_POSIX_MEMALIGN
+#endif
+
+// Only provides the alignment (and the optional huge-page hint). The buffer is not touched here, so NUMA placement is left
+// to whichever loop first writes it; no parallel first touch is done.
+void* rebx_malloc_large(struct rebx_extras* const rebx, size_t memsize){
+    if (memsize < REBX_LARGE_ALLOC_THRESHOLD){
+        return rebx_malloc(rebx, memsize);
+    }
+#ifdef REBX_HAVE_POSIX_MEMALIGN
+    void* ptr = NULL;
+    // Align to huge pages so the kernel can back the whole buffer with them
+    if (posix_memalign(&ptr, REBX_HUGE_PAGE_SIZE, memsize) != 0){
+        rebx_error(rebx, "REBOUNDx Error: Could not allocate memory.\n");
+        return NULL;
+    }
+#if defined(REBX_HUGEPAGES) && defined(MADV_HUGEPAGE)
+    madvise(ptr, memsize, MADV_HUGEPAGE); // only a hint, ignore failure
+#endif
+    return ptr;
+#else
+    return rebx_malloc(rebx, memsize); // no aligned allocation that can be released with free()
+#endif
+}
+
+void* rebx_get_workspace(struct rebx_extras* const rebx, const size_t memsize){
+    if (memsize > rebx->workspace_size){
+        free(rebx->workspace);
+        rebx->workspace_size = 0;
+        rebx->workspace = rebx_malloc_large(rebx, memsize);
+        if (rebx->workspace == NULL){
+            return NULL;
+        }
+        rebx->workspace_size = memsize;
+    }
+    return rebx->workspace;
+}
+
 void rebx_free_param(struct rebx_param* param){
     if(param->name){
         free(param->name);
     }
     // Don't free pointers to structs
-    if(param->type == REBX_TYPE_INT || param->type == REBX_TYPE_DOUBLE){
+    if(param->type == REBX_TYPE_INT || param->type == REBX_TYPE_DOUBLE || param->type == REBX_TYPE_UINT32){
         if(param->value){
             free(param->value);
         }
     }
+    if(param->type == REBX_TYPE_INTERPOLATOR && param->value){ // interpolator params hold a copy owned by REBOUNDx
+        rebx_free_interpolator(param->value);
+    }
     free(param);
 }
 
@@ -822,7 +776,11 @@ void rebx_free_force(struct rebx_extras* rebx, struct rebx_force* force){
     free(force);
 }
 
-void rebx_free_operator(struct rebx_operator* operator){
+void rebx_free_operator(struct rebx_extras* rebx, struct rebx_operator* operator){
+    void (*free_arrays)(struct rebx_extras* rebx, struct rebx_operator* operator) = rebx_get_param(rebx, operator->ap, "free_arrays");
+    if (free_arrays){
+        free_arrays(rebx, operator);
+    }
     if(operator->name){
         free(operator->name);
     }
@@ -860,7 +818,7 @@ void rebx_free_pointers(struct rebx_extras* rebx){
     current = rebx->allocated_operators;
     while (current != NULL){
         next = current->next;
-        rebx_free_operator(current->object);
+        rebx_free_operator(rebx, current->object);
         free(current);
         current = next;
     }
@@ -896,6 +854,24 @@ void rebx_free_pointers(struct rebx_extras* rebx){
         free(current);
         current = next;
     }
+    
+    free(rebx->workspace);
+    rebx->workspace = NULL;
+    rebx->workspace_size = 0;
+    free(rebx->gravity_acc);
+    rebx->gravity_acc = NULL;
+    rebx->gravity_acc_N = 0;
+    rebx->gravity_acc_valid = 0;
+    free(rebx->dense_particles);
+    rebx->dense_particles = NULL;
+    rebx->dense_particles_N = 0;
+    rebx_trace_free(rebx);
+    if (rebx->geometry != NULL){
+        free(rebx->geometry->r2);
+        free(rebx->geometry->dz);
+        free(rebx->geometry);
+        rebx->geometry = NULL;
+    }
 }
 
 /**********************************************
@@ -910,8 +886,81 @@ void rebx_reset_accelerations(struct reb_particle* const ps, const int N){
     }
 }
 
+// Saves REBOUND's gravitational accelerations before forces modify them, if any added force asked to reuse them (currently gr with gr_reuse_gravity)
+static void rebx_store_gravity_acc(struct reb_simulation* const sim, struct rebx_extras* const rebx){
+    rebx->gravity_acc_valid = 0;
+    int needed = 0;
+    for (struct rebx_node* current = rebx->additional_forces; current != NULL; current = current->next){
+        const struct rebx_force* const force = current->object;
+        if (force->update_accelerations == rebx_gr){
+            const int* const gr_reuse_gravity = rebx_get_param(rebx, force->ap, "gr_reuse_gravity");
+            if (gr_reuse_gravity != NULL && *gr_reuse_gravity){
+                needed = 1;
+                break;
+            }
+        }
+    }
+    if (!needed){
+        return;
+    }
+    const int N = sim->N - sim->N_var;
+    if (rebx->gravity_acc_N < N){
+        free(rebx->gravity_acc);
+        rebx->gravity_acc_N = 0;
+        rebx->gravity_acc = rebx_malloc(rebx, N*sizeof(*rebx->gravity_acc));
+        if (rebx->gravity_acc == NULL){
+            return;
+        }
+        rebx->gravity_acc_N = N;
+    }
+    const struct reb_particle* const ps = sim->particles;
+    for (int i=0; i<N; i++){
+        rebx->gravity_acc[i].x = ps[i].ax;
+        rebx->gravity_acc[i].y = ps[i].ay;
+        rebx->gravity_acc[i].z = ps[i].az;
+    }
+    rebx->gravity_acc_valid = 1;
+}
+
+const struct rebx_source_geometry* rebx_get_source_geometry(struct rebx_extras* const rebx, const int source_index){
+    struct rebx_source_geometry* const geometry = rebx->geometry;
+    if (geometry == NULL || !geometry->active){
+        return NULL;
+    }
+    if (geometry->source == source_index){
+        return geometry;
+    }
+    const struct reb_simulation* const sim = rebx->sim;
+    const int N = sim->N - sim->N_var;
+    if (geometry->N < N){
+        free(geometry->r2);
+        free(geometry->dz);
+        geometry->N = 0;
+        geometry->r2 = rebx_malloc(rebx, N*sizeof(*geometry->r2));
+        geometry->dz = rebx_malloc(rebx, N*sizeof(*geometry->dz));
+        if (geometry->r2 == NULL || geometry->dz == NULL){
+            return NULL;
+        }
+        geometry->N = N;
+    }
+    const struct reb_particle* const particles = sim->particles;
+    const struct reb_particle source = particles[source_index];
+#pragma omp parallel for schedule(static)
+    for (int i=0; i<N; i++){
+        const double dx = particles[i].x - source.x;
+        const double dy = particles[i].y - source.y;
+        const double dz = particles[i].z - source.z;
+        geometry->r2[i] = dx*dx + dy*dy + dz*dz;
+        geometry->dz[i] = dz;
+    }
+    geometry->source = source_index;
+    return geometry;
+}
+
 void rebx_additional_forces(struct reb_simulation* sim){
     struct rebx_extras* rebx = sim->extras;
+    rebx_store_gravity_acc(sim, rebx);
+    const int evaluation = (rebx->trace != NULL) ? rebx_trace_next_evaluation(rebx) : 0;
     struct rebx_node* current = rebx->additional_forces;
     while(current != NULL){
         /*if(sim->force_is_velocity_dependent && sim->integrator==REB_INTEGRATOR_WHFAST){
@@ -919,9 +968,14 @@ void rebx_additional_forces(struct reb_simulation* sim){
          }*/
         struct rebx_force* force = current->object;
         const double N = sim->N - sim->N_var;
+        const double trace_begin = (rebx->trace != NULL) ? rebx_trace_begin() : 0.;
         force->update_accelerations(sim, force, sim->particles, N);
+        if (rebx->trace != NULL){
+            rebx_trace_end(rebx, trace_begin, force->name, REBX_TRACE_FORCE, evaluation);
+        }
         current = current->next;
     }
+    rebx->gravity_acc_valid = 0; // only valid during this force evaluation (e.g., not when forces are integrated as operators)
 }
 
 void rebx_pre_timestep_modifications(struct reb_simulation* sim){
@@ -933,13 +987,144 @@ void rebx_pre_timestep_modifications(struct reb_simulation* sim){
         struct rebx_step* step = current->object;
         struct rebx_operator* operator = step->operator;
         if(sim->integrator==REB_INTEGRATOR_IAS15 && sim->ri_ias15.epsilon != 0 && operator->operator_type == REBX_OPERATOR_UPDATER){
-            reb_warning(sim, "REBOUNDx: Operators that affect particle trajectories with adaptive timesteps can give spurious results. Use sim.ri_ias15.epsilon=0 for fixed timestep with IAS, or use a different integrator.");
+            reb_warning(sim, "REBOUNDx: Operators that affect particle trajectories with adaptive timesteps can give spurious results. Use sim.ri_ias15.epsilon=0 for fixed timestep with IAS, add the operator on a fixed time grid with rebx_add_operator_interval, or use a different integrator.");
         }
+        const double trace_begin = (rebx->trace != NULL) ? rebx_trace_begin() : 0.;
         operator->step_function(sim, operator, dt*step->dt_fraction);
+        if (rebx->trace != NULL){
+            rebx_trace_end(rebx, trace_begin, operator->name, REBX_TRACE_PRE_TIMESTEP, -1);
+        }
         current = current->next;
     }
 }
 
+// Velocity and position increments from the start of an IAS15 step at fraction h of the step (Rein & Spiegel 2015, eqs. 9-10)
+static double rebx_ias15_dv(const double* const b, const double a0, const double dt, const double h){
+    return h*dt*(a0 + h*(b[0]/2. + h*(b[1]/3. + h*(b[2]/4. + h*(b[3]/5. + h*(b[4]/6. + h*(b[5]/7. + h*b[6]/8.)))))));
+}
+
+static double rebx_ias15_dx(const double* const b, const double a0, const double dt, const double h){
+    return h*h*dt*dt*(a0/2. + h*(b[0]/6. + h*(b[1]/12. + h*(b[2]/20. + h*(b[3]/30. + h*(b[4]/42. + h*(b[5]/56. + h*b[6]/72.)))))));
+}
+
+// Evaluates IAS15's interpolating polynomial for the last completed step (coefficients br, initial accelerations a0) at fraction h of the step.
+// end holds the particles at the end of the step. Positions, velocities and accelerations of sim->particles are set to the interpolated values.
+static void rebx_ias15_interpolate(struct reb_simulation* const sim, const struct reb_particle* const end, const int N, const double h){
+    const struct reb_simulation_integrator_ias15* const ri = &sim->ri_ias15;
+    const double dt = sim->dt_last_done;
+    const int Nslots = ri->allocatedN/3;
+    for (int j=0; j<Nslots; j++){
+        const int i = (ri->map == NULL) ? j : ri->map[j];
+        if (i >= N){
+            continue;
+        }
+        double x[3], v[3], a[3];
+        const double x_end[3] = {end[i].x, end[i].y, end[i].z};
+        const double v_end[3] = {end[i].vx, end[i].vy, end[i].vz};
+        for (int c=0; c<3; c++){
+            const int k = 3*j+c;
+            const double b[7] = {ri->br.p0[k], ri->br.p1[k], ri->br.p2[k], ri->br.p3[k], ri->br.p4[k], ri->br.p5[k], ri->br.p6[k]};
+            const double a0 = ri->a0[k];
+            const double v_start = v_end[c] - rebx_ias15_dv(b, a0, dt, 1.);
+            const double x_start = x_end[c] - dt*v_start - rebx_ias15_dx(b, a0, dt, 1.);
+            x[c] = x_start + h*dt*v_start + rebx_ias15_dx(b, a0, dt, h);
+            v[c] = v_start + rebx_ias15_dv(b, a0, dt, h);
+            a[c] = a0 + h*(b[0] + h*(b[1] + h*(b[2] + h*(b[3] + h*(b[4] + h*(b[5] + h*b[6]))))));
+        }
+        struct reb_particle* const p = &sim->particles[i];
+        p->x = x[0]; p->y = x[1]; p->z = x[2];
+        p->vx = v[0]; p->vy = v[1]; p->vz = v[2];
+        p->ax = a[0]; p->ay = a[1]; p->az = a[2];
+    }
+}
+
+static void rebx_copy_kinematics(struct reb_particle* const dest, const struct reb_particle* const src, const int N){
+    for (int i=0; i<N; i++){
+        dest[i].x = src[i].x; dest[i].y = src[i].y; dest[i].z = src[i].z;
+        dest[i].vx = src[i].vx; dest[i].vy = src[i].vy; dest[i].vz = src[i].vz;
+        dest[i].ax = src[i].ax; dest[i].ay = src[i].ay; dest[i].az = src[i].az;
+    }
+}
+
+// Applies an operator at every point of its fixed time grid (spacing operator_interval) that was crossed by the last timestep.
+// With IAS15, the operator acts on the states interpolated to the grid times, and its changes are carried over to the end of the step.
+// If interpolation isn't possible (e.g., the integrator was changed after adding the operator), it acts on the state at the end of the step,
+// and sim->t is left at the end of the step so that the time matches the state the operator sees.
+static void rebx_apply_operator_on_grid(struct reb_simulation* const sim, struct rebx_operator* const operator, const double interval){
+    struct rebx_extras* const rebx = sim->extras;
+    const double* const next_time = rebx_get_param(rebx, operator->ap, "operator_next_time");
+    const double t_end = sim->t;
+    const double dt_done = sim->dt_last_done;
+    double next = (next_time == NULL) ? t_end - dt_done + interval : *next_time;
+    if (next > t_end){
+        if (next_time == NULL){
+            rebx_set_param_double(rebx, &operator->ap, "operator_next_time", next);
+        }
+        return;
+    }
+
+    const int N = sim->N - sim->N_var;
+    if (rebx->dense_particles_N < 2*N){
+        free(rebx->dense_particles);
+        rebx->dense_particles_N = 0;
+        rebx->dense_particles = rebx_malloc(rebx, 2*N*sizeof(*rebx->dense_particles));
+        if (rebx->dense_particles == NULL){
+            return;
+        }
+        rebx->dense_particles_N = 2*N;
+    }
+    struct reb_particle* const end = rebx->dense_particles;
+    struct reb_particle* const grid = rebx->dense_particles + N;
+    memcpy(end, sim->particles, N*sizeof(*end));
+    const int interpolate = (sim->integrator == REB_INTEGRATOR_IAS15 && dt_done > 0. && sim->ri_ias15.allocatedN >= 3*N && sim->ri_ias15.a0 != NULL);
+
+    while (next <= t_end){
+        if (interpolate){
+            rebx_ias15_interpolate(sim, end, N, 1. + (next - t_end)/dt_done);
+        }
+        else{
+            rebx_copy_kinematics(sim->particles, end, N);
+        }
+        memcpy(grid, sim->particles, N*sizeof(*grid));
+        if (interpolate){
+            sim->t = next;
+        }
+        const double trace_begin = (rebx->trace != NULL) ? rebx_trace_begin() : 0.;
+        operator->step_function(sim, operator, interval);
+        if (rebx->trace != NULL){
+            rebx_trace_end(rebx, trace_begin, operator->name, REBX_TRACE_POST_TIMESTEP, -1);
+        }
+        if (sim->N - sim->N_var != N){
+            reb_error(sim, "REBOUNDx Error: Operators applied on a time grid cannot add or remove particles.\n");
+            sim->t = t_end;
+            return;
+        }
+        const double drift = interpolate ? t_end - next : 0.;
+        for (int i=0; i<N; i++){ // carry the operator's changes over to the end of the step, drifting velocity changes to first order
+            const struct reb_particle* const p = &sim->particles[i];
+            const double dvx = p->vx - grid[i].vx;
+            const double dvy = p->vy - grid[i].vy;
+            const double dvz = p->vz - grid[i].vz;
+            end[i].x += p->x - grid[i].x + dvx*drift;
+            end[i].y += p->y - grid[i].y + dvy*drift;
+            end[i].z += p->z - grid[i].z + dvz*drift;
+            end[i].vx += dvx;
+            end[i].vy += dvy;
+            end[i].vz += dvz;
+        }
+        next += interval;
+    }
+    sim->t = t_end;
+    rebx_copy_kinematics(sim->particles, end, N);
+    double* const next_time_ptr = rebx_get_param(rebx, operator->ap, "operator_next_time");
+    if (next_time_ptr != NULL){
+        *next_time_ptr = next; // bookkeeping, so write in place
+    }
+    else{
+        rebx_set_param_double(rebx, &operator->ap, "operator_next_time", next);
+    }
+}
+
 void rebx_post_timestep_modifications(struct reb_simulation* sim){
     struct rebx_extras* rebx = sim->extras;
     struct rebx_node* current = rebx->post_timestep_modifications;
@@ -948,10 +1133,20 @@ void rebx_post_timestep_modifications(struct reb_simulation* sim){
     while(current != NULL){
         struct rebx_step* step = current->object;
         struct rebx_operator* operator = step->operator;
+        const double* const interval = rebx_get_param(rebx, operator->ap, "operator_interval");
+        if (interval != NULL && *interval > 0.){
+            rebx_apply_operator_on_grid(sim, operator, *interval);
+            current = current->next;
+            continue;
+        }
         if(sim->integrator==REB_INTEGRATOR_IAS15 && sim->ri_ias15.epsilon != 0 && operator->operator_type == REBX_OPERATOR_UPDATER){
-            reb_warning(sim, "REBOUNDx: Operators that affect particle trajectories with adaptive timesteps can give spurious results. Use sim.ri_ias15.epsilon=0 for fixed timestep with IAS, or use a different integrator.");
+            reb_warning(sim, "REBOUNDx: Operators that affect particle trajectories with adaptive timesteps can give spurious results. Use sim.ri_ias15.epsilon=0 for fixed timestep with IAS, add the operator on a fixed time grid with rebx_add_operator_interval, or use a different integrator.");
         }
+        const double trace_begin = (rebx->trace != NULL) ? rebx_trace_begin() : 0.;
         operator->step_function(sim, operator, dt*step->dt_fraction);
+        if (rebx->trace != NULL){
+            rebx_trace_end(rebx, trace_begin, operator->name, REBX_TRACE_POST_TIMESTEP, -1);
+        }
         current = current->next;
     }
 }
@@ -1001,6 +1196,11 @@ int rebx_add_param(struct rebx_extras* const rebx, struct rebx_node** apptr, str
 
 // needed from Python
 enum rebx_param_type rebx_get_type(struct rebx_extras* rebx, const char* name){
+    const struct rebx_registry_param* const builtin = rebx_registry_get_param(name);
+    if (builtin != NULL){
+        return builtin->type;
+    }
+    // User-registered params are kept in a (small) linked list on top of the built-in table
     struct rebx_param* param = rebx_get_param_struct(rebx, rebx->registered_params, name);
     
     if (param == NULL){ // param not found
@@ -1024,6 +1224,10 @@ size_t rebx_sizeof(struct rebx_extras* rebx, enum rebx_param_type type){
         {
             return sizeof(struct rebx_force);
         }
+        case REBX_TYPE_UINT32:
+        {
+            return sizeof(uint32_t);
+        }
         /*case REBX_TYPE_ORBIT:
         {
             return sizeof(struct reb_orbit);
@@ -43,8 +43,9 @@ struct rebx_node;
  ****************************/
 
 void rebx_initialize(struct reb_simulation* sim, struct rebx_extras* rebx); // Initializes all pointers and values.
-void rebx_register_default_params(struct rebx_extras* rebx); // Registers default params
+void rebx_register_default_params(struct rebx_extras* rebx); // Kept for compatibility. Built-in params live in the static table in registry.c
 void rebx_init_interpolator(struct rebx_extras* const rebx, struct rebx_interpolator* const interp, const int Nvalues, const double* times, const double* values, enum rebx_interpolation_type interpolation);
+void rebx_init_interpolator_from_table(struct rebx_interpolator* const interp, struct rebx_interpolator_table* const table);
 
 /**********************************************
  Functions executing forces & ptm each timestep
@@ -84,6 +85,10 @@ void rebx_modify_mass(struct reb_simulation* const sim, struct rebx_operator* co
 void rebx_integrate_force(struct reb_simulation* const sim, struct rebx_operator* const operator, const double dt);
 void rebx_modify_orbits_direct(struct reb_simulation* const sim, struct rebx_operator* const operator, const double dt);
 void rebx_track_min_distance(struct reb_simulation* const sim, struct rebx_operator* const operator, const double dt);
+void rebx_energy_monitor(struct reb_simulation* const sim, struct rebx_operator* const operator, const double dt);
+void rebx_timestep_control(struct reb_simulation* const sim, struct rebx_operator* const operator, const double dt);
+void rebx_encounter_events(struct reb_simulation* const sim, struct rebx_operator* const operator, const double dt);
+void rebx_triggers(struct reb_simulation* const sim, struct rebx_operator* const operator, const double dt);
 
 /****************************************
  Integrator prototypes
@@ -95,10 +100,33 @@ void rebx_integrator_rk4_integrate(struct reb_simulation* const sim, const doubl
 void rebx_integrator_implicit_midpoint_integrate(struct reb_simulation* const sim, const double dt, struct rebx_force* const force);
 
 void* rebx_malloc(struct rebx_extras* const rebx, size_t memsize);
+/* Distances of all particles from one source particle, shared by the potentials of different effects while rebx_energy
+ * evaluates them (like gravity_acc for forces). Outside rebx_energy, rebx_get_source_geometry returns NULL and effects compute their own. */
+struct rebx_source_geometry{
+    int active;                 // 1 while rebx_energy is evaluating potentials
+    int source;                 // index of the particle distances are measured from, or -1 if not computed yet
+    int N;                      // number of particles arrays are allocated for
+    double* r2;                 // squared distance of each particle from source
+    double* dz;                 // z offset of each particle from source
+};
+const struct rebx_source_geometry* rebx_get_source_geometry(struct rebx_extras* const rebx, const int source_index);
+
+/* Timeline tracing (trace.c). Callers check rebx->trace != NULL first, so tracing costs one branch when off. */
+enum rebx_trace_category {
+    REBX_TRACE_FORCE,
+    REBX_TRACE_PRE_TIMESTEP,
+    REBX_TRACE_POST_TIMESTEP,
+};
+double rebx_trace_begin(void);
+void rebx_trace_end(struct rebx_extras* const rebx, const double begin, const char* const name, const enum rebx_trace_category category, const int evaluation);
+int rebx_trace_next_evaluation(struct rebx_extras* const rebx); // Index of this force evaluation within the current timestep (not an IAS15 substep index)
+void rebx_trace_free(struct rebx_extras* const rebx);
+void* rebx_malloc_large(struct rebx_extras* const rebx, size_t memsize); // Like rebx_malloc, but huge-page aligned above REBX_LARGE_ALLOC_THRESHOLD (hinted for huge pages with -DREBX_HUGEPAGES). Alignment only: not zeroed or first-touched. Free with free().
+void* rebx_get_workspace(struct rebx_extras* const rebx, const size_t memsize); // Returns scratch memory of at least memsize bytes owned by rebx. Contents not preserved across calls.
 void rebx_free_ap(struct rebx_node** ap);
 void rebx_free_particle_ap(struct reb_particle* p);
 void rebx_free_force(struct rebx_extras* rebx, struct rebx_force* force);
-void rebx_free_operator(struct rebx_operator* operator);
+void rebx_free_operator(struct rebx_extras* rebx, struct rebx_operator* operator);
 void rebx_free_step(struct rebx_step* step);
 void rebx_free_pointers(struct rebx_extras* rebx);
 void rebx_free_param(struct rebx_param* param);
@@ -110,4 +138,74 @@ struct rebx_param* rebx_create_param(struct rebx_extras* rebx, const char* name,
 int rebx_add_param(struct rebx_extras* const rebx, struct rebx_node** apptr, struct rebx_param* param);
 struct rebx_node* rebx_create_node(struct rebx_extras* rebx);
 
+/****************************************
+ Built-in registry (registry.c)
+ *****************************************/
+
+// Entries of the static tables generated from registry.h
+struct rebx_registry_param {
+    const char* name;
+    enum rebx_param_type type;
+};
+
+struct rebx_registry_force {
+    const char* name;
+    void (*update_accelerations) (struct reb_simulation* const sim, struct rebx_force* const force, struct reb_particle* const particles, const int N);
+    enum rebx_force_type force_type;
+};
+
+struct rebx_registry_operator {
+    const char* name;
+    void (*step_function) (struct reb_simulation* sim, struct rebx_operator* operator, const double dt);
+    enum rebx_operator_type operator_type;
+};
+
+// Perfect hash lookups with a single string comparison. Return NULL if name is not built in.
+const struct rebx_registry_param* rebx_registry_get_param(const char* const name);
+const struct rebx_registry_force* rebx_registry_get_force(const char* const name);
+const struct rebx_registry_operator* rebx_registry_get_operator(const char* const name);
+int rebx_registry_N_params(void);                                       // Number of built-in params
+const struct rebx_registry_param* rebx_registry_param_at(const int i);  // i-th built-in param, for writing binaries
+int rebx_registry_check(void);                                          // Number of table entries whose name lookup fails (0 unless registry_hash.h is stale)
+
+/****************************************
+ Runtime CPU dispatch (cpu_dispatch.c)
+ *****************************************/
+
+// Instruction set variants hot kernels are compiled for. Ordered so that later ones are supersets.
+enum rebx_isa {
+    REBX_ISA_GENERIC = 0,
+    REBX_ISA_AVX2 = 1,      // AVX2 + FMA
+    REBX_ISA_AVX512 = 2,    // AVX-512F/DQ
+};
+
+enum rebx_isa rebx_get_isa(void);           // Best variant supported by the CPU, detected once with CPUID. Can be lowered (but not raised above what the CPU supports) with the REBX_ISA environment variable (generic, avx2 or avx512).
+const char* rebx_get_isa_name(void);        // Name of the variant in use (e.g. to check the override from Python)
+
+/* REBX_MULTIVERSION(name, params, args) defines static void name(params) that calls the variant of the kernel
+ * name##_body(args) compiled for the ISA returned by rebx_get_isa(). name##_body must be declared REBX_KERNEL (always
+ * inlined), so each variant is a separate compilation of the same source. On compilers/architectures without support this is
+ * just a direct call to the body. Results are identical across variants since we build with -ffp-contract=off (no fused multiply-adds,
+ * which clang would otherwise form in the fma variants even in ISO C mode) and the compiler does not reorder floating point reductions.
+ */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(REBX_NO_DISPATCH)
+#define REBX_DISPATCH 1
+#define REBX_KERNEL static inline __attribute__((always_inline))
+#define REBX_MULTIVERSION(name, params, args) \
+    static void name##_generic params { name##_body args; } \
+    __attribute__((target("avx2,fma"))) static void name##_avx2 params { name##_body args; } \
+    __attribute__((target("avx512f,avx512dq,avx2,fma"))) static void name##_avx512 params { name##_body args; } \
+    static void name params { \
+        switch (rebx_get_isa()){ \
+            case REBX_ISA_AVX512: name##_avx512 args; break; \
+            case REBX_ISA_AVX2: name##_avx2 args; break; \
+            default: name##_generic args; break; \
+        } \
+    }
+#else
+#define REBX_KERNEL static inline
+#define REBX_MULTIVERSION(name, params, args) \
+    static void name params { name##_body args; }
+#endif
+
 #endif
@@ -0,0 +1,80 @@
+/**
+ * @file    cpu_dispatch.c
+ * @brief   Runtime selection of the instruction set variant used by hot kernels
+ * @author  Dan Tamayo <tamayo.daniel@gmail.com>
+ * 
+ * @section     LICENSE
+ * Copyright (c) 2015 Dan Tamayo, Hanno Rein
+ *
+ * This file is part of reboundx.
+ *
+ * reboundx is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * reboundx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with rebound.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "core.h"
+
+static int rebx_isa = -1; // not yet detected
+
+static enum rebx_isa rebx_detect_isa(void){
+    enum rebx_isa isa = REBX_ISA_GENERIC;
+#ifdef REBX_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")){
+        isa = REBX_ISA_AVX2;
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")){
+            isa = REBX_ISA_AVX512;
+        }
+    }
+#endif
+    // The environment can only lower the variant. Requests above what the CPU supports are ignored, since running e.g. avx512 code
+    // on a CPU without it would crash with an illegal instruction. To test a variant, run on a CPU that supports it.
+    const char* const env = getenv("REBX_ISA");
+    if (env != NULL){
+        enum rebx_isa requested = isa;
+        if (strcmp(env, "generic") == 0){
+            requested = REBX_ISA_GENERIC;
+        }
+        else if (strcmp(env, "avx2") == 0){
+            requested = REBX_ISA_AVX2;
+        }
+        else if (strcmp(env, "avx512") == 0){
+            requested = REBX_ISA_AVX512;
+        }
+        if (requested < isa){
+            isa = requested;
+        }
+    }
+    return isa;
+}
+
+enum rebx_isa rebx_get_isa(void){
+    if (rebx_isa < 0){ // all threads detect the same value, so a race here is harmless
+        rebx_isa = rebx_detect_isa();
+    }
+    return rebx_isa;
+}
+
+const char* rebx_get_isa_name(void){
+    switch (rebx_get_isa()){
+        case REBX_ISA_AVX512:
+            return "avx512";
+        case REBX_ISA_AVX2:
+            return "avx2";
+        default:
+            return "generic";
+    }
+}
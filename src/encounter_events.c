@@ -0,0 +1,340 @@
+/**
+ * @file    encounter_events.c
+ * @brief   Record every close encounter between pairs of tracked particles in a ring buffer of events.
+ * @author  Dan Tamayo <tamayo.daniel@gmail.com>
+ *
+ * @section     LICENSE
+ * Copyright (c) 2015 Dan Tamayo, Hanno Rein
+ *
+ * This file is part of reboundx.
+ *
+ * reboundx is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * reboundx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with rebound.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$
+ *
+ * $Miscellaneous Utilities$     // Effect category (must be the first non-blank line after dollar signs and between dollar signs to be detected by script).
+ *
+ * ======================= ===============================================
+ * Authors                 D. Tamayo
+ * Implementation Paper    None
+ * Based on                None
+ * C Example               None
+ * Python Example          None
+ * ======================= ===============================================
+ *
+ * Unlike track_min_distance, which keeps a single running minimum per particle against one target, this operator records
+ * every encounter closer than ee_distance between any pair of tracked particles. Candidate pairs are found with a uniform
+ * spatial hash with cells of size ee_distance + ee_skin, so the cost per call scales with the number of tracked particles rather than its square.
+ *
+ * Each call, the relative motion of a candidate pair is extrapolated linearly to its closest approach. If that closest approach
+ * falls within the last timestep and is closer than ee_distance, one event is stored with the time and distance of closest approach,
+ * the hashes of both particles and their relative speed. Each encounter is therefore reported once, in the step in which the pair
+ * stops approaching. Only pairs within ee_distance + ee_skin of each other at the time of the call are considered, so if particles
+ * can cross ee_distance within a timestep, set ee_skin to roughly the largest relative speed times the timestep.
+ * Particles should be assigned hashes (e.g., through names in Python) so events can be identified.
+ *
+ * Events are stored in a ring buffer with room for ee_capacity events. If it fills up before being drained with rebx_encounter_events_drain,
+ * the oldest events are overwritten and counted in ee_Ndropped.
+ *
+ * **Effect Parameters**
+ *
+ * ============================ =========== ==================================================================
+ * Field (C type)               Required    Description
+ * ============================ =========== ==================================================================
+ * ee_distance (double)         Yes         Encounters closer than this distance are recorded.
+ * ee_skin (double)             No          Additional search distance for candidate pairs (default 0).
+ * ee_capacity (int)            No          Number of events the ring buffer holds (default 1024). Read when the buffer is first allocated.
+ * ee_Nevents (int)             No          Number of events recorded so far (set by the operator).
+ * ee_Ndropped (int)            No          Number of events overwritten before being drained (set by the operator).
+ * ============================ =========== ==================================================================
+ *
+ * **Particle Parameters**
+ *
+ * If no particle has ee_track set, all particles are tracked.
+ *
+ * ============================ =========== ==================================================================
+ * Field (C type)               Required    Description
+ * ============================ =========== ==================================================================
+ * ee_track (int)               No          Set to a nonzero value to only track this (and other flagged) particles.
+ * ============================ =========== ==================================================================
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "rebound.h"
+#include "reboundx.h"
+#include "core.h"
+
+#define REBX_EE_DEFAULT_CAPACITY 1024
+#define REBX_EE_MAX_CELL 1099511627776.   // 2^40. Clamp cell indices of distant particles to stay within int64_t
+
+struct rebx_ee_buffer {
+    int capacity;
+    int start;                              // Index of the oldest event
+    int N;                                  // Number of events currently stored
+    struct rebx_encounter_event* events;
+};
+
+void rebx_encounter_events_free_arrays(struct rebx_extras* rebx, struct rebx_operator* operator){
+    struct rebx_ee_buffer* const buffer = rebx_get_param(rebx, operator->ap, "ee_buffer");
+    if (buffer != NULL){
+        free(buffer->events);
+        free(buffer);
+        rebx_set_param_pointer(rebx, &operator->ap, "ee_buffer", NULL);
+    }
+}
+
+static struct rebx_ee_buffer* rebx_ee_get_buffer(struct rebx_extras* const rebx, struct rebx_operator* const operator){
+    struct rebx_ee_buffer* buffer = rebx_get_param(rebx, operator->ap, "ee_buffer");
+    if (buffer != NULL){
+        return buffer;
+    }
+    const int* const capacity = rebx_get_param(rebx, operator->ap, "ee_capacity");
+    buffer = rebx_malloc(rebx, sizeof(*buffer));
+    if (buffer == NULL){
+        return NULL;
+    }
+    buffer->capacity = (capacity != NULL && *capacity > 0) ? *capacity : REBX_EE_DEFAULT_CAPACITY;
+    buffer->start = 0;
+    buffer->N = 0;
+    buffer->events = rebx_malloc(rebx, buffer->capacity*sizeof(*buffer->events));
+    if (buffer->events == NULL){
+        free(buffer);
+        return NULL;
+    }
+    rebx_set_param_pointer(rebx, &operator->ap, "ee_buffer", buffer);
+    rebx_set_param_pointer(rebx, &operator->ap, "free_arrays", rebx_encounter_events_free_arrays);
+    return buffer;
+}
+
+// Counters are written in place, so recording an event costs a single lookup
+static void rebx_ee_increment(struct rebx_extras* const rebx, struct rebx_operator* const operator, const char* const name){
+    int* const counter = rebx_get_param(rebx, operator->ap, name);
+    if (counter == NULL){
+        rebx_set_param_int(rebx, &operator->ap, name, 1);
+    }
+    else{
+        (*counter)++;
+    }
+}
+
+static void rebx_ee_push(struct rebx_extras* const rebx, struct rebx_operator* const operator, struct rebx_ee_buffer* const buffer, const struct rebx_encounter_event event){
+    if (buffer->N == buffer->capacity){
+        buffer->start = (buffer->start + 1) % buffer->capacity;
+        buffer->N--;
+        rebx_ee_increment(rebx, operator, "ee_Ndropped");
+    }
+    buffer->events[(buffer->start + buffer->N) % buffer->capacity] = event;
+    buffer->N++;
+    rebx_ee_increment(rebx, operator, "ee_Nevents");
+}
+
+static int64_t rebx_ee_cell(const double x, const double h){
+    const double c = floor(x/h);
+    if (c > REBX_EE_MAX_CELL){
+        return (int64_t)REBX_EE_MAX_CELL;
+    }
+    if (c < -REBX_EE_MAX_CELL){
+        return -(int64_t)REBX_EE_MAX_CELL;
+    }
+    return (int64_t)c;
+}
+
+static uint32_t rebx_ee_bucket(const int64_t ix, const int64_t iy, const int64_t iz, const uint32_t mask){
+    uint64_t h = (uint64_t)ix*0x9E3779B97F4A7C15ULL;
+    h ^= (uint64_t)iy*0xC2B2AE3D27D4EB4FULL;
+    h ^= (uint64_t)iz*0x165667B19E3779F9ULL;
+    h ^= h >> 29;
+    return (uint32_t)h & mask;
+}
+
+// Checks whether the pair (i, j) passed its closest approach within the last step, and records it if closer than d.
+static void rebx_ee_check_pair(struct rebx_extras* const rebx, struct rebx_operator* const operator, struct rebx_ee_buffer* const buffer, const struct reb_particle* const pi, const struct reb_particle* const pj, const double t, const double dt, const double d, const double h2){
+    const double dx = pj->x - pi->x;
+    const double dy = pj->y - pi->y;
+    const double dz = pj->z - pi->z;
+    const double r2 = dx*dx + dy*dy + dz*dz;
+    if (r2 >= h2){
+        return;
+    }
+    const double dvx = pj->vx - pi->vx;
+    const double dvy = pj->vy - pi->vy;
+    const double dvz = pj->vz - pi->vz;
+    const double v2 = dvx*dvx + dvy*dvy + dvz*dvz;
+    if (v2 == 0.){
+        return; // co-moving pair never reaches a closest approach
+    }
+    const double rv = dx*dvx + dy*dvy + dz*dvz;
+    const double tca = -rv/v2; // time of closest approach relative to t
+    if (dt > 0. ? (tca <= -dt || tca > 0.) : (tca >= -dt || tca < 0.)){
+        return;
+    }
+    const double r2ca = r2 + 2.*rv*tca + v2*tca*tca;
+    if (r2ca >= d*d){
+        return;
+    }
+    const struct rebx_encounter_event event = {
+        .t = t + tca,
+        .hash1 = pi->hash,
+        .hash2 = pj->hash,
+        .distance = sqrt(r2ca > 0. ? r2ca : 0.),
+        .v_rel = sqrt(v2),
+    };
+    rebx_ee_push(rebx, operator, buffer, event);
+}
+
+void rebx_encounter_events(struct reb_simulation* const sim, struct rebx_operator* const operator, const double dt){
+    struct rebx_extras* const rebx = sim->extras;
+    const double* const distance = rebx_get_param(rebx, operator->ap, "ee_distance");
+    if (distance == NULL || *distance <= 0.){
+        reb_error(sim, "REBOUNDx Error: Need to set a positive ee_distance parameter for the encounter_events operator.\n");
+        return;
+    }
+    const double* const skin = rebx_get_param(rebx, operator->ap, "ee_skin");
+    const double d = *distance;
+    const double h = d + ((skin != NULL && *skin > 0.) ? *skin : 0.); // cell size and search radius
+    struct rebx_ee_buffer* const buffer = rebx_ee_get_buffer(rebx, operator);
+    if (buffer == NULL){
+        return;
+    }
+
+    struct reb_particle* const ps = sim->particles;
+    const int N = sim->N - sim->N_var;
+    if (N < 2){
+        return;
+    }
+    uint32_t M = 1;
+    while (M < 2*(uint32_t)N){
+        M <<= 1;
+    }
+    // Scratch layout: tracked indices, cell coordinates, bucket of each tracked particle, bucket offsets and particles sorted by bucket
+    const size_t size_cells = 3*N*sizeof(int64_t);
+    const size_t size_ints = (3*(size_t)N + M + 1)*sizeof(uint32_t);
+    int64_t* const cells = rebx_get_workspace(rebx, size_cells + size_ints);
+    if (cells == NULL){
+        return;
+    }
+    uint32_t* const tracked = (uint32_t*)(cells + 3*N);
+    uint32_t* const bucket = tracked + N;
+    uint32_t* const sorted = bucket + N;
+    uint32_t* const offsets = sorted + N;
+
+    int Nt = 0;
+    for (int i=0; i<N; i++){
+        const int* const track = rebx_get_param(rebx, ps[i].ap, "ee_track");
+        if (track != NULL && *track){
+            tracked[Nt++] = i;
+        }
+    }
+    if (Nt == 0){
+        for (int i=0; i<N; i++){
+            tracked[i] = i;
+        }
+        Nt = N;
+    }
+    const uint32_t mask = M-1;
+    memset(offsets, 0, (M+1)*sizeof(uint32_t));
+    for (int k=0; k<Nt; k++){
+        const struct reb_particle* const p = &ps[tracked[k]];
+        cells[3*k] = rebx_ee_cell(p->x, h);
+        cells[3*k+1] = rebx_ee_cell(p->y, h);
+        cells[3*k+2] = rebx_ee_cell(p->z, h);
+        bucket[k] = rebx_ee_bucket(cells[3*k], cells[3*k+1], cells[3*k+2], mask);
+        offsets[bucket[k]+1]++;
+    }
+    for (uint32_t b=0; b<M; b++){
+        offsets[b+1] += offsets[b];
+    }
+    // Counting sort by bucket. Each bucket[k] is replaced by k's position in sorted[], which advances offsets[] by one bucket; shift them back after.
+    for (int k=0; k<Nt; k++){
+        bucket[k] = offsets[bucket[k]]++;
+        sorted[bucket[k]] = k;
+    }
+    for (uint32_t b=M; b>0; b--){
+        offsets[b] = offsets[b-1];
+    }
+    offsets[0] = 0;
+
+    for (int k=0; k<Nt; k++){
+        const struct reb_particle* const pk = &ps[tracked[k]];
+        uint32_t visited[27];
+        int Nvisited = 0;
+        for (int ox=-1; ox<=1; ox++){
+        for (int oy=-1; oy<=1; oy++){
+        for (int oz=-1; oz<=1; oz++){
+            const uint32_t b = rebx_ee_bucket(cells[3*k]+ox, cells[3*k+1]+oy, cells[3*k+2]+oz, mask);
+            int seen = 0;
+            for (int v=0; v<Nvisited; v++){ // neighbouring cells can hash to the same bucket
+                if (visited[v] == b){
+                    seen = 1;
+                    break;
+                }
+            }
+            if (seen){
+                continue;
+            }
+            visited[Nvisited++] = b;
+            for (uint32_t s=offsets[b]; s<offsets[b+1]; s++){
+                const uint32_t l = sorted[s];
+                if (l <= (uint32_t)k){
+                    continue;
+                }
+                if (llabs(cells[3*l]-cells[3*k]) > 1 || llabs(cells[3*l+1]-cells[3*k+1]) > 1 || llabs(cells[3*l+2]-cells[3*k+2]) > 1){
+                    continue; // hash collision with a distant cell
+                }
+                rebx_ee_check_pair(rebx, operator, buffer, pk, &ps[tracked[l]], sim->t, dt, d, h*h);
+            }
+        }
+        }
+        }
+    }
+}
+
+int rebx_encounter_events_N(struct rebx_extras* const rebx, struct rebx_operator* const operator){
+    const struct rebx_ee_buffer* const buffer = rebx_get_param(rebx, operator->ap, "ee_buffer");
+    return buffer == NULL ? 0 : buffer->N;
+}
+
+int rebx_encounter_events_drain(struct rebx_extras* const rebx, struct rebx_operator* const operator, double* const t, uint32_t* const hash1, uint32_t* const hash2, double* const distance, double* const v_rel, const int Nmax){
+    struct rebx_ee_buffer* const buffer = rebx_get_param(rebx, operator->ap, "ee_buffer");
+    if (buffer == NULL){
+        return 0;
+    }
+    const int Ndrain = (Nmax < buffer->N) ? Nmax : buffer->N;
+    for (int n=0; n<Ndrain; n++){
+        const struct rebx_encounter_event* const event = &buffer->events[(buffer->start + n) % buffer->capacity];
+        if (t != NULL){
+            t[n] = event->t;
+        }
+        if (hash1 != NULL){
+            hash1[n] = event->hash1;
+        }
+        if (hash2 != NULL){
+            hash2[n] = event->hash2;
+        }
+        if (distance != NULL){
+            distance[n] = event->distance;
+        }
+        if (v_rel != NULL){
+            v_rel[n] = event->v_rel;
+        }
+    }
+    buffer->start = (buffer->start + Ndrain) % buffer->capacity;
+    buffer->N -= Ndrain;
+    return Ndrain;
+}
@@ -0,0 +1,232 @@
+/**
+ * @file    energy_monitor.c
+ * @brief   Track the relative error in the total energy, including conservative REBOUNDx effects, and log it to a binary file.
+ * @author  Dan Tamayo <tamayo.daniel@gmail.com>
+ *
+ * @section     LICENSE
+ * Copyright (c) 2015 Dan Tamayo, Hanno Rein
+ *
+ * This file is part of reboundx.
+ *
+ * reboundx is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * reboundx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with rebound.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$
+ *
+ * $Miscellaneous Utilities$     // Effect category (must be the first non-blank line after dollar signs and between dollar signs to be detected by script).
+ *
+ * ======================= ===============================================
+ * Authors                 D. Tamayo
+ * Implementation Paper    None
+ * Based on                None
+ * C Example               None
+ * Python Example          None
+ * ======================= ===============================================
+ *
+ * This operator records the relative error in the total energy of the simulation, without having to call back into Python.
+ * The total energy is the Newtonian energy plus the potentials of all conservative effects that have been added to the simulation
+ * (either directly as forces or through an integrate_force operator): gr, gr_full, gr_potential, tides_constant_time_lag (conservative piece),
+ * central_force and gravitational_harmonics. For gr and gr_full the effect's Hamiltonian (which already includes the Newtonian terms) replaces
+ * the Newtonian energy. Other (dissipative) effects are ignored.
+ *
+ * If an output file is set with rebx_energy_monitor_set_output, each record is appended to it as two doubles: the simulation time and
+ * the relative energy error (E-E0)/E0.
+ *
+ * While a record is taken, the distances of all particles from a source particle are computed once and shared by the potentials
+ * of all effects using that source (e.g., gr_potential, tides_constant_time_lag and gravitational_harmonics about the star).
+ *
+ * **Effect Parameters**
+ *
+ * ============================ =========== ==================================================================
+ * Field (C type)               Required    Description
+ * ============================ =========== ==================================================================
+ * emon_interval (double)       No          Simulation time between records. Default records every timestep.
+ * emon_E0 (double)             No          Reference energy. Set automatically the first time the operator is called.
+ * emon_dE (double)             No          Most recently recorded relative energy error (set by the operator).
+ * emon_Nrecords (int)          No          Number of records taken so far (set by the operator).
+ * ============================ =========== ==================================================================
+ *
+ * **Particle Parameters**
+ *
+ * *None*
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "rebound.h"
+#include "reboundx.h"
+#include "core.h"
+
+// Returns 1 if force was already added to the total (e.g., if it's integrated both pre and post timestep)
+static int rebx_em_force_counted(struct rebx_force** counted, const int Ncounted, const struct rebx_force* const force){
+    for (int i=0; i<Ncounted; i++){
+        if (counted[i] == force){
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static double rebx_em_force_energy(struct rebx_extras* const rebx, struct rebx_force* const force, int* const includes_newtonian){
+    if (force->update_accelerations == rebx_gr){
+        (*includes_newtonian)++;
+        return rebx_gr_hamiltonian(rebx, force);
+    }
+    if (force->update_accelerations == rebx_gr_full){
+        (*includes_newtonian)++;
+        return rebx_gr_full_hamiltonian(rebx, force);
+    }
+    if (force->update_accelerations == rebx_gr_potential){
+        return rebx_gr_potential_potential(rebx, force);
+    }
+    if (force->update_accelerations == rebx_tides_constant_time_lag){
+        return rebx_tides_constant_time_lag_potential(rebx);
+    }
+    if (force->update_accelerations == rebx_central_force){
+        return rebx_central_force_potential(rebx);
+    }
+    if (force->update_accelerations == rebx_gravitational_harmonics){
+        return rebx_gravitational_harmonics_potential(rebx);
+    }
+    return 0.; // non-conservative effect
+}
+
+static double rebx_em_add_forces(struct rebx_extras* const rebx, struct rebx_force* const force, struct rebx_force** counted, int* const Ncounted, int* const includes_newtonian){
+    if (force == NULL || rebx_em_force_counted(counted, *Ncounted, force)){
+        return 0.;
+    }
+    counted[(*Ncounted)++] = force;
+    return rebx_em_force_energy(rebx, force, includes_newtonian);
+}
+
+static int rebx_em_count_nodes(struct rebx_node* node){
+    int N = 0;
+    for (; node != NULL; node = node->next){
+        N++;
+    }
+    return N;
+}
+
+// Total energy. Sets double_counted if both gr and gr_full were added, so the Newtonian terms are counted twice
+static double rebx_em_energy(struct rebx_extras* const rebx, int* const double_counted){
+    struct reb_simulation* const sim = rebx->sim;
+    const int Nmax = rebx_em_count_nodes(rebx->additional_forces) + rebx_em_count_nodes(rebx->pre_timestep_modifications) + rebx_em_count_nodes(rebx->post_timestep_modifications);
+    struct rebx_force* counted[Nmax > 0 ? Nmax : 1];
+    int Ncounted = 0;
+    int includes_newtonian = 0;
+    double E = 0.;
+    if (rebx->geometry == NULL){
+        rebx->geometry = calloc(1, sizeof(*rebx->geometry)); // if this fails, effects just compute their own distances
+    }
+    if (rebx->geometry != NULL){
+        rebx->geometry->active = 1;
+        rebx->geometry->source = -1; // particles have moved since the last call
+    }
+
+    for (struct rebx_node* node = rebx->additional_forces; node != NULL; node = node->next){
+        E += rebx_em_add_forces(rebx, node->object, counted, &Ncounted, &includes_newtonian);
+    }
+    struct rebx_node* lists[2] = {rebx->pre_timestep_modifications, rebx->post_timestep_modifications};
+    for (int l=0; l<2; l++){
+        for (struct rebx_node* node = lists[l]; node != NULL; node = node->next){
+            const struct rebx_step* const step = node->object;
+            struct rebx_force* const force = rebx_get_param(rebx, step->operator->ap, "force");
+            E += rebx_em_add_forces(rebx, force, counted, &Ncounted, &includes_newtonian);
+        }
+    }
+    if (rebx->geometry != NULL){
+        rebx->geometry->active = 0;
+    }
+    *double_counted = (includes_newtonian > 1);
+    if (!includes_newtonian){
+        E += reb_tools_energy(sim);
+    }
+    return E;
+}
+
+double rebx_energy(struct rebx_extras* const rebx){
+    if (rebx->sim == NULL){
+        rebx_error(rebx, ""); // rebx_error gives meaningful err
+        return 0;
+    }
+    int double_counted;
+    const double E = rebx_em_energy(rebx, &double_counted);
+    if (double_counted){
+        reb_warning(rebx->sim, "REBOUNDx Warning: Both gr and gr_full were added. Energy from rebx_energy double counts the Newtonian terms.\n");
+    }
+    return E;
+}
+
+void rebx_energy_monitor_free_arrays(struct rebx_extras* rebx, struct rebx_operator* operator){
+    FILE* const f = rebx_get_param(rebx, operator->ap, "emon_file");
+    if (f != NULL){
+        fclose(f);
+        rebx_set_param_pointer(rebx, &operator->ap, "emon_file", NULL);
+    }
+}
+
+int rebx_energy_monitor_set_output(struct rebx_extras* const rebx, struct rebx_operator* const operator, const char* const filename){
+    rebx_energy_monitor_free_arrays(rebx, operator);
+    FILE* const f = fopen(filename, "ab");
+    if (f == NULL){
+        char str[300];
+        sprintf(str, "REBOUNDx Error: Could not open file '%.200s' for energy_monitor output.\n", filename);
+        rebx_error(rebx, str);
+        return 0;
+    }
+    rebx_set_param_pointer(rebx, &operator->ap, "emon_file", f);
+    rebx_set_param_pointer(rebx, &operator->ap, "free_arrays", rebx_energy_monitor_free_arrays);
+    return 1;
+}
+
+void rebx_energy_monitor(struct reb_simulation* const sim, struct rebx_operator* const operator, const double dt){
+    struct rebx_extras* const rebx = sim->extras;
+    double* const interval = rebx_get_param(rebx, operator->ap, "emon_interval");
+    double* const next_output = rebx_get_param(rebx, operator->ap, "emon_next_output");
+    if (interval != NULL && *interval > 0. && next_output != NULL){
+        if (sim->t < *next_output){
+            return;
+        }
+    }
+
+    int double_counted;
+    const double E = rebx_em_energy(rebx, &double_counted);
+    double* const E0 = rebx_get_param(rebx, operator->ap, "emon_E0");
+    if (double_counted && E0 == NULL){ // only warn on the first record rather than every record
+        reb_warning(sim, "REBOUNDx Warning: Both gr and gr_full were added. Energy from energy_monitor will double count the Newtonian terms.\n");
+    }
+    if (E0 == NULL){
+        rebx_set_param_double(rebx, &operator->ap, "emon_E0", E);
+    }
+    const double dE = (E0 == NULL || *E0 == 0.) ? 0. : (E - *E0)/(*E0);
+    rebx_set_param_double(rebx, &operator->ap, "emon_dE", dE);
+    int* const Nrecords = rebx_get_param(rebx, operator->ap, "emon_Nrecords");
+    rebx_set_param_int(rebx, &operator->ap, "emon_Nrecords", Nrecords == NULL ? 1 : *Nrecords + 1);
+
+    FILE* const f = rebx_get_param(rebx, operator->ap, "emon_file");
+    if (f != NULL){
+        const double record[2] = {sim->t, dE};
+        fwrite(record, sizeof(double), 2, f);
+    }
+
+    if (interval != NULL && *interval > 0.){
+        double next = (next_output == NULL) ? sim->t : *next_output;
+        while (next <= sim->t){
+            next += *interval;
+        }
+        rebx_set_param_double(rebx, &operator->ap, "emon_next_output", next);
+    }
+}
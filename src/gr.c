@@ -46,8 +46,20 @@
  * Field (C type)               Required    Description
  * ============================ =========== ==================================================================
  * c (double)                   Yes         Speed of light in the units used for the simulation.
+ * max_iterations (int)         No          Maximum fixed-point iterations for the velocity solve (default 10).
+ * gr_iterations (double)       No          Set (e.g. to 0) to turn on convergence statistics. Accumulates the iterations summed over bodies.
+ * gr_solves (double)           No          Number of body velocity solves (set by the effect when gr_iterations is set).
+ * gr_unconverged (double)      No          Number of solves that hit max_iterations (set by the effect when gr_iterations is set).
+ * gr_reuse_gravity (int)       No          Set to 1 to reuse REBOUND's Newtonian accelerations instead of recomputing all pairs (default 0).
  * ============================ =========== ==================================================================
  *
+ * The velocity fixed point is solved for all bodies together over contiguous arrays, so that bodies update in SIMD lanes,
+ * with bodies that have converged masked out. gr_iterations/gr_solves gives the mean number of iterations per body.
+ *
+ * With gr_reuse_gravity, the effect takes the accelerations REBOUND has just calculated and only adds back the pairs REBOUND skipped,
+ * rather than summing all N^2/2 pairs itself. This changes the summation order, so results are not bitwise identical to the default.
+ * It falls back to the full sum with softening, gravity other than basic or compensated, massive test particles (N_active),
+ * and when the force is not evaluated through REBOUND's additional_forces (e.g., through integrate_force).
  * 
  */
 
@@ -59,37 +71,104 @@
 #include <limits.h>
 #include "rebound.h"
 #include "reboundx.h"
+#include "core.h"
 #include "rebxtools.h"
 
-static void rebx_calculate_gr(struct reb_simulation* const sim, struct reb_particle* const particles, const int N, const double C2, const double G, const int max_iterations){
+// Newtonian accelerations from the ones REBOUND just calculated (saved in rebx_additional_forces), adding back any pairs REBOUND skipped.
+// Returns 0 if they're not available and we have to calculate them ourselves.
+static int rebx_gr_gravity_acc(struct reb_simulation* const sim, struct reb_particle* const ps, const int N, const double G){
+    const struct rebx_extras* const rebx = sim->extras;
+    if (!rebx->gravity_acc_valid || rebx->gravity_acc_N < N || sim->softening != 0.){
+        return 0;
+    }
+    if (sim->gravity != REB_GRAVITY_BASIC && sim->gravity != REB_GRAVITY_COMPENSATED){
+        return 0;
+    }
+    // REBOUND never includes forces between test particles, and with testparticle_type 0 also not those of test particles on active ones.
+    // We include all pairs, so we can only reuse REBOUND's accelerations if the test particles are massless.
+    if (sim->N_active != -1 && sim->N_active < N){
+        for (int i=sim->N_active; i<N; i++){
+            if (ps[i].m != 0.){
+                return 0;
+            }
+        }
+    }
+    int Nskip; // REBOUND skips pairs (0, j) for 0<j<=Nskip
+    switch (sim->gravity_ignore_terms){
+        case 0:
+            Nskip = 0;
+            break;
+        case 1:
+            Nskip = N > 1 ? 1 : 0; // WHFast in Jacobi coordinates
+            break;
+        case 2:
+            Nskip = N-1; // Interactions with the central body
+            break;
+        default:
+            return 0;
+    }
+    for (int i=0; i<N; i++){
+        ps[i].ax = rebx->gravity_acc[i].x;
+        ps[i].ay = rebx->gravity_acc[i].y;
+        ps[i].az = rebx->gravity_acc[i].z;
+    }
+    const struct reb_particle p0 = ps[0];
+    for (int j=1; j<=Nskip; j++){
+        const struct reb_particle pj = ps[j];
+        const double dx = p0.x - pj.x;
+        const double dy = p0.y - pj.y;
+        const double dz = p0.z - pj.z;
+        const double r2 = dx*dx + dy*dy + dz*dz;
+        const double r = sqrt(r2);
+        const double prefac = G/(r2*r);
+        ps[0].ax -= prefac*pj.m*dx;
+        ps[0].ay -= prefac*pj.m*dy;
+        ps[0].az -= prefac*pj.m*dz;
+        ps[j].ax += prefac*p0.m*dx;
+        ps[j].ay += prefac*p0.m*dy;
+        ps[j].az += prefac*p0.m*dz;
+    }
+    return 1;
+}
+
+static void rebx_calculate_gr(struct reb_simulation* const sim, struct reb_particle* const particles, const int N, const double C2, const double G, const int max_iterations, const int default_max_iterations, const int reuse_gravity, double* const stats){
     
-    struct reb_particle* const ps = malloc(N*sizeof(*ps));
-    struct reb_particle* const ps_j = malloc(N*sizeof(*ps_j));
+    // One workspace for the inertial and Jacobi particles, 11 doubles and an iteration count per body for the velocity solve
+    const size_t size_particles = 2*N*sizeof(struct reb_particle);
+    struct reb_particle* const ps = rebx_get_workspace(sim->extras, size_particles + (N-1)*(11*sizeof(double) + sizeof(int)));
+    if (ps == NULL){
+        return;
+    }
+    struct reb_particle* const ps_j = ps + N;
+    double* const soa = (double*)(ps + 2*N);
+    int* const iterations = (int*)(soa + 11*(N-1));
     memcpy(ps, particles, N*sizeof(*ps));
     
-    // Calculate Newtonian accelerations 
-    for(int i=0; i<N; i++){
-        ps[i].ax = 0.;
-        ps[i].ay = 0.;
-        ps[i].az = 0.;
-    }
+    // Calculate Newtonian accelerations if we can't (or weren't asked to) reuse REBOUND's
+    if (!reuse_gravity || !rebx_gr_gravity_acc(sim, ps, N, G)){
+        for(int i=0; i<N; i++){
+            ps[i].ax = 0.;
+            ps[i].ay = 0.;
+            ps[i].az = 0.;
+        }
 
-    for(int i=0; i<N; i++){
-        const struct reb_particle pi = ps[i];
-        for(int j=i+1; j<N; j++){
-            const struct reb_particle pj = ps[j];
-            const double dx = pi.x - pj.x;
-            const double dy = pi.y - pj.y;
-            const double dz = pi.z - pj.z;
-            const double r2 = dx*dx + dy*dy + dz*dz;
-            const double r = sqrt(r2);
-            const double prefac = G/(r2*r);
-            ps[i].ax -= prefac*pj.m*dx;
-            ps[i].ay -= prefac*pj.m*dy;
-            ps[i].az -= prefac*pj.m*dz;
-            ps[j].ax += prefac*pi.m*dx;
-            ps[j].ay += prefac*pi.m*dy;
-            ps[j].az += prefac*pi.m*dz;
+        for(int i=0; i<N; i++){
+            const struct reb_particle pi = ps[i];
+            for(int j=i+1; j<N; j++){
+                const struct reb_particle pj = ps[j];
+                const double dx = pi.x - pj.x;
+                const double dy = pi.y - pj.y;
+                const double dz = pi.z - pj.z;
+                const double r2 = dx*dx + dy*dy + dz*dz;
+                const double r = sqrt(r2);
+                const double prefac = G/(r2*r);
+                ps[i].ax -= prefac*pj.m*dx;
+                ps[i].ay -= prefac*pj.m*dy;
+                ps[i].az -= prefac*pj.m*dz;
+                ps[j].ax += prefac*pi.m*dx;
+                ps[j].ay += prefac*pi.m*dy;
+                ps[j].az += prefac*pi.m*dz;
+            }
         }
     }
    
@@ -98,52 +177,93 @@ static void rebx_calculate_gr(struct reb_simulation* const sim, struct reb_parti
 	const double mu = G*source.m;
     reb_transformations_inertial_to_jacobi_posvelacc(ps, ps_j, ps, N, N);
     
-    for (int i=1; i<N; i++){
-        struct reb_particle p = ps_j[i];
-        struct reb_vec3d vi;
-        vi.x = p.vx;
-        vi.y = p.vy;
-        vi.z = p.vz;
-        double vi2=vi.x*vi.x + vi.y*vi.y + vi.z*vi.z;
-        const double ri = sqrt(p.x*p.x + p.y*p.y + p.z*p.z);
-        int q = 0;
-        double A = (0.5*vi2 + 3.*mu/ri)/C2;
-        struct reb_vec3d old_v;
-        for(q=0; q<max_iterations; q++){
-            old_v.x = vi.x;
-            old_v.y = vi.y;
-            old_v.z = vi.z;
-            vi.x = p.vx/(1.-A);
-            vi.y = p.vy/(1.-A);
-            vi.z = p.vz/(1.-A);
-            vi2 =vi.x*vi.x + vi.y*vi.y + vi.z*vi.z;
-            A = (0.5*vi2 + 3.*mu/ri)/C2;
-            const double dvx = vi.x - old_v.x;
-            const double dvy = vi.y - old_v.y;
-            const double dvz = vi.z - old_v.z;
-            if ((dvx*dvx + dvy*dvy + dvz*dvz)/vi2 < DBL_EPSILON*DBL_EPSILON){
-                break;
-            }
+    // Solve the fixed point vtilde = v/(1-A), A = (vtilde^2/2 + 3mu/r)/c^2, for all bodies together over SoA arrays so they update in SIMD lanes.
+    // Bodies that have converged are masked out. The arithmetic per body is the same as iterating one body at a time.
+    const int Nb = N-1;
+    double* const v = soa;              // Jacobi velocities
+    double* const vi = soa + 3*Nb;      // vtilde
+    double* const vi2 = soa + 6*Nb;     // |vtilde|^2
+    double* const ri = soa + 7*Nb;
+    double* const vscale = soa + 8*Nb;  // 3mu/r
+    double* const A = soa + 9*Nb;
+    double* const conv = soa + 10*Nb;   // 1 once converged (double so the mask vectorizes with the rest)
+
+#pragma omp simd
+    for (int k=0; k<Nb; k++){
+        const struct reb_particle p = ps_j[k+1];
+        v[k] = p.vx;
+        v[Nb+k] = p.vy;
+        v[2*Nb+k] = p.vz;
+        vi[k] = p.vx;
+        vi[Nb+k] = p.vy;
+        vi[2*Nb+k] = p.vz;
+        vi2[k] = p.vx*p.vx + p.vy*p.vy + p.vz*p.vz;
+        ri[k] = sqrt(p.x*p.x + p.y*p.y + p.z*p.z);
+        vscale[k] = 3.*mu/ri[k];
+        A[k] = (0.5*vi2[k] + vscale[k])/C2;
+        conv[k] = 0.;
+        iterations[k] = 0;
+    }
+
+    int Nactive = Nb;
+    for (int q=0; q<max_iterations && Nactive > 0; q++){
+        Nactive = 0;
+#pragma omp simd reduction(+:Nactive)
+        for (int k=0; k<Nb; k++){
+            const double vix = v[k]/(1.-A[k]);
+            const double viy = v[Nb+k]/(1.-A[k]);
+            const double viz = v[2*Nb+k]/(1.-A[k]);
+            const double vi2new = vix*vix + viy*viy + viz*viz;
+            const double Anew = (0.5*vi2new + vscale[k])/C2;
+            const double dvx = vix - vi[k];
+            const double dvy = viy - vi[Nb+k];
+            const double dvz = viz - vi[2*Nb+k];
+            const int converged = ((dvx*dvx + dvy*dvy + dvz*dvz)/vi2new < DBL_EPSILON*DBL_EPSILON);
+            const int active = (conv[k] == 0.);
+            vi[k] = active ? vix : vi[k];
+            vi[Nb+k] = active ? viy : vi[Nb+k];
+            vi[2*Nb+k] = active ? viz : vi[2*Nb+k];
+            vi2[k] = active ? vi2new : vi2[k];
+            A[k] = active ? Anew : A[k];
+            iterations[k] += active;
+            conv[k] = (active && !converged) ? 0. : 1.;
+            Nactive += (conv[k] == 0.);
         }
-        const int default_max_iterations = 10;
-        if(q==default_max_iterations){
-            reb_warning(sim, "REBOUNDx Warning: 10 iterations in gr.c failed to converge. This is typically because the perturbation is too strong for the current implementation.");
+    }
+    // Only warn at the default number of iterations. Users lowering max_iterations accept unconverged solves.
+    if (Nactive > 0 && max_iterations == default_max_iterations){
+        reb_warning(sim, "REBOUNDx Warning: 10 iterations in gr.c failed to converge. This is typically because the perturbation is too strong for the current implementation.");
+    }
+    if (stats != NULL){
+        long total = 0;
+        for (int k=0; k<Nb; k++){
+            total += iterations[k];
         }
-  
-        const double B = (mu/ri - 1.5*vi2)*mu/(ri*ri*ri)/C2;
+        stats[0] += total;
+        stats[1] += Nb;
+        stats[2] += Nactive;
+    }
+
+#pragma omp simd
+    for (int k=0; k<Nb; k++){
+        const struct reb_particle p = ps_j[k+1];
+        const double r = ri[k];
+        const double vix = vi[k];
+        const double viy = vi[Nb+k];
+        const double viz = vi[2*Nb+k];
+        const double B = (mu/r - 1.5*vi2[k])*mu/(r*r*r)/C2;
         const double rdotrdot = p.x*p.vx + p.y*p.vy + p.z*p.vz;
         
-        struct reb_vec3d vidot;
-        vidot.x = p.ax + B*p.x;
-        vidot.y = p.ay + B*p.y;
-        vidot.z = p.az + B*p.z;
+        const double vidotx = p.ax + B*p.x;
+        const double vidoty = p.ay + B*p.y;
+        const double vidotz = p.az + B*p.z;
         
-        const double vdotvdot = vi.x*vidot.x + vi.y*vidot.y + vi.z*vidot.z;
-        const double D = (vdotvdot - 3.*mu/(ri*ri*ri)*rdotrdot)/C2;
+        const double vdotvdot = vix*vidotx + viy*vidoty + viz*vidotz;
+        const double D = (vdotvdot - 3.*mu/(r*r*r)*rdotrdot)/C2;
         
-        ps_j[i].ax = B*(1.-A)*p.x - A*p.ax - D*vi.x;
-        ps_j[i].ay = B*(1.-A)*p.y - A*p.ay - D*vi.y;
-        ps_j[i].az = B*(1.-A)*p.z - A*p.az - D*vi.z;
+        ps_j[k+1].ax = B*(1.-A[k])*p.x - A[k]*p.ax - D*vix;
+        ps_j[k+1].ay = B*(1.-A[k])*p.y - A[k]*p.ay - D*viy;
+        ps_j[k+1].az = B*(1.-A[k])*p.z - A[k]*p.az - D*viz;
     }
     
     ps_j[0].ax = 0.;
@@ -156,9 +276,6 @@ static void rebx_calculate_gr(struct reb_simulation* const sim, struct reb_parti
         particles[i].ay += ps[i].ay;
         particles[i].az += ps[i].az;
     }
-    
-    free(ps);
-    free(ps_j);
 }
 
 void rebx_gr(struct reb_simulation* const sim, struct rebx_force* const force, struct reb_particle* const particles, const int N){
@@ -169,20 +286,35 @@ void rebx_gr(struct reb_simulation* const sim, struct rebx_force* const force, s
     }
     const double C2 = (*c)*(*c);
     int* max_iterations = rebx_get_param(sim->extras, force->ap, "max_iterations");
-    if(max_iterations != NULL){
-        rebx_calculate_gr(sim, particles, N, C2, sim->G, *max_iterations);
-    }
-    else{
-        const int default_max_iterations = 10;
-        rebx_calculate_gr(sim, particles, N, C2, sim->G, default_max_iterations);
+    const int default_max_iterations = 10;
+    const int Niterations = (max_iterations == NULL) ? default_max_iterations : *max_iterations;
+    const int* const gr_reuse_gravity = rebx_get_param(sim->extras, force->ap, "gr_reuse_gravity");
+    const int reuse_gravity = (gr_reuse_gravity != NULL && *gr_reuse_gravity);
+
+    // Convergence statistics are only accumulated if the user opted in by setting gr_iterations
+    double* const gr_iterations = rebx_get_param(sim->extras, force->ap, "gr_iterations");
+    if (gr_iterations == NULL){
+        rebx_calculate_gr(sim, particles, N, C2, sim->G, Niterations, default_max_iterations, reuse_gravity, NULL);
+        return;
     }
+    double stats[3] = {0.};
+    rebx_calculate_gr(sim, particles, N, C2, sim->G, Niterations, default_max_iterations, reuse_gravity, stats);
+    *gr_iterations += stats[0];
+    double* const gr_solves = rebx_get_param(sim->extras, force->ap, "gr_solves");
+    rebx_set_param_double(sim->extras, &force->ap, "gr_solves", (gr_solves == NULL ? 0. : *gr_solves) + stats[1]);
+    double* const gr_unconverged = rebx_get_param(sim->extras, force->ap, "gr_unconverged");
+    rebx_set_param_double(sim->extras, &force->ap, "gr_unconverged", (gr_unconverged == NULL ? 0. : *gr_unconverged) + stats[2]);
 }
 
 static double rebx_calculate_gr_hamiltonian(struct rebx_extras* const rebx, struct reb_simulation* const sim, const double C2){
     const int N = sim->N - sim->N_var;
     const double G = sim->G;
 
-    struct reb_particle* const ps_j = malloc(N*sizeof(*ps_j));
+    struct reb_particle* const ps_j = rebx_get_workspace(rebx, N*(sizeof(struct reb_particle) + sizeof(double)));
+    if (ps_j == NULL){
+        return 0;
+    }
+    double* const m_j = (double*)(ps_j + N);
     struct reb_particle* const ps = sim->particles; 
     // Calculate Newtonian potentials
 
@@ -203,7 +335,6 @@ static double rebx_calculate_gr_hamiltonian(struct rebx_extras* const rebx, stru
     // Transform to Jacobi coordinates
     const struct reb_particle source = ps[0];
 	const double mu = G*source.m;
-    double* const m_j = malloc(N*sizeof(*m_j));
     rebx_calculate_jacobi_masses(ps, m_j, N);
     reb_transformations_inertial_to_jacobi_posvel(ps, ps_j, ps, N, N);
 
@@ -230,9 +361,6 @@ static double rebx_calculate_gr_hamiltonian(struct rebx_extras* const rebx, stru
     }
     V_PN /= C2;
     
-    free(ps_j);
-    free(m_j);
-    
 	return T + V_newt + V_PN;
 }
 
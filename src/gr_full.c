@@ -43,7 +43,16 @@
  * Field (C type)               Required    Description
  * ============================ =========== ==================================================================
  * c (double)                   Yes         Speed of light in the units used for the simulation.
+ * gr_full_theta (double)       No          If set (>0), use a Barnes-Hut tree with this opening angle for distant particles (see below).
+ * max_iterations (int)         No          Maximum iterations of the fixed point solves (defaults to 10 for the force, 100 for rebx_gr_full_hamiltonian).
  * ============================ =========== ==================================================================
+ *
+ * For large N, setting gr_full_theta approximates the contribution of distant groups of particles from the mass and velocity moments
+ * of tree cells (cells are opened when width/distance > gr_full_theta), reducing the cost from O(N^2) to O(N log N). Nearby particles,
+ * and all interactions with the most massive body, are still summed exactly. Smaller values are more accurate (0 recovers the exact sum).
+ * Cells only use monopole moments, so accuracy is best when a dominant body is present (e.g., disks around a central mass, where
+ * gr_full_theta = 0.5 gives relative errors in the post-Newtonian accelerations around 1e-5). For self-gravitating clusters without a
+ * dominant body errors are much larger (~1e-2 for gr_full_theta = 0.3), so check against the exact sum on a smaller problem first.
  * 
  * **Particle Parameters**
  * 
@@ -57,6 +66,8 @@
 #include <string.h>
 #include "rebound.h"
 #include "reboundx.h"
+#include "core.h"
+#include "rebxtools.h"
 
 static void rebx_calculate_gr_full(struct reb_simulation* const sim, struct reb_particle* const particles, const int N, const double C2, const double G, const int max_iterations, const int gravity_ignore_10){
     
@@ -230,6 +241,522 @@ static void rebx_calculate_gr_full(struct reb_simulation* const sim, struct reb_
     }
 }
 
+/*
+ * Tree (Barnes-Hut) approximation of rebx_calculate_gr_full for large N.
+ * Every pairwise term in the kernel above is linear in the source particle's mass-weighted quantities, so the contribution from a
+ * distant cell can be written in terms of its moments: M, the center of mass, P = sum m v, K = sum m v^2, S = sum m v v^T,
+ * Phi = sum m phi and Q = sum m (a_newton + a_1PN) (updated each iteration). These reduce exactly to the pairwise terms for a single
+ * particle. Cells are opened if width/distance > theta. Leaves, and all interactions with the most massive body, are summed exactly.
+ */
+
+#define REBX_GR_FULL_TREE_MAX_DEPTH 64
+
+struct rebx_gr_full_node {
+    double x, y, z, w;      // Geometric center and width of cell
+    double m;               // Moments of particles in cell (see above)
+    double cx, cy, cz;
+    double px, py, pz;
+    double K;
+    double S[6];            // xx, xy, xz, yy, yz, zz
+    double phi;
+    double qx, qy, qz;
+    int children[8];
+    int particle;           // Head of linked list of particles in leaf (-1 if empty or internal)
+    int internal;
+};
+
+struct rebx_gr_full_tree {
+    int N;
+    int Nnodes;
+    int Nnodes_max;
+    struct rebx_gr_full_node* nodes;
+    int* next;              // Linked lists of particles in leaves
+    double* phi;            // sum_{k!=i} G m_k / r_ik
+    double* a_newton;       // 3N arrays
+    double* a_const;
+    double* a_new;
+    double* a_old;
+};
+
+void rebx_gr_full_free_arrays(struct rebx_extras* rebx, struct rebx_force* force){
+    struct rebx_gr_full_tree* const tree = rebx_get_param(rebx, force->ap, "gr_full_tree");
+    if (tree != NULL){
+        free(tree->nodes);
+        free(tree->next);
+        free(tree->phi);
+        free(tree->a_newton);
+        free(tree->a_const);
+        free(tree->a_new);
+        free(tree->a_old);
+        free(tree);
+    }
+}
+
+static int rebx_gr_full_new_node(struct reb_simulation* const sim, struct rebx_gr_full_tree* const tree, const double x, const double y, const double z, const double w){
+    if (tree->Nnodes == tree->Nnodes_max){
+        const int Nnodes_max = tree->Nnodes_max ? 2*tree->Nnodes_max : 64;
+        struct rebx_gr_full_node* const nodes = rebx_malloc(sim->extras, Nnodes_max*sizeof(*nodes));
+        if (nodes == NULL){
+            return -1;
+        }
+        if (tree->Nnodes > 0){
+            memcpy(nodes, tree->nodes, tree->Nnodes*sizeof(*nodes));
+        }
+        free(tree->nodes);
+        tree->nodes = nodes;
+        tree->Nnodes_max = Nnodes_max;
+    }
+    struct rebx_gr_full_node* const node = &tree->nodes[tree->Nnodes];
+    memset(node, 0, sizeof(*node));
+    node->x = x;
+    node->y = y;
+    node->z = z;
+    node->w = w;
+    node->particle = -1;
+    for (int o=0; o<8; o++){
+        node->children[o] = -1;
+    }
+    return tree->Nnodes++;
+}
+
+static int rebx_gr_full_octant(const struct rebx_gr_full_node* const node, const struct reb_particle* const p){
+    return (p->x > node->x) + 2*(p->y > node->y) + 4*(p->z > node->z);
+}
+
+static int rebx_gr_full_child(struct reb_simulation* const sim, struct rebx_gr_full_tree* const tree, const int n, const int o){
+    const double w = tree->nodes[n].w/2.;
+    const double x = tree->nodes[n].x + ((o & 1) ? w/2. : -w/2.);
+    const double y = tree->nodes[n].y + ((o & 2) ? w/2. : -w/2.);
+    const double z = tree->nodes[n].z + ((o & 4) ? w/2. : -w/2.);
+    const int c = rebx_gr_full_new_node(sim, tree, x, y, z, w); // may move tree->nodes
+    if (c >= 0){
+        tree->nodes[n].children[o] = c;
+    }
+    return c;
+}
+
+static int rebx_gr_full_insert(struct reb_simulation* const sim, struct rebx_gr_full_tree* const tree, const struct reb_particle* const particles, const int i){
+    int n = 0;
+    for (int depth=0; ; depth++){
+        if (tree->nodes[n].internal){
+            const int o = rebx_gr_full_octant(&tree->nodes[n], &particles[i]);
+            if (tree->nodes[n].children[o] == -1){
+                const int c = rebx_gr_full_child(sim, tree, n, o);
+                if (c < 0){
+                    return 0;
+                }
+                tree->nodes[c].particle = i;
+                tree->next[i] = -1;
+                return 1;
+            }
+            n = tree->nodes[n].children[o];
+            continue;
+        }
+        if (tree->nodes[n].particle == -1 || depth >= REBX_GR_FULL_TREE_MAX_DEPTH){ // empty leaf, or (nearly) coincident particles share a leaf
+            tree->next[i] = tree->nodes[n].particle;
+            tree->nodes[n].particle = i;
+            return 1;
+        }
+        // Split leaf and push its particle down one level, then keep descending with particle i
+        const int p = tree->nodes[n].particle;
+        tree->nodes[n].particle = -1;
+        tree->nodes[n].internal = 1;
+        const int c = rebx_gr_full_child(sim, tree, n, rebx_gr_full_octant(&tree->nodes[n], &particles[p]));
+        if (c < 0){
+            return 0;
+        }
+        tree->nodes[c].particle = p;
+    }
+}
+
+// Builds tree of all particles except the dominant body and computes mass and velocity moments
+static int rebx_gr_full_build_tree(struct reb_simulation* const sim, struct rebx_gr_full_tree* const tree, const struct reb_particle* const particles, const int N, const int dominant){
+    double min[3] = {INFINITY, INFINITY, INFINITY};
+    double max[3] = {-INFINITY, -INFINITY, -INFINITY};
+    for (int i=0; i<N; i++){
+        if (i == dominant){
+            continue;
+        }
+        const double x[3] = {particles[i].x, particles[i].y, particles[i].z};
+        for (int k=0; k<3; k++){
+            min[k] = x[k] < min[k] ? x[k] : min[k];
+            max[k] = x[k] > max[k] ? x[k] : max[k];
+        }
+    }
+    double w = 0.;
+    for (int k=0; k<3; k++){
+        w = (max[k]-min[k]) > w ? (max[k]-min[k]) : w;
+    }
+    w = w*1.0001 + DBL_MIN;
+    tree->Nnodes = 0;
+    if (rebx_gr_full_new_node(sim, tree, 0.5*(min[0]+max[0]), 0.5*(min[1]+max[1]), 0.5*(min[2]+max[2]), w) < 0){
+        return 0;
+    }
+    for (int i=0; i<N; i++){
+        if (i != dominant && !rebx_gr_full_insert(sim, tree, particles, i)){
+            return 0;
+        }
+    }
+    // Children always come after their parents, so accumulate moments in reverse order
+    for (int n=tree->Nnodes-1; n>=0; n--){
+        struct rebx_gr_full_node* const node = &tree->nodes[n];
+        for (int j=node->particle; j!=-1; j=tree->next[j]){
+            const struct reb_particle p = particles[j];
+            node->m += p.m;
+            node->cx += p.m*p.x;
+            node->cy += p.m*p.y;
+            node->cz += p.m*p.z;
+            node->px += p.m*p.vx;
+            node->py += p.m*p.vy;
+            node->pz += p.m*p.vz;
+            node->K += p.m*(p.vx*p.vx + p.vy*p.vy + p.vz*p.vz);
+            node->S[0] += p.m*p.vx*p.vx;
+            node->S[1] += p.m*p.vx*p.vy;
+            node->S[2] += p.m*p.vx*p.vz;
+            node->S[3] += p.m*p.vy*p.vy;
+            node->S[4] += p.m*p.vy*p.vz;
+            node->S[5] += p.m*p.vz*p.vz;
+        }
+        for (int o=0; o<8; o++){
+            const int c = node->children[o];
+            if (c == -1){
+                continue;
+            }
+            const struct rebx_gr_full_node* const child = &tree->nodes[c];
+            node->m += child->m;
+            node->cx += child->m*child->cx; // child COMs are already normalized
+            node->cy += child->m*child->cy;
+            node->cz += child->m*child->cz;
+            node->px += child->px;
+            node->py += child->py;
+            node->pz += child->pz;
+            node->K += child->K;
+            for (int k=0; k<6; k++){
+                node->S[k] += child->S[k];
+            }
+        }
+        if (node->m > 0.){
+            node->cx /= node->m;
+            node->cy /= node->m;
+            node->cz /= node->m;
+        }
+        else{
+            node->cx = node->x;
+            node->cy = node->y;
+            node->cz = node->z;
+        }
+    }
+    return 1;
+}
+
+// Accumulates the mass-weighted phi (dim=1) or a_newton + a_old (dim=3) into the tree
+static void rebx_gr_full_tree_moment(struct rebx_gr_full_tree* const tree, const struct reb_particle* const particles, const int dim){
+    for (int n=tree->Nnodes-1; n>=0; n--){
+        struct rebx_gr_full_node* const node = &tree->nodes[n];
+        double q[3] = {0.};
+        for (int j=node->particle; j!=-1; j=tree->next[j]){
+            if (dim == 1){
+                q[0] += particles[j].m*tree->phi[j];
+            }
+            else{
+                for (int k=0; k<3; k++){
+                    q[k] += particles[j].m*(tree->a_newton[3*j+k] + tree->a_old[3*j+k]);
+                }
+            }
+        }
+        for (int o=0; o<8; o++){
+            const int c = node->children[o];
+            if (c == -1){
+                continue;
+            }
+            if (dim == 1){
+                q[0] += tree->nodes[c].phi;
+            }
+            else{
+                q[0] += tree->nodes[c].qx;
+                q[1] += tree->nodes[c].qy;
+                q[2] += tree->nodes[c].qz;
+            }
+        }
+        if (dim == 1){
+            node->phi = q[0];
+        }
+        else{
+            node->qx = q[0];
+            node->qy = q[1];
+            node->qz = q[2];
+        }
+    }
+}
+
+// Returns 1 if particle i can use the moments of node instead of opening it
+static int rebx_gr_full_accept(const struct rebx_gr_full_node* const node, const struct reb_particle* const pi, const double theta, double* const dx){
+    dx[0] = pi->x - node->cx;
+    dx[1] = pi->y - node->cy;
+    dx[2] = pi->z - node->cz;
+    if (fabs(pi->x - node->x) <= node->w/2. && fabs(pi->y - node->y) <= node->w/2. && fabs(pi->z - node->z) <= node->w/2.){
+        return 0; // never approximate a cell containing the particle itself
+    }
+    const double r2 = dx[0]*dx[0] + dx[1]*dx[1] + dx[2]*dx[2];
+    return node->w*node->w < theta*theta*r2;
+}
+
+enum rebx_gr_full_term {
+    REBX_GR_FULL_PHI,       // sum G m/r
+    REBX_GR_FULL_CONST,     // constant (velocity-dependent) terms
+    REBX_GR_FULL_NONCONST,  // terms depending on the source accelerations
+};
+
+// Exact contribution of particle j to term for particle i
+static void rebx_gr_full_pair(const enum rebx_gr_full_term term, const struct reb_particle* const particles, const struct rebx_gr_full_tree* const tree, const int i, const int j, const double G, const double C2, double* const out){
+    const struct reb_particle pi = particles[i];
+    const struct reb_particle pj = particles[j];
+    const double dx = pi.x - pj.x;
+    const double dy = pi.y - pj.y;
+    const double dz = pi.z - pj.z;
+    const double r2 = dx*dx + dy*dy + dz*dz;
+    const double r = sqrt(r2);
+    const double r3 = r2*r;
+    switch (term){
+        case REBX_GR_FULL_PHI:
+            out[0] += G*pj.m/r;
+            break;
+        case REBX_GR_FULL_CONST:
+        {
+            const double vi2 = pi.vx*pi.vx + pi.vy*pi.vy + pi.vz*pi.vz;
+            const double vj2 = pj.vx*pj.vx + pj.vy*pj.vy + pj.vz*pj.vz;
+            const double vivj = pi.vx*pj.vx + pi.vy*pj.vy + pi.vz*pj.vz;
+            const double rvj = dx*pj.vx + dy*pj.vy + dz*pj.vz;
+            const double factor1 = (4.*tree->phi[i] + tree->phi[j] - vi2 - 2.*vj2 + 4.*vivj + 1.5*rvj*rvj/r2)/C2;
+            const double factor2 = (dx*(4.*pi.vx-3.*pj.vx) + dy*(4.*pi.vy-3.*pj.vy) + dz*(4.*pi.vz-3.*pj.vz))/C2;
+            const double pre = G*pj.m/r3;
+            out[0] += pre*(dx*factor1 + factor2*(pi.vx - pj.vx));
+            out[1] += pre*(dy*factor1 + factor2*(pi.vy - pj.vy));
+            out[2] += pre*(dz*factor1 + factor2*(pi.vz - pj.vz));
+            break;
+        }
+        case REBX_GR_FULL_NONCONST:
+        {
+            const double ax = tree->a_newton[3*j] + tree->a_old[3*j];
+            const double ay = tree->a_newton[3*j+1] + tree->a_old[3*j+1];
+            const double az = tree->a_newton[3*j+2] + tree->a_old[3*j+2];
+            const double ra = (dx*ax + dy*ay + dz*az)/(2.*C2);
+            out[0] += G*pj.m*(dx*ra/r3 + 3.5/C2*ax/r);
+            out[1] += G*pj.m*(dy*ra/r3 + 3.5/C2*ay/r);
+            out[2] += G*pj.m*(dz*ra/r3 + 3.5/C2*az/r);
+            break;
+        }
+    }
+}
+
+// Contribution of all particles in node to term for particle i, from the node's moments
+static void rebx_gr_full_cell(const enum rebx_gr_full_term term, const struct reb_particle* const particles, const struct rebx_gr_full_tree* const tree, const struct rebx_gr_full_node* const node, const int i, const double* const d, const double G, const double C2, double* const out){
+    const struct reb_particle pi = particles[i];
+    const double r2 = d[0]*d[0] + d[1]*d[1] + d[2]*d[2];
+    const double r = sqrt(r2);
+    const double r3 = r2*r;
+    switch (term){
+        case REBX_GR_FULL_PHI:
+            out[0] += G*node->m/r;
+            break;
+        case REBX_GR_FULL_CONST:
+        {
+            const double vi2 = pi.vx*pi.vx + pi.vy*pi.vy + pi.vz*pi.vz;
+            const double viP = pi.vx*node->px + pi.vy*node->py + pi.vz*node->pz;
+            const double* const S = node->S;
+            const double Sd[3] = {S[0]*d[0] + S[1]*d[1] + S[2]*d[2], S[1]*d[0] + S[3]*d[1] + S[4]*d[2], S[2]*d[0] + S[4]*d[1] + S[5]*d[2]};
+            const double dSd = d[0]*Sd[0] + d[1]*Sd[1] + d[2]*Sd[2];
+            const double factor1 = (node->m*(4.*tree->phi[i] - vi2) + node->phi - 2.*node->K + 4.*viP + 1.5*dSd/r2)/C2;
+            const double dvi = d[0]*pi.vx + d[1]*pi.vy + d[2]*pi.vz;
+            const double dP = d[0]*node->px + d[1]*node->py + d[2]*node->pz;
+            const double v[3] = {pi.vx, pi.vy, pi.vz};
+            const double P[3] = {node->px, node->py, node->pz};
+            for (int k=0; k<3; k++){
+                const double term2 = 4.*dvi*(node->m*v[k] - P[k]) - 3.*(v[k]*dP - Sd[k]);
+                out[k] += G/r3*(d[k]*factor1 + term2/C2);
+            }
+            break;
+        }
+        case REBX_GR_FULL_NONCONST:
+        {
+            const double dQ = (d[0]*node->qx + d[1]*node->qy + d[2]*node->qz)/(2.*C2);
+            out[0] += G*(d[0]*dQ/r3 + 3.5/C2*node->qx/r);
+            out[1] += G*(d[1]*dQ/r3 + 3.5/C2*node->qy/r);
+            out[2] += G*(d[2]*dQ/r3 + 3.5/C2*node->qz/r);
+            break;
+        }
+    }
+}
+
+// Evaluates term for particle i: exact for the dominant body and leaves, from moments for cells satisfying the opening criterion
+static void rebx_gr_full_tree_walk(const enum rebx_gr_full_term term, const struct reb_particle* const particles, const struct rebx_gr_full_tree* const tree, const int i, const int dominant, const double theta, const double G, const double C2, double* const out){
+    if (i != dominant){
+        rebx_gr_full_pair(term, particles, tree, i, dominant, G, C2, out);
+    }
+    int stack[8*REBX_GR_FULL_TREE_MAX_DEPTH + 8];
+    int Nstack = 0;
+    stack[Nstack++] = 0;
+    while (Nstack > 0){
+        const struct rebx_gr_full_node* const node = &tree->nodes[stack[--Nstack]];
+        if (node->m == 0.){
+            continue;
+        }
+        for (int j=node->particle; j!=-1; j=tree->next[j]){
+            if (j != i){
+                rebx_gr_full_pair(term, particles, tree, i, j, G, C2, out);
+            }
+        }
+        if (!node->internal){
+            continue;
+        }
+        double d[3];
+        if (rebx_gr_full_accept(node, &particles[i], theta, d)){
+            rebx_gr_full_cell(term, particles, tree, node, i, d, G, C2, out);
+            continue;
+        }
+        for (int o=0; o<8; o++){
+            if (node->children[o] != -1){
+                stack[Nstack++] = node->children[o];
+            }
+        }
+    }
+}
+
+static void rebx_gr_full_term(const enum rebx_gr_full_term term, const struct reb_particle* const particles, const int N, const struct rebx_gr_full_tree* const tree, const int dominant, const double theta, const double G, const double C2, double* const out){
+    const int dim = (term == REBX_GR_FULL_PHI) ? 1 : 3;
+#pragma omp parallel for schedule(guided)
+    for (int i=0; i<N; i++){
+        double* const outi = &out[dim*i];
+        for (int k=0; k<dim; k++){
+            outi[k] = 0.;
+        }
+        if (i == dominant){ // dominant body feels all other particles exactly
+            for (int j=0; j<N; j++){
+                if (j != i){
+                    rebx_gr_full_pair(term, particles, tree, i, j, G, C2, outi);
+                }
+            }
+        }
+        else{
+            rebx_gr_full_tree_walk(term, particles, tree, i, dominant, theta, G, C2, outi);
+        }
+    }
+}
+
+static struct rebx_gr_full_tree* rebx_gr_full_get_tree(struct reb_simulation* const sim, struct rebx_force* const gr_full, const int N){
+    struct rebx_extras* const rebx = sim->extras;
+    struct rebx_gr_full_tree* tree = rebx_get_param(rebx, gr_full->ap, "gr_full_tree");
+    if (tree == NULL){
+        tree = rebx_malloc(rebx, sizeof(*tree));
+        if (tree == NULL){
+            return NULL;
+        }
+        memset(tree, 0, sizeof(*tree));
+        rebx_set_param_pointer(rebx, &gr_full->ap, "gr_full_tree", tree);
+        rebx_set_param_pointer(rebx, &gr_full->ap, "free_arrays", rebx_gr_full_free_arrays);
+    }
+    if (tree->N < N){
+        free(tree->next);
+        free(tree->phi);
+        free(tree->a_newton);
+        free(tree->a_const);
+        free(tree->a_new);
+        free(tree->a_old);
+        tree->next = rebx_malloc(rebx, N*sizeof(*tree->next));
+        tree->phi = rebx_malloc(rebx, N*sizeof(*tree->phi));
+        tree->a_newton = rebx_malloc(rebx, 3*N*sizeof(*tree->a_newton));
+        tree->a_const = rebx_malloc(rebx, 3*N*sizeof(*tree->a_const));
+        tree->a_new = rebx_malloc(rebx, 3*N*sizeof(*tree->a_new));
+        tree->a_old = rebx_malloc(rebx, 3*N*sizeof(*tree->a_old));
+        if (!tree->next || !tree->phi || !tree->a_newton || !tree->a_const || !tree->a_new || !tree->a_old){ // rebx_malloc reported the error
+            free(tree->next);
+            free(tree->phi);
+            free(tree->a_newton);
+            free(tree->a_const);
+            free(tree->a_new);
+            free(tree->a_old);
+            tree->next = NULL;
+            tree->phi = NULL;
+            tree->a_newton = NULL;
+            tree->a_const = NULL;
+            tree->a_new = NULL;
+            tree->a_old = NULL;
+            tree->N = 0;
+            return NULL;
+        }
+        tree->N = N;
+    }
+    return tree;
+}
+
+static void rebx_calculate_gr_full_tree(struct reb_simulation* const sim, struct rebx_force* const gr_full, struct reb_particle* const particles, const int N, const double C2, const double G, const int max_iterations, const int gravity_ignore_10, const double theta){
+    struct rebx_gr_full_tree* const tree = rebx_gr_full_get_tree(sim, gr_full, N);
+    if (tree == NULL){
+        return;
+    }
+    int dominant = 0;
+    for (int i=1; i<N; i++){
+        if (particles[i].m > particles[dominant].m){
+            dominant = i;
+        }
+    }
+    if (!rebx_gr_full_build_tree(sim, tree, particles, N, dominant)){
+        return;
+    }
+
+    for (int i=0; i<N; i++){
+        tree->a_newton[3*i] = particles[i].ax;
+        tree->a_newton[3*i+1] = particles[i].ay;
+        tree->a_newton[3*i+2] = particles[i].az;
+        tree->a_new[3*i] = 0.;
+        tree->a_new[3*i+1] = 0.;
+        tree->a_new[3*i+2] = 0.;
+    }
+    if (gravity_ignore_10){
+        const double dx = particles[0].x - particles[1].x;
+        const double dy = particles[0].y - particles[1].y;
+        const double dz = particles[0].z - particles[1].z;
+        const double r = sqrt(dx*dx + dy*dy + dz*dz);
+        const double prefact = -G/(r*r*r);
+        tree->a_newton[0] += prefact*particles[1].m*dx;
+        tree->a_newton[1] += prefact*particles[1].m*dy;
+        tree->a_newton[2] += prefact*particles[1].m*dz;
+        tree->a_newton[3] -= prefact*particles[0].m*dx;
+        tree->a_newton[4] -= prefact*particles[0].m*dy;
+        tree->a_newton[5] -= prefact*particles[0].m*dz;
+    }
+
+    rebx_gr_full_term(REBX_GR_FULL_PHI, particles, N, tree, dominant, theta, G, C2, tree->phi);
+    rebx_gr_full_tree_moment(tree, particles, 1);
+    rebx_gr_full_term(REBX_GR_FULL_CONST, particles, N, tree, dominant, theta, G, C2, tree->a_const);
+
+    for (int k=0; k<max_iterations; k++){
+        double* const a_old = tree->a_new; // swap so a_old holds the previous iterate
+        tree->a_new = tree->a_old;
+        tree->a_old = a_old;
+        rebx_gr_full_tree_moment(tree, particles, 3);
+        rebx_gr_full_term(REBX_GR_FULL_NONCONST, particles, N, tree, dominant, theta, G, C2, tree->a_new);
+
+        double maxdev = 0.;
+        for (int i=0; i<3*N; i++){
+            tree->a_new[i] += tree->a_const[i];
+            const double dev = (fabs(tree->a_new[i]) < 1.e-30) ? 0. : fabs((tree->a_new[i] - tree->a_old[i])/tree->a_new[i]);
+            maxdev = dev > maxdev ? dev : maxdev;
+        }
+        if (maxdev < 1.e-30){
+            break;
+        }
+        if (k==max_iterations-1){
+            reb_warning(sim, "REBOUNDx Warning: max_iterations loops in rebx_gr_full did not converge.\n");
+        }
+    }
+    for (int i=0; i<N; i++){
+        particles[i].ax += tree->a_new[3*i];
+        particles[i].ay += tree->a_new[3*i+1];
+        particles[i].az += tree->a_new[3*i+2];
+    }
+}
+
 void rebx_gr_full(struct reb_simulation* const sim, struct rebx_force* const gr_full, struct reb_particle* const particles, const int N){
     double* c = rebx_get_param(sim->extras, gr_full->ap, "c");
     if (c == NULL){
@@ -239,7 +766,12 @@ void rebx_gr_full(struct reb_simulation* const sim, struct rebx_force* const gr_
     const double C2 = (*c)*(*c);
     const unsigned int gravity_ignore_10 = sim->gravity_ignore_terms==1;
     int* max_iterations = rebx_get_param(sim->extras, gr_full->ap, "max_iterations");
-    if(max_iterations != NULL){
+    double* theta = rebx_get_param(sim->extras, gr_full->ap, "gr_full_theta");
+    if (theta != NULL && *theta > 0.){
+        const int iterations = (max_iterations != NULL) ? *max_iterations : 10;
+        rebx_calculate_gr_full_tree(sim, gr_full, particles, N, C2, sim->G, iterations, gravity_ignore_10, *theta);
+    }
+    else if(max_iterations != NULL){
         rebx_calculate_gr_full(sim, particles, N, C2, sim->G, *max_iterations, gravity_ignore_10);
     }
     else{
@@ -257,43 +789,56 @@ double rebx_gr_full_hamiltonian(struct rebx_extras* const rebx, const struct reb
     double* c = rebx_get_param(rebx, force->ap, "c");
     if (c == NULL){
         reb_error(sim, "Need to set speed of light in gr effect.  See examples in documentation.\n");
+        return 0;
     }
     const double C2 = (*c)*(*c);
     const int N = sim->N - sim->N_var;
     const double G = sim->G;
     struct reb_particle* const particles = sim->particles;
 
-	double e_kin = 0.;
-	double e_pot = 0.;
-	double e_pn  = 0.;
-	
-    struct reb_vec3d* vtilde = malloc(N*sizeof(*vtilde));
-    struct reb_vec3d* vtilde_old = malloc(N*sizeof(*vtilde_old));
-    for (int j=0; j<N;j++){
-        vtilde[j].x = particles[j].vx;
-        vtilde[j].y = particles[j].vy;
-        vtilde[j].z = particles[j].vz;
+    // Reuse rebx workspace: vtilde and vtilde_new (N vectors each), sumk and per-particle energies E (N doubles each)
+    struct reb_vec3d* vtilde = rebx_get_workspace(rebx, N*(2*sizeof(struct reb_vec3d) + 2*sizeof(double)));
+    if (vtilde == NULL){
+        return 0;
+    }
+    struct reb_vec3d* vtilde_new = vtilde + N;
+    double* const sumk = (double*)(vtilde_new + N);
+    double* const E = sumk + N;
+
+#pragma omp parallel for schedule(guided)
+    for (int i=0;i<N;i++){
+        struct reb_particle pi = particles[i];
+        vtilde[i].x = pi.vx;
+        vtilde[i].y = pi.vy;
+        vtilde[i].z = pi.vz;
+        double sum = 0.;
+        double comp = 0.;
+        for (int k=0;k<N;k++){
+            if (k!=i){
+                struct reb_particle pk = particles[k];
+                double xik = pk.x - pi.x;
+                double yik = pk.y - pi.y;
+                double zik = pk.z - pi.z;
+                double rik = sqrt(xik*xik + yik*yik + zik*zik);
+                rebx_neumaier_add(&sum, &comp, -2.*G*pk.m/rik);
+            }
+        }
+        sumk[i] = sum + comp;
     }
     
-    for (int q=0; q<10;q++){
+    // Jacobi-style fixed point iteration (each vtilde updated from the previous iterate) so particles can be updated in parallel.
+    // This converges more slowly than updating in place, so iterate to machine precision rather than a fixed number of times.
+    const int* const max_iterations_ptr = rebx_get_param(rebx, force->ap, "max_iterations");
+    const int max_iterations = (max_iterations_ptr != NULL) ? *max_iterations_ptr : 100;
+    for (int q=0; q<max_iterations; q++){
+        double maxdev = 0.;
+#pragma omp parallel for schedule(guided) reduction(max:maxdev)
         for (int i=0;i<N;i++){
             struct reb_particle pi = particles[i];
             
             double vtildei2 = vtilde[i].x*vtilde[i].x + vtilde[i].y*vtilde[i].y + vtilde[i].z*vtilde[i].z;
             double A = (1. - 0.5*vtildei2/C2);
             
-            double sumk = 0.;
-            for (int k=0;k<N;k++){
-                if (k!=i){
-                    struct reb_particle pk = particles[k];
-                    double xik = pk.x - pi.x;
-                    double yik = pk.y - pi.y;
-                    double zik = pk.z - pi.z;
-                    double rik = sqrt(xik*xik + yik*yik + zik*zik);
-                    sumk -= 2.*G*pk.m/rik;
-                }
-            }
-            
             struct reb_vec3d dv_pn = {0.};
             for (int j=0;j<N;j++){
                 if (j != i){
@@ -316,33 +861,36 @@ double rebx_gr_full_hamiltonian(struct rebx_extras* const rebx, const struct reb
             dv_pn.y *= G/(2.*C2);
             dv_pn.z *= G/(2.*C2);
 
-            vtilde[i].x = (pi.vx + dv_pn.x)/A;
-            vtilde[i].y = (pi.vy + dv_pn.y)/A;
-            vtilde[i].z = (pi.vz + dv_pn.z)/A;
+            vtilde_new[i].x = (pi.vx + dv_pn.x)/A;
+            vtilde_new[i].y = (pi.vy + dv_pn.y)/A;
+            vtilde_new[i].z = (pi.vz + dv_pn.z)/A;
+
+            const double dv2 = (vtilde_new[i].x - vtilde[i].x)*(vtilde_new[i].x - vtilde[i].x) + (vtilde_new[i].y - vtilde[i].y)*(vtilde_new[i].y - vtilde[i].y) + (vtilde_new[i].z - vtilde[i].z)*(vtilde_new[i].z - vtilde[i].z);
+            const double v2 = vtilde_new[i].x*vtilde_new[i].x + vtilde_new[i].y*vtilde_new[i].y + vtilde_new[i].z*vtilde_new[i].z;
+            const double dev = (v2 < 1.e-60) ? 0. : sqrt(dv2/v2);
+            maxdev = dev > maxdev ? dev : maxdev;
+        }
+        struct reb_vec3d* const tmp = vtilde;
+        vtilde = vtilde_new;
+        vtilde_new = tmp;
+        if (maxdev <= DBL_EPSILON){
+            break;
+        }
+        if (q == max_iterations-1){
+            reb_warning(sim, "REBOUNDx Warning: max_iterations loops in rebx_gr_full_hamiltonian did not converge.\n");
         }
     }
     
-    for (int i=0; i<N; i++){
-        struct reb_particle p = particles[i];
-        double vtildei2 = vtilde[i].x*vtilde[i].x + vtilde[i].y*vtilde[i].y + vtilde[i].z*vtilde[i].z;
-        e_kin += 0.5*p.m*vtildei2;
-    }
-
+    // Kinetic, post-Newtonian and Newtonian (j>i) terms for each particle, summed serially below so the result doesn't depend on the number of threads
+#pragma omp parallel for schedule(guided)
     for (int i=0;i<N;i++){
         struct reb_particle pi = particles[i];
-        double sumk = 0.;
-        for (int k=0;k<N;k++){
-            if (k!=i){
-                struct reb_particle pk = particles[k];
-                double xik = pk.x - pi.x;
-                double yik = pk.y - pi.y;
-                double zik = pk.z - pi.z;
-                double rik = sqrt(xik*xik + yik*yik + zik*zik);
-                sumk -= 2.*G*pk.m/rik;
-            }
-        }
-        
         double vtildei2 = vtilde[i].x*vtilde[i].x + vtilde[i].y*vtilde[i].y + vtilde[i].z*vtilde[i].z;
+        double e_i = 0.;
+        double comp = 0.;
+
+        rebx_neumaier_add(&e_i, &comp, 0.5*pi.m*vtildei2);                      // kinetic
+        rebx_neumaier_add(&e_i, &comp, -pi.m/(8.*C2)*vtildei2*vtildei2);
 
         for (int j=0;j<N;j++){
             if (j != i){
@@ -356,22 +904,14 @@ double rebx_gr_full_hamiltonian(struct rebx_extras* const rebx, const struct reb
                 double rijdotvi = vtilde[i].x*xij + vtilde[i].y*yij + vtilde[i].z*zij;
                 double vidotvj = vtilde[i].x*vtilde[j].x + vtilde[i].y*vtilde[j].y + vtilde[i].z*vtilde[j].z;
                 
-                e_pn -= G/(4.*C2)*pi.m*pj.m/rij*(6.*vtildei2 - 7*vidotvj - rijdotvi*rijdotvj/rij2 + sumk);
+                rebx_neumaier_add(&e_i, &comp, -G/(4.*C2)*pi.m*pj.m/rij*(6.*vtildei2 - 7*vidotvj - rijdotvi*rijdotvj/rij2 + sumk[i]));
+                if (j > i){ // classic full
+                    rebx_neumaier_add(&e_i, &comp, -G*pi.m*pj.m/rij);
+                }
             }
         }
-        
-        e_pn -= pi.m/(8.*C2)*vtildei2*vtildei2;
-        
-        for (int j=i+1; j<N; j++){ // classic full
-            struct reb_particle pj = particles[j];
-            double dx = pi.x - pj.x;
-            double dy = pi.y - pj.y;
-            double dz = pi.z - pj.z;	
-            double r = sqrt(dx*dx + dy*dy + dz*dz);
-            
-            e_pot -= G*pi.m*pj.m/r;
-        }
+        E[i] = e_i + comp;
     }
     
-	return e_kin + e_pot + e_pn;
+	return rebx_compensated_sum(E, N);
 }
@@ -56,24 +56,55 @@
 #include <math.h>
 #include "rebound.h"
 #include "reboundx.h"
+#include "core.h"
+#include "rebxtools.h"
 
-static void rebx_calculate_gr_potential(struct reb_particle* const particles, const int N, const double C2, const double G){
+// Independent per-particle terms go in w (4*N doubles) in a loop the compiler can vectorize. The back reactions on the source are then added in order
+REBX_KERNEL void rebx_calculate_gr_potential_body(struct reb_particle* const particles, const int N, const double C2, const double G, double* const w){
     const struct reb_particle source = particles[0];
     const double prefac1 = 6.*(G*source.m)*(G*source.m)/C2;
+    double* const wx = w;
+    double* const wy = w + N;
+    double* const wz = w + 2*N;
+    double* const wprefac = w + 3*N;
+#pragma omp simd
     for (int i=1; i<N; i++){
-        const struct reb_particle p = particles[i];
-        const double dx = p.x - source.x;
-        const double dy = p.y - source.y;
-        const double dz = p.z - source.z;
+        const double dx = particles[i].x - source.x;
+        const double dy = particles[i].y - source.y;
+        const double dz = particles[i].z - source.z;
+        const double r2 = dx*dx + dy*dy + dz*dz;
+        wx[i] = dx;
+        wy[i] = dy;
+        wz[i] = dz;
+        wprefac[i] = prefac1/(r2*r2);
+    }
+    for (int i=1; i<N; i++){
+        const double prefac = wprefac[i];
+        particles[i].ax -= prefac*wx[i];
+        particles[i].ay -= prefac*wy[i];
+        particles[i].az -= prefac*wz[i];
+        particles[0].ax += particles[i].m/source.m*prefac*wx[i];
+        particles[0].ay += particles[i].m/source.m*prefac*wy[i];
+        particles[0].az += particles[i].m/source.m*prefac*wz[i];
+    }
+}
+
+REBX_MULTIVERSION(rebx_calculate_gr_potential, (struct reb_particle* const particles, const int N, const double C2, const double G, double* const w), (particles, N, C2, G, w))
+
+// Test particles don't act back on the central body, so each one is independent
+static void rebx_calculate_gr_potential_test_particles(struct reb_particle* const particles, const int N_massive, const int N, const double C2, const double G){
+    const struct reb_particle source = particles[0];
+    const double prefac1 = 6.*(G*source.m)*(G*source.m)/C2;
+#pragma omp parallel for schedule(static)
+    for (int i=N_massive; i<N; i++){
+        const double dx = particles[i].x - source.x;
+        const double dy = particles[i].y - source.y;
+        const double dz = particles[i].z - source.z;
         const double r2 = dx*dx + dy*dy + dz*dz;
         const double prefac = prefac1/(r2*r2);
-        
         particles[i].ax -= prefac*dx;
         particles[i].ay -= prefac*dy;
         particles[i].az -= prefac*dz;
-        particles[0].ax += p.m/source.m*prefac*dx;
-        particles[0].ay += p.m/source.m*prefac*dy;
-        particles[0].az += p.m/source.m*prefac*dz;
     }
 }
 
@@ -84,29 +115,47 @@ void rebx_gr_potential(struct reb_simulation* const sim, struct rebx_force* cons
     }
     else{
         const double C2 = (*c)*(*c);
-        rebx_calculate_gr_potential(particles, N, C2, sim->G);
+        int N_massive = rebx_get_N_massive(sim, N);
+        if (N_massive == 0){            // central body is itself a test particle
+            N_massive = N;
+        }
+        double* const w = rebx_get_workspace(sim->extras, 4*N_massive*sizeof(*w));
+        if (w == NULL){
+            return;
+        }
+        rebx_calculate_gr_potential(particles, N_massive, C2, sim->G, w);
+        rebx_calculate_gr_potential_test_particles(particles, N_massive, N, C2, sim->G);
     }
 }
 
-static double rebx_calculate_gr_potential_potential(struct reb_simulation* const sim, const double C2){
+// geometry holds the distances from particles[0] if they were already computed for another effect, otherwise NULL
+static double rebx_calculate_gr_potential_potential(struct reb_simulation* const sim, const double C2, const struct rebx_source_geometry* const geometry, double* const H){
     const struct reb_particle* const particles = sim->particles;
 	const int _N_real = sim->N - sim->N_var;
 	const double G = sim->G;
     const struct reb_particle source = particles[0];
 	const double mu = G*source.m;
     const double prefac = 3.*mu*mu/C2;
-    double H = 0.;
+    H[0] = 0.;
 
+    // Per-particle terms in parallel, then summed serially so the result doesn't depend on the number of threads
+#pragma omp parallel for schedule(static)
 	for (int i=1;i<_N_real;i++){
 		struct reb_particle pi = particles[i];
-        double dx = pi.x - source.x;
-        double dy = pi.y - source.y;
-        double dz = pi.z - source.z;
-        double r2 = dx*dx + dy*dy + dz*dz;
-        H -= prefac*pi.m/r2;
+        double r2;
+        if (geometry != NULL){
+            r2 = geometry->r2[i];
+        }
+        else{
+            double dx = pi.x - source.x;
+            double dy = pi.y - source.y;
+            double dz = pi.z - source.z;
+            r2 = dx*dx + dy*dy + dz*dz;
+        }
+        H[i] = -prefac*pi.m/r2;
     }		
 	
-    return H;
+    return rebx_compensated_sum(H, _N_real);
 }
 
 double rebx_gr_potential_potential(struct rebx_extras* const rebx, const struct rebx_force* const gr_potential){
@@ -119,5 +168,10 @@ double rebx_gr_potential_potential(struct rebx_extras* const rebx, const struct
         rebx_error(rebx, ""); // rebx_error gives meaningful err
         return 0;
     }
-    return rebx_calculate_gr_potential_potential(rebx->sim, C2);
+    struct reb_simulation* const sim = rebx->sim;
+    double* const H = rebx_get_workspace(rebx, (sim->N - sim->N_var)*sizeof(*H));
+    if (H == NULL){
+        return 0;
+    }
+    return rebx_calculate_gr_potential_potential(sim, C2, rebx_get_source_geometry(rebx, 0), H);
 }
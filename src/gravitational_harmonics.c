@@ -58,30 +58,66 @@
 #include <float.h>
 #include "rebound.h"
 #include "reboundx.h"
+#include "core.h"
+#include "rebxtools.h"
 
-static void rebx_calculate_J2_force(struct reb_simulation* const sim, struct reb_particle* const particles, const int N, const double J2, const double R_eq, const int source_index){
+// Independent per-particle terms go in w (6*N doubles) in a loop the compiler can vectorize. The back reactions on the source are then added in order
+REBX_KERNEL void rebx_calculate_J2_force_body(struct reb_particle* const particles, const int N, const double G, const double J2, const double R_eq, const int source_index, double* const w){
     const struct reb_particle source = particles[source_index];
-    const double G = sim->G;
+    double* const wx = w;
+    double* const wy = w + N;
+    double* const wz = w + 2*N;
+    double* const wprefac = w + 3*N;
+    double* const wfac = w + 4*N;
+#pragma omp simd
+    for (int i=0; i<N; i++){
+        const double dx = particles[i].x - source.x;
+        const double dy = particles[i].y - source.y;
+        const double dz = particles[i].z - source.z;
+        const double r2 = dx*dx + dy*dy + dz*dz;
+        const double r = sqrt(r2);
+        const double costheta2 = dz*dz/r2;
+        wx[i] = dx;
+        wy[i] = dy;
+        wz[i] = dz;
+        wprefac[i] = 3.*J2*R_eq*R_eq/r2/r2/r/2.;
+        wfac[i] = 5.*costheta2-1.;
+    }
     for (int i=0; i<N; i++){
         if(i == source_index){
             continue;
         }
-        const struct reb_particle p = particles[i];
-        const double dx = p.x - source.x;
-        const double dy = p.y - source.y;
-        const double dz = p.z - source.z;
+        const double prefac = wprefac[i];
+        const double fac = wfac[i];
+        const double m = particles[i].m;
+
+        particles[i].ax += G*source.m*prefac*fac*wx[i];
+        particles[i].ay += G*source.m*prefac*fac*wy[i];
+        particles[i].az += G*source.m*prefac*(fac-2.)*wz[i];
+        particles[source_index].ax -= G*m*prefac*fac*wx[i];
+        particles[source_index].ay -= G*m*prefac*fac*wy[i];
+        particles[source_index].az -= G*m*prefac*(fac-2.)*wz[i];
+    }
+}
+
+REBX_MULTIVERSION(rebx_calculate_J2_force, (struct reb_particle* const particles, const int N, const double G, const double J2, const double R_eq, const int source_index, double* const w), (particles, N, G, J2, R_eq, source_index, w))
+
+// Test particles don't act back on the source, so each one is independent
+static void rebx_calculate_J2_force_test_particles(struct reb_particle* const particles, const int N_massive, const int N, const double G, const double J2, const double R_eq, const int source_index){
+    const struct reb_particle source = particles[source_index];
+#pragma omp parallel for schedule(static)
+    for (int i=N_massive; i<N; i++){
+        const double dx = particles[i].x - source.x;
+        const double dy = particles[i].y - source.y;
+        const double dz = particles[i].z - source.z;
         const double r2 = dx*dx + dy*dy + dz*dz;
         const double r = sqrt(r2);
         const double costheta2 = dz*dz/r2;
         const double prefac = 3.*J2*R_eq*R_eq/r2/r2/r/2.;
         const double fac = 5.*costheta2-1.;
-
         particles[i].ax += G*source.m*prefac*fac*dx;
         particles[i].ay += G*source.m*prefac*fac*dy;
         particles[i].az += G*source.m*prefac*(fac-2.)*dz;
-        particles[source_index].ax -= G*p.m*prefac*fac*dx;
-        particles[source_index].ay -= G*p.m*prefac*fac*dy;
-        particles[source_index].az -= G*p.m*prefac*(fac-2.)*dz;
     }
 }
 
@@ -91,35 +127,80 @@ static void rebx_J2(struct rebx_extras* const rebx, struct reb_simulation* const
         if (J2 != NULL){
             const double* const R_eq = rebx_get_param(rebx, particles[i].ap, "R_eq");
             if (R_eq != NULL){
-                rebx_calculate_J2_force(sim, particles, N, *J2, *R_eq,i); 
+                int N_massive = rebx_get_N_massive(sim, N);
+                if (i >= N_massive){
+                    N_massive = N;
+                }
+                double* const w = rebx_get_workspace(rebx, 6*N_massive*sizeof(*w));
+                if (w == NULL){
+                    return;
+                }
+                rebx_calculate_J2_force(particles, N_massive, sim->G, *J2, *R_eq, i, w);
+                rebx_calculate_J2_force_test_particles(particles, N_massive, N, sim->G, *J2, *R_eq, i);
             }
         }
     }
 }
 
-static void rebx_calculate_J4_force(struct reb_simulation* const sim, struct reb_particle* const particles, const int N, const double J4, const double R_eq, const int source_index){
+// Same structure as the J2 kernel, with w holding 6*N doubles
+REBX_KERNEL void rebx_calculate_J4_force_body(struct reb_particle* const particles, const int N, const double G, const double J4, const double R_eq, const int source_index, double* const w){
     const struct reb_particle source = particles[source_index];
-    const double G = sim->G;
+    double* const wx = w;
+    double* const wy = w + N;
+    double* const wz = w + 2*N;
+    double* const wprefac = w + 3*N;
+    double* const wfac = w + 4*N;
+    double* const wcostheta2 = w + 5*N;
+#pragma omp simd
+    for (int i=0; i<N; i++){
+        const double dx = particles[i].x - source.x;
+        const double dy = particles[i].y - source.y;
+        const double dz = particles[i].z - source.z;
+        const double r2 = dx*dx + dy*dy + dz*dz;
+        const double r = sqrt(r2);
+        const double costheta2 = dz*dz/r2;
+        wx[i] = dx;
+        wy[i] = dy;
+        wz[i] = dz;
+        wprefac[i] = 5.*J4*R_eq*R_eq*R_eq*R_eq/r2/r2/r2/r/8.;
+        wfac[i] = 63.*costheta2*costheta2-42.*costheta2 + 3.;
+        wcostheta2[i] = costheta2;
+    }
     for (int i=0; i<N; i++){
         if(i == source_index){
             continue;
         }
-        const struct reb_particle p = particles[i];
-        const double dx = p.x - source.x;
-        const double dy = p.y - source.y;
-        const double dz = p.z - source.z;
+        const double prefac = wprefac[i];
+        const double fac = wfac[i];
+        const double costheta2 = wcostheta2[i];
+        const double m = particles[i].m;
+
+        particles[i].ax += G*source.m*prefac*fac*wx[i];
+        particles[i].ay += G*source.m*prefac*fac*wy[i];
+        particles[i].az += G*source.m*prefac*(fac+12.-28.*costheta2)*wz[i];
+        particles[source_index].ax -= G*m*prefac*fac*wx[i];
+        particles[source_index].ay -= G*m*prefac*fac*wy[i];
+        particles[source_index].az -= G*m*prefac*(fac+12.-28.*costheta2)*wz[i];
+    }
+}
+
+REBX_MULTIVERSION(rebx_calculate_J4_force, (struct reb_particle* const particles, const int N, const double G, const double J4, const double R_eq, const int source_index, double* const w), (particles, N, G, J4, R_eq, source_index, w))
+
+static void rebx_calculate_J4_force_test_particles(struct reb_particle* const particles, const int N_massive, const int N, const double G, const double J4, const double R_eq, const int source_index){
+    const struct reb_particle source = particles[source_index];
+#pragma omp parallel for schedule(static)
+    for (int i=N_massive; i<N; i++){
+        const double dx = particles[i].x - source.x;
+        const double dy = particles[i].y - source.y;
+        const double dz = particles[i].z - source.z;
         const double r2 = dx*dx + dy*dy + dz*dz;
         const double r = sqrt(r2);
         const double costheta2 = dz*dz/r2;
         const double prefac = 5.*J4*R_eq*R_eq*R_eq*R_eq/r2/r2/r2/r/8.;
         const double fac = 63.*costheta2*costheta2-42.*costheta2 + 3.;
-
         particles[i].ax += G*source.m*prefac*fac*dx;
         particles[i].ay += G*source.m*prefac*fac*dy;
         particles[i].az += G*source.m*prefac*(fac+12.-28.*costheta2)*dz;
-        particles[source_index].ax -= G*p.m*prefac*fac*dx;
-        particles[source_index].ay -= G*p.m*prefac*fac*dy;
-        particles[source_index].az -= G*p.m*prefac*(fac+12.-28.*costheta2)*dz;
     }
 }
 
@@ -129,7 +210,16 @@ static void rebx_J4(struct rebx_extras* const rebx, struct reb_simulation* const
         if (J4 != NULL){
             const double* const R_eq = rebx_get_param(rebx, particles[i].ap, "R_eq");
             if (R_eq != NULL){
-                rebx_calculate_J4_force(sim, particles, N, *J4, *R_eq,i); 
+                int N_massive = rebx_get_N_massive(sim, N);
+                if (i >= N_massive){
+                    N_massive = N;
+                }
+                double* const w = rebx_get_workspace(rebx, 6*N_massive*sizeof(*w));
+                if (w == NULL){
+                    return;
+                }
+                rebx_calculate_J4_force(particles, N_massive, sim->G, *J4, *R_eq, i, w);
+                rebx_calculate_J4_force_test_particles(particles, N_massive, N, sim->G, *J4, *R_eq, i);
             }
         }
     }
@@ -140,82 +230,89 @@ void rebx_gravitational_harmonics(struct reb_simulation* const sim, struct rebx_
     rebx_J4(sim->extras, sim, gh, particles, N);
 }
 
-static double rebx_calculate_J2_potential(struct reb_simulation* const sim, const double J2, const double R_eq, const int source_index){
+static double rebx_calculate_J2_potential(struct reb_simulation* const sim, const double J2, const double R_eq, const int source_index, const struct rebx_source_geometry* const geometry, double* const H){
     const struct reb_particle* const particles = sim->particles;
 	const int _N_real = sim->N - sim->N_var;
     const struct reb_particle source = particles[source_index];
     const double G = sim->G;
-    double H = 0.;
+#pragma omp parallel for schedule(static)
 	for (int i=0;i<_N_real;i++){
 		if(i == source_index){
+            H[i] = 0.;
             continue;
         }
         const struct reb_particle p = particles[i];
-        const double dx = p.x - source.x;
-        const double dy = p.y - source.y;
-        const double dz = p.z - source.z;
-        const double r2 = dx*dx + dy*dy + dz*dz;
+        double dz, r2;
+        if (geometry != NULL){
+            dz = geometry->dz[i];
+            r2 = geometry->r2[i];
+        }
+        else{
+            const double dx = p.x - source.x;
+            const double dy = p.y - source.y;
+            dz = p.z - source.z;
+            r2 = dx*dx + dy*dy + dz*dz;
+        }
         const double r = sqrt(r2);
         const double costheta2 = dz*dz/r2;
         const double prefac = G*p.m*source.m*R_eq*R_eq/r2/r*J2;
         const double P2 = 0.5*(3.*costheta2-1.);
-        H += prefac*P2;
+        H[i] = prefac*P2;
     }		
-    return H;
-}
-
-static double rebx_J2_potential(struct rebx_extras* const rebx, struct reb_simulation* const sim){
-    const int N_real = sim->N - sim->N_var;
-    struct reb_particle* const particles = sim->particles;
-    double Htot = 0.;
-    for (int i=0; i<N_real; i++){
-        const double* const J2 = rebx_get_param(rebx, particles[i].ap, "J2");
-        if (J2 != NULL){
-            const double* const R_eq = rebx_get_param(rebx, particles[i].ap, "R_eq");
-            if (R_eq != NULL){
-                Htot += rebx_calculate_J2_potential(sim, *J2, *R_eq, i);
-            }
-        }
-    }
-    return Htot;
+    return rebx_compensated_sum(H, _N_real);
 }
 
-static double rebx_calculate_J4_potential(struct reb_simulation* const sim, const double J4, const double R_eq, const int source_index){
+static double rebx_calculate_J4_potential(struct reb_simulation* const sim, const double J4, const double R_eq, const int source_index, const struct rebx_source_geometry* const geometry, double* const H){
     const struct reb_particle* const particles = sim->particles;
 	const int _N_real = sim->N - sim->N_var;
     const struct reb_particle source = particles[source_index];
     const double G = sim->G;
-    double H = 0.;
+#pragma omp parallel for schedule(static)
 	for (int i=0;i<_N_real;i++){
 		if(i == source_index){
+            H[i] = 0.;
             continue;
         }
         const struct reb_particle p = particles[i];
-        const double dx = p.x - source.x;
-        const double dy = p.y - source.y;
-        const double dz = p.z - source.z;
-        const double r2 = dx*dx + dy*dy + dz*dz;
+        double dz, r2;
+        if (geometry != NULL){
+            dz = geometry->dz[i];
+            r2 = geometry->r2[i];
+        }
+        else{
+            const double dx = p.x - source.x;
+            const double dy = p.y - source.y;
+            dz = p.z - source.z;
+            r2 = dx*dx + dy*dy + dz*dz;
+        }
         const double r = sqrt(r2);
         const double costheta2 = dz*dz/r2;
         const double prefac = G*p.m*source.m*R_eq*R_eq*R_eq*R_eq/r2/r2/r*J4;
         const double P4 = (35.*costheta2*costheta2 - 30.*costheta2+3.)/8.;
-
-        H += prefac*P4;
+        H[i] = prefac*P4;
     }		
-    return H;
+    return rebx_compensated_sum(H, _N_real);
 }
 
-static double rebx_J4_potential(struct rebx_extras* const rebx, struct reb_simulation* const sim){
+// Per-particle terms are computed in parallel into the rebx workspace and summed serially, so the result is independent of the number of threads
+static double rebx_harmonics_potential(struct rebx_extras* const rebx, struct reb_simulation* const sim, double* const H, double* const c){
     const int N_real = sim->N - sim->N_var;
     struct reb_particle* const particles = sim->particles;
     double Htot = 0.;
     for (int i=0; i<N_real; i++){
+        const double* const R_eq = rebx_get_param(rebx, particles[i].ap, "R_eq");
+        if (R_eq == NULL){
+            continue;
+        }
+        // distances from particle i, shared by its J2 and J4 terms and any other effect's potential about it
+        const struct rebx_source_geometry* const geometry = rebx_get_source_geometry(rebx, i);
+        const double* const J2 = rebx_get_param(rebx, particles[i].ap, "J2");
+        if (J2 != NULL){
+            rebx_neumaier_add(&Htot, c, rebx_calculate_J2_potential(sim, *J2, *R_eq, i, geometry, H));
+        }
         const double* const J4 = rebx_get_param(rebx, particles[i].ap, "J4");
         if (J4 != NULL){
-            const double* const R_eq = rebx_get_param(rebx, particles[i].ap, "R_eq");
-            if (R_eq != NULL){
-                Htot += rebx_calculate_J4_potential(sim, *J4, *R_eq, i);
-            }
+            rebx_neumaier_add(&Htot, c, rebx_calculate_J4_potential(sim, *J4, *R_eq, i, geometry, H));
         }
     }
     return Htot;
@@ -226,7 +323,12 @@ double rebx_gravitational_harmonics_potential(struct rebx_extras* const rebx){
         rebx_error(rebx, ""); // rebx_error gives meaningful err
         return 0;
     }
-    double H = rebx_J2_potential(rebx, rebx->sim);
-    H += rebx_J4_potential(rebx, rebx->sim);
-    return H;
+    struct reb_simulation* const sim = rebx->sim;
+    double* const H = rebx_get_workspace(rebx, (sim->N - sim->N_var)*sizeof(*H));
+    if (H == NULL){
+        return 0;
+    }
+    double c = 0.;
+    const double Htot = rebx_harmonics_potential(rebx, sim, H, &c);
+    return Htot + c;
 }
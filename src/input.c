@@ -61,6 +61,81 @@ void rebx_input_skip_binary_field(FILE* inf, long field_size){
 
 static int rebx_load_list(struct rebx_extras* rebx, enum rebx_binary_field_type expected_type, struct rebx_node** ap, FILE* inf, enum rebx_input_binary_messages* warnings);
 
+// Arrays have to come after NVALUES and match its length
+static double* rebx_read_interpolator_array(FILE* inf, const struct rebx_binary_field field, const int Nvalues, enum rebx_input_binary_messages* warnings){
+    if (Nvalues <= 0 || field.size != (long)(Nvalues*sizeof(double))){
+        *warnings |= REBX_INPUT_BINARY_ERROR_CORRUPT;
+        rebx_input_skip_binary_field(inf, field.size);
+        return NULL;
+    }
+    double* array = malloc(field.size);
+    if (array == NULL){
+        *warnings |= REBX_INPUT_BINARY_ERROR_NO_MEMORY;
+        rebx_input_skip_binary_field(inf, field.size);
+        return NULL;
+    }
+    if (!fread(array, field.size, 1, inf)){
+        *warnings |= REBX_INPUT_BINARY_ERROR_CORRUPT;
+        free(array);
+        return NULL;
+    }
+    return array;
+}
+
+// Reads the interpolator nested in the PARAM_VALUE field of an interpolator param
+static struct rebx_interpolator* rebx_read_interpolator(struct rebx_extras* rebx, FILE* inf, enum rebx_input_binary_messages* warnings){
+    struct rebx_interpolator* interp = calloc(1, sizeof(*interp));
+    if (interp == NULL){
+        *warnings |= REBX_INPUT_BINARY_ERROR_NO_MEMORY;
+        return NULL;
+    }
+    struct rebx_binary_field field;
+    int reading_fields = 1;
+    while (reading_fields){
+        if (!fread(&field, sizeof(field), 1, inf)){
+            *warnings |= REBX_INPUT_BINARY_ERROR_CORRUPT;
+            break;
+        }
+        switch (field.type){
+            CASE(INTERPOLATION,               &interp->interpolation);
+            CASE(NVALUES,                     &interp->Nvalues);
+            case REBX_BINARY_FIELD_TYPE_TIMES:
+                free(interp->times);
+                interp->times = rebx_read_interpolator_array(inf, field, interp->Nvalues, warnings);
+                break;
+            case REBX_BINARY_FIELD_TYPE_VALUES:
+                free(interp->values);
+                interp->values = rebx_read_interpolator_array(inf, field, interp->Nvalues, warnings);
+                break;
+            case REBX_BINARY_FIELD_TYPE_Y2:
+                free(interp->y2);
+                interp->y2 = rebx_read_interpolator_array(inf, field, interp->Nvalues, warnings);
+                break;
+            CASE(KLO,                         &interp->klo);
+            case REBX_BINARY_FIELD_TYPE_END:
+                reading_fields=0;
+                break;
+            default:
+            {
+                *warnings |= REBX_INPUT_BINARY_WARNING_FIELD_UNKNOWN;
+                rebx_input_skip_binary_field(inf, field.size);
+                break;
+            }
+        }
+    }
+    if (interp->Nvalues <= 0 || interp->times == NULL || interp->values == NULL || interp->klo < 0 || interp->klo >= interp->Nvalues){
+        *warnings |= REBX_INPUT_BINARY_WARNING_PARAM_VALUE_NULL;
+        rebx_free_interpolator(interp);
+        return NULL;
+    }
+    if (interp->interpolation == REBX_INTERPOLATION_SPLINE && interp->y2 == NULL){ // e.g. written without coefficients. Recompute them
+        struct rebx_interpolator* const rebuilt = rebx_create_interpolator(rebx, interp->Nvalues, interp->times, interp->values, interp->interpolation);
+        rebx_free_interpolator(interp);
+        return rebuilt;
+    }
+    return interp;
+}
+
 static struct rebx_param* rebx_read_param(struct rebx_extras* rebx, FILE* inf, enum rebx_input_binary_messages* warnings){
     
     struct rebx_param* param = malloc(sizeof(*param));
@@ -82,7 +157,23 @@ static struct rebx_param* rebx_read_param(struct rebx_extras* rebx, FILE* inf, e
         switch (field.type){
             CASE(PARAM_TYPE,                  &param->type);
             CASE_MALLOC(NAME,                 param->name);
-            CASE_MALLOC(PARAM_VALUE,          param->value);
+            case REBX_BINARY_FIELD_TYPE_PARAM_VALUE:
+            {
+                if (param->type == REBX_TYPE_INTERPOLATOR){ // PARAM_TYPE is always written before PARAM_VALUE
+                    param->value = rebx_read_interpolator(rebx, inf, warnings);
+                    break;
+                }
+                param->value = malloc(field.size);
+                if (param->value == NULL){
+                    *warnings |= REBX_INPUT_BINARY_ERROR_NO_MEMORY;
+                }
+                else if (!fread(param->value, field.size, 1, inf)){
+                    *warnings |= REBX_INPUT_BINARY_ERROR_CORRUPT;
+                    free(param->value);
+                    param->value = NULL;
+                }
+                break;
+            }
             case REBX_BINARY_FIELD_TYPE_END:
                 reading_fields=0;
                 break;
@@ -138,6 +229,10 @@ static int rebx_load_registered_param(struct rebx_extras* rebx, FILE* inf, enum
     if(param == NULL){
         return 0;
     }
+    if(rebx_registry_get_param(param->name) != NULL){ // built in, already in the static table
+        rebx_free_param(param);
+        return 1;
+    }
     
     int success = rebx_add_param(rebx, &rebx->registered_params, param);
     if(!success){
@@ -642,6 +737,48 @@ void rebx_init_extras_from_binary(struct rebx_extras* rebx, const char* const fi
     return;
 }
 
+// fmemopen is POSIX. Elsewhere, go through an anonymous temporary file
+static FILE* rebx_open_buffer(const char* const buffer, const size_t size){
+#if defined(_WIN32)
+    FILE* inf = tmpfile();
+    if (inf == NULL){
+        return NULL;
+    }
+    if (fwrite(buffer, 1, size, inf) != size){
+        fclose(inf);
+        return NULL;
+    }
+    rewind(inf);
+    return inf;
+#else
+    return fmemopen((void*)buffer, size, "rb");
+#endif
+}
+
+// Same as above, but reads from a binary already loaded into memory (e.g. cached by a SimulationArchive) so no file has to be reopened.
+// The binary is still parsed on every call.
+void rebx_init_extras_from_buffer(struct rebx_extras* rebx, const char* const buffer, const size_t size, enum rebx_input_binary_messages* warnings){
+    if (rebx->sim == NULL){
+        rebx_error(rebx, ""); // rebx_error gives meaningful err
+        return;
+    }
+    if (buffer == NULL || size == 0){
+        *warnings |= REBX_INPUT_BINARY_ERROR_NOFILE;
+        return;
+    }
+    FILE* inf = rebx_open_buffer(buffer, size);
+    if (!inf){
+        *warnings |= REBX_INPUT_BINARY_ERROR_NO_MEMORY;
+        return;
+    }
+    
+    rebx_input_read_header(inf, warnings);
+    rebx_load_snapshot(rebx, inf, warnings);
+    
+    fclose(inf);
+    return;
+}
+
 struct rebx_extras* rebx_create_extras_from_binary(struct reb_simulation* sim, const char* const filename){
     if (sim == NULL){
         fprintf(stderr, "REBOUNDx Error: Simulation pointer passed to rebx_create_extras_from_binary was NULL.\n");
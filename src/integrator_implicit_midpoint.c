@@ -29,6 +29,7 @@
 #include <float.h>
 #include "rebound.h"
 #include "reboundx.h"
+#include "core.h"
 
 static void avg_particles(struct reb_particle* const ps_avg, struct reb_particle* const ps1, struct reb_particle* const ps2, int N){
     for(int i=0; i<N; i++){
@@ -64,21 +65,21 @@ static int compare(struct reb_particle* ps1, struct reb_particle* ps2, int N){
 }
 
 void rebx_im_free_arrays(struct rebx_extras* rebx, struct rebx_force* force){
-    struct reb_particle* const ps_final = rebx_get_param(rebx, force->ap, "ps_final");
+    struct reb_particle* const ps_final = rebx_get_param(rebx, force->ap, "im_ps_final");
     free(ps_final);
-    struct reb_particle* const ps_prev = rebx_get_param(rebx, force->ap, "ps_prev");
+    struct reb_particle* const ps_prev = rebx_get_param(rebx, force->ap, "im_ps_prev");
     free(ps_prev);
-    struct reb_particle* const ps_avg = rebx_get_param(rebx, force->ap, "ps_avg");
+    struct reb_particle* const ps_avg = rebx_get_param(rebx, force->ap, "im_ps_avg");
     free(ps_avg);
 }
 
 static struct reb_particle* setup(struct rebx_extras* rebx, struct rebx_force* force, const int N){
     rebx_set_param_pointer(rebx, &force->ap, "free_arrays", rebx_im_free_arrays);
-    struct reb_particle* const ps_final = malloc(N*sizeof(*ps_final));
+    struct reb_particle* const ps_final = rebx_malloc(rebx, N*sizeof(*ps_final));
     rebx_set_param_pointer(rebx, &force->ap, "im_ps_final", ps_final);
-    struct reb_particle* const ps_prev = malloc(N*sizeof(*ps_prev));
+    struct reb_particle* const ps_prev = rebx_malloc(rebx, N*sizeof(*ps_prev));
     rebx_set_param_pointer(rebx, &force->ap, "im_ps_prev", ps_prev);
-    struct reb_particle* const ps_avg = malloc(N*sizeof(*ps_avg));
+    struct reb_particle* const ps_avg = rebx_malloc(rebx, N*sizeof(*ps_avg));
     rebx_set_param_pointer(rebx, &force->ap, "im_ps_avg", ps_avg);
     
     return ps_final;
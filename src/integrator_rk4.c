@@ -43,8 +43,8 @@ void rebx_integrator_rk4_integrate(struct reb_simulation* const sim, const doubl
     rebx_reset_accelerations(sim->particles, N);
     struct reb_particle* k2 = rebx_get_param(rebx, force->ap, "rk4_k2");
     if (k2 == NULL){
-        k2 = malloc(N*sizeof(*k2));
-        struct reb_particle* k3 = malloc(N*sizeof(*k3));
+        k2 = rebx_malloc(rebx, N*sizeof(*k2));
+        struct reb_particle* k3 = rebx_malloc(rebx, N*sizeof(*k3));
         rebx_set_param_pointer(rebx, &force->ap, "rk4_k2", k2);
         rebx_set_param_pointer(rebx, &force->ap, "rk4_k3", k3);
         rebx_set_param_pointer(rebx, &force->ap, "free_arrays", rebx_rk4_free_arrays);
@@ -121,6 +121,64 @@ static double rebx_splint(struct rebx_extras* const rebx, const double* xa, cons
     return a*ya[*klo] + b*ya[*klo+1] + ((a*a*a-a)*y2a[*klo] + (b*b*b-b)*y2a[*klo+1])*(h*h)/6.;
 }
 
+/**
+ * Returns klo in [0, n-2] such that xa[klo] <= x < xa[klo+1] by bisection (klo is clamped to the
+ * first or last interval for x outside the table, which then extrapolates that interval's cubic).
+ * Adapted from "Numerical Recipes for C," 2nd Ed., §3.3, p. 116
+ */
+static int rebx_splint_bisect(const double* xa, const int n, const double x){
+    int klo = 0;
+    int khi = n-1;
+    while (khi-klo > 1){
+        const int k = (khi+klo) >> 1;
+        if (xa[k] > x){
+            khi = k;
+        }
+        else{
+            klo = k;
+        }
+    }
+    return klo;
+}
+
+/**
+ * Evaluates the spline at N times x[0..(N-1)] into y[0..(N-1)]. If x is sorted (in either direction) the bracket
+ * is found with a single sweep through the table, otherwise by bisection for each time. Returns the last bracket.
+ */
+static int rebx_splint_array(struct rebx_extras* const rebx, const double* xa, const double* ya, const double* y2a, const int n, const double* x, double* y, const int N) {
+    int ascending = 1;
+    int descending = 1;
+    for (int i=1; i<N; i++){
+        ascending &= (x[i] >= x[i-1]);
+        descending &= (x[i] <= x[i-1]);
+    }
+    int klo = (N > 0) ? rebx_splint_bisect(xa, n, x[0]) : 0;
+    for (int i=0; i<N; i++){
+        if (ascending){
+            while (klo < n-2 && xa[klo+1] <= x[i]){
+                klo++;
+            }
+        }
+        else if (descending){
+            while (klo > 0 && xa[klo] > x[i]){
+                klo--;
+            }
+        }
+        else{
+            klo = rebx_splint_bisect(xa, n, x[i]);
+        }
+        const double h = xa[klo+1] - xa[klo];
+        if (h == 0.0){ // xa's must be distinct
+            rebx_error(rebx, "REBOUNDx Error: Times passed to interpolator must be distinct.\n");
+            return klo;
+        }
+        const double a = (xa[klo+1]-x[i]) / h;
+        const double b = (x[i] - xa[klo]) / h;
+        y[i] = a*ya[klo] + b*ya[klo+1] + ((a*a*a-a)*y2a[klo] + (b*b*b-b)*y2a[klo+1])*(h*h)/6.;
+    }
+    return klo;
+}
+
 struct rebx_interpolator* rebx_create_interpolator(struct rebx_extras* const rebx, const int Nvalues, const double* times, const double* values, enum rebx_interpolation_type interpolation){
     struct rebx_interpolator* interp = rebx_malloc(rebx, sizeof(*interp));
     rebx_init_interpolator(rebx, interp, Nvalues, times, values, interpolation);
@@ -136,6 +194,7 @@ void rebx_init_interpolator(struct rebx_extras* const rebx, struct rebx_interpol
     memcpy(interp->values, values, Nvalues*sizeof(*interp->values));
     interp->y2 = NULL;
     interp->klo = 0;
+    interp->table = NULL;
     if (interpolation == REBX_INTERPOLATION_SPLINE){
         interp->y2 = rebx_malloc(rebx, Nvalues*sizeof(*interp->y2));
         rebx_spline(interp->times, interp->values, interp->Nvalues, interp->y2);
@@ -143,7 +202,107 @@ void rebx_init_interpolator(struct rebx_extras* const rebx, struct rebx_interpol
     return;
 }
 
+// Table reference counts can be updated from simulations running in different threads
+static int rebx_table_refcount_add(struct rebx_interpolator_table* const table, const int delta){
+#if defined(__GNUC__)
+    return __atomic_add_fetch(&table->refcount, delta, __ATOMIC_ACQ_REL);
+#else
+    table->refcount += delta;
+    return table->refcount;
+#endif
+}
+
+struct rebx_interpolator_table* rebx_create_interpolator_table(const int Nvalues, const double* times, const double* values, enum rebx_interpolation_type interpolation){
+    struct rebx_interpolator_table* const table = malloc(sizeof(*table));
+    if (table == NULL){
+        return NULL;
+    }
+    const size_t size = Nvalues*sizeof(double);
+    table->refcount = 1;
+    table->interpolation = interpolation;
+    table->Nvalues = Nvalues;
+    table->times = malloc(size);
+    table->values = malloc(size);
+    table->y2 = (interpolation == REBX_INTERPOLATION_SPLINE) ? malloc(size) : NULL;
+    if (table->times == NULL || table->values == NULL || (interpolation == REBX_INTERPOLATION_SPLINE && table->y2 == NULL)){
+        free(table->times);
+        free(table->values);
+        free(table->y2);
+        free(table);
+        return NULL;
+    }
+    memcpy(table->times, times, size);
+    memcpy(table->values, values, size);
+    if (table->y2 != NULL){
+        rebx_spline(table->times, table->values, Nvalues, table->y2);
+    }
+    return table;
+}
+
+void rebx_free_interpolator_table(struct rebx_interpolator_table* const table){
+    if (table == NULL || rebx_table_refcount_add(table, -1) > 0){
+        return;
+    }
+    free(table->times);
+    free(table->values);
+    free(table->y2);
+    free(table);
+}
+
+void rebx_init_interpolator_from_table(struct rebx_interpolator* const interp, struct rebx_interpolator_table* const table){
+    rebx_table_refcount_add(table, 1);
+    interp->interpolation = table->interpolation;
+    interp->Nvalues = table->Nvalues;
+    interp->times = table->times;
+    interp->values = table->values;
+    interp->y2 = table->y2;
+    interp->klo = 0;
+    interp->table = table;
+}
+
+struct rebx_interpolator* rebx_create_interpolator_from_table(struct rebx_extras* const rebx, struct rebx_interpolator_table* const table){
+    struct rebx_interpolator* const interp = rebx_malloc(rebx, sizeof(*interp));
+    if (interp == NULL){
+        return NULL;
+    }
+    rebx_init_interpolator_from_table(interp, table);
+    return interp;
+}
+
+struct rebx_interpolator* rebx_copy_interpolator(struct rebx_extras* const rebx, const struct rebx_interpolator* const interpolator){
+    if (interpolator->table != NULL){
+        struct rebx_interpolator* const copy = rebx_create_interpolator_from_table(rebx, interpolator->table);
+        if (copy != NULL){
+            copy->klo = interpolator->klo;
+        }
+        return copy;
+    }
+    struct rebx_interpolator* const copy = rebx_malloc(rebx, sizeof(*copy));
+    if (copy == NULL){
+        return NULL;
+    }
+    const size_t size = interpolator->Nvalues*sizeof(double);
+    *copy = *interpolator;
+    copy->times = rebx_malloc(rebx, size);
+    copy->values = rebx_malloc(rebx, size);
+    copy->y2 = (interpolator->y2 == NULL) ? NULL : rebx_malloc(rebx, size);
+    if (copy->times == NULL || copy->values == NULL || (interpolator->y2 != NULL && copy->y2 == NULL)){
+        rebx_free_interpolator(copy);
+        return NULL;
+    }
+    memcpy(copy->times, interpolator->times, size);
+    memcpy(copy->values, interpolator->values, size);
+    if (copy->y2 != NULL){
+        memcpy(copy->y2, interpolator->y2, size);
+    }
+    return copy;
+}
+
 void rebx_free_interpolator_pointers(struct rebx_interpolator* const interpolator){
+    if (interpolator->table != NULL){
+        rebx_free_interpolator_table(interpolator->table);
+        return;
+    }
     free(interpolator->times); 
     free(interpolator->values);
     if (interpolator->y2 != NULL){
@@ -176,3 +335,30 @@ double rebx_interpolate(struct rebx_extras* const rebx, struct rebx_interpolator
         }
     }
 }
+
+void rebx_interpolate_array(struct rebx_extras* const rebx, struct rebx_interpolator* const interpolator, const double* const times, double* const values, const int N){
+    switch (interpolator->interpolation){
+        case REBX_INTERPOLATION_NONE:
+        {
+            for (int i=0; i<N; i++){
+                values[i] = 0; // UPDATE
+            }
+            return;
+        }
+        case REBX_INTERPOLATION_SPLINE:
+        {
+            if (interpolator->Nvalues < 2){
+                rebx_error(rebx, "REBOUNDx Error: Need at least two values to interpolate.\n");
+                return;
+            }
+            // Leave the cursor where the sweep ended so later calls to rebx_interpolate continue from there
+            interpolator->klo = rebx_splint_array(rebx, interpolator->times, interpolator->values, interpolator->y2, interpolator->Nvalues, times, values, N);
+            return;
+        }
+        default:
+        {
+            rebx_error(rebx, "REBOUNDx Error: Interpolation option not supported\n");
+            return;
+        }
+    }
+}
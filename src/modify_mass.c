@@ -37,10 +37,23 @@
  * 
  * This adds exponential mass growth/loss to individual particles every timestep.
  * Set particles' ``tau_mass`` parameter to a negative value for mass loss, positive for mass growth.
+ * By default masses are updated to first order, m -> m*(1 + dt/tau_mass). Set the operator's ``mm_exact`` parameter to 1 to update them exactly, m -> m*exp(dt/tau_mass).
+ * The simulation is then shifted back to the center of mass frame.
+ * 
+ * The particles with ``tau_mass`` set are gathered into an index list that is only rebuilt when a particle has a parameter added or particles are added or removed,
+ * so each step only touches the evolving particles when updating masses. The shift back to the center of mass frame is likewise built from the changed
+ * particles only, assuming the simulation was in the center of mass frame after the previous step. A full reb_move_to_com is done instead when the list is
+ * rebuilt, when the total mass was changed by something other than this operator, or when ``mm_full_com`` is set. Set ``mm_full_com`` if other effects
+ * move the center of mass (e.g., forces without back reactions), since the incremental shift doesn't see those changes.
  * 
  * **Effect Parameters**
  * 
- * *None*
+ * ============================ =========== =======================================================
+ * Name (C type)                Required    Description
+ * ============================ =========== =======================================================
+ * mm_exact (int)               No          Set to 1 to update masses exactly rather than to first order (default 0)
+ * mm_full_com (int)            No          Set to 1 to recompute the full center of mass every step (default 0)
+ * ============================ =========== =======================================================
  * 
  * **Particle Parameters**
  * 
@@ -57,18 +70,159 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
 #include "rebound.h"
 #include "reboundx.h"
+#include "rebxtools.h"
+#include "core.h"
 
-void rebx_modify_mass(struct reb_simulation* const sim, struct rebx_operator* const operator, const double dt){
-    const int _N_real = sim->N - sim->N_var;
-	for(int i=0; i<_N_real; i++){
-		struct reb_particle* const p = &sim->particles[i];
-        const double* const tau_mass = rebx_get_param(sim->extras, p->ap, "tau_mass");
+// Dense list of the particles with tau_mass set
+struct rebx_mm_list{
+    int N;                      // number of particles list was built for
+    struct rebx_node** aps;     // particles' param lists the list was built from (change when a param is added)
+    int Nidx;
+    int* idx;
+    const double** tau;         // tau_mass params, read every step so changed values take effect
+    double* factor;             // exp(dt/tau_mass) for the current step (mm_exact)
+    double M;                   // total mass after the last step, to detect mass changes by anything else
+};
+
+void rebx_modify_mass_free_arrays(struct rebx_extras* rebx, struct rebx_operator* operator){
+    struct rebx_mm_list* const list = rebx_get_param(rebx, operator->ap, "mm_list");
+    if (list != NULL){
+        free(list->aps);
+        free(list->idx);
+        free(list->tau);
+        free(list->factor);
+        free(list);
+        rebx_set_param_pointer(rebx, &operator->ap, "mm_list", NULL);
+    }
+}
+
+// The list is valid if no particle had a param added and particles weren't added or removed. Also sums the masses into M.
+static int rebx_mm_list_valid(const struct rebx_mm_list* const list, const struct reb_particle* const particles, const int N, double* const M){
+    *M = 0.;
+    if (list->N != N){
+        return 0;
+    }
+    for (int i=0; i<N; i++){
+        if (list->aps[i] != particles[i].ap){
+            return 0;
+        }
+        *M += particles[i].m;
+    }
+    return 1;
+}
+
+// Returns the list, or NULL if memory couldn't be allocated. Sets rebuilt to 1 if the list had to be rebuilt, and M to the total mass if it didn't.
+static struct rebx_mm_list* rebx_mm_get_list(struct reb_simulation* const sim, struct rebx_operator* const operator, const int N, int* const rebuilt, double* const M){
+    struct rebx_extras* const rebx = sim->extras;
+    struct rebx_mm_list* list = rebx_get_param(rebx, operator->ap, "mm_list");
+    *rebuilt = 1;
+    if (list == NULL){
+        list = rebx_malloc(rebx, sizeof(*list));
+        if (list == NULL){
+            return NULL;
+        }
+        memset(list, 0, sizeof(*list));
+        rebx_set_param_pointer(rebx, &operator->ap, "mm_list", list);
+        rebx_set_param_pointer(rebx, &operator->ap, "free_arrays", rebx_modify_mass_free_arrays);
+    }
+    else if (rebx_mm_list_valid(list, sim->particles, N, M)){
+        *rebuilt = 0;
+        return list;
+    }
+
+    free(list->aps);
+    free(list->idx);
+    free(list->tau);
+    free(list->factor);
+    list->N = 0;
+    list->aps = rebx_malloc(rebx, N*sizeof(*list->aps));
+    list->idx = rebx_malloc(rebx, N*sizeof(*list->idx));
+    list->tau = rebx_malloc(rebx, N*sizeof(*list->tau));
+    list->factor = rebx_malloc(rebx, N*sizeof(*list->factor));
+    if (N > 0 && (list->aps == NULL || list->idx == NULL || list->tau == NULL || list->factor == NULL)){ // rebx_malloc reported the error
+        return NULL;
+    }
+    list->Nidx = 0;
+	for(int i=0; i<N; i++){
+        list->aps[i] = sim->particles[i].ap;
+        const double* const tau_mass = rebx_get_param(rebx, sim->particles[i].ap, "tau_mass");
         if (tau_mass != NULL){
-		    p->m += p->m*dt/(*tau_mass);
+            list->idx[list->Nidx] = i;
+            list->tau[list->Nidx] = tau_mass;
+            list->Nidx++;
         }
 	}
-    reb_move_to_com(sim);
+    list->N = N;
+    return list;
 }
 
+void rebx_modify_mass(struct reb_simulation* const sim, struct rebx_operator* const operator, const double dt){
+    const int _N_real = sim->N - sim->N_var;
+    struct reb_particle* const particles = sim->particles;
+    int rebuilt;
+    double M = 0.;
+    struct rebx_mm_list* const list = rebx_mm_get_list(sim, operator, _N_real, &rebuilt, &M);
+    if (list == NULL){
+        return;
+    }
+    const int Nidx = list->Nidx;
+    const int* const idx = list->idx;
+    const double* const* const tau = list->tau;
+
+    const int* const mm_exact = rebx_get_param(sim->extras, operator->ap, "mm_exact");
+    const int exact = (mm_exact != NULL && *mm_exact);
+    if (exact){
+        double* const factor = list->factor;
+#pragma omp simd
+        for (int k=0; k<Nidx; k++){
+            factor[k] = exp(dt/(*tau[k]));
+        }
+    }
+
+    const int* const mm_full_com = rebx_get_param(sim->extras, operator->ap, "mm_full_com");
+    if (rebuilt || M != list->M || (mm_full_com != NULL && *mm_full_com)){
+        // Fallback: the simulation may not be in the center of mass frame, so recenter fully
+        for (int k=0; k<Nidx; k++){
+            struct reb_particle* const p = &particles[idx[k]];
+            if (exact){
+                p->m *= list->factor[k];
+            }
+            else{
+                p->m += p->m*dt/(*tau[k]);
+            }
+        }
+        reb_move_to_com(sim);
+    }
+    else{
+        // Simulation is in the center of mass frame, so start from a center of mass at the origin with the old total mass and swap in each changed particle
+        struct reb_particle com = {0};
+        com.m = M;
+        for (int k=0; k<Nidx; k++){
+            struct reb_particle* const p = &particles[idx[k]];
+            rebxtools_update_com_without_particle(&com, p);
+            if (exact){
+                p->m *= list->factor[k];
+            }
+            else{
+                p->m += p->m*dt/(*tau[k]);
+            }
+            rebxtools_update_com_with_particle(&com, p);
+        }
+        for (int i=0; i<_N_real; i++){
+            particles[i].x -= com.x;
+            particles[i].y -= com.y;
+            particles[i].z -= com.z;
+            particles[i].vx -= com.vx;
+            particles[i].vy -= com.vy;
+            particles[i].vz -= com.vz;
+        }
+    }
+
+    list->M = 0.;
+    for (int i=0; i<_N_real; i++){
+        list->M += particles[i].m;
+    }
+}
@@ -38,6 +38,12 @@
  * 
  * This updates particles' positions and velocities between timesteps to achieve the desired changes to the osculating orbital elements (exponential growth/decay for a, e, inc, linear progression/regression for Omega/omega.
  * This nicely isolates changes to particular osculating elements, making it easier to interpret the resulting dynamics.  
+ * The changes are the exact solutions over the step, e.g., a -> a*exp(dt/tau_a), so the operator can be applied once per (large) timestep of a symplectic integrator,
+ * rather than evaluating the equivalent velocity-dependent forces of modify_orbits_forces or exponential_migration at every substep.
+ * With the coupling parameter p, the semimajor axis additionally changes by a factor ((1-e_0^2)/(1-e^2))^p, which conserves the angular momentum for p=1.
+ * Particles with both tau_afin and afin set have their semimajor axes relaxed toward afin, a -> afin - (afin - a)*exp(-dt/tau_afin).
+ * For an orbit starting at a_0 at t=0 this gives the exponential_migration prescription a(t) = afin - (afin - a_0)*exp(-t/tau_afin).
+ * These are separate from exponential_migration's em_* parameters, so a particle can't be migrated by both effects by accident.
  * One can also adjust the coupling parameter `p` between eccentricity and semimajor axis evolution, as well as whether the damping is done on Jacobi, barycentric or heliocentric elements.
  * Since this method changes osculating (i.e., two-body) elements, it can give unphysical results in highly perturbed systems.
  * 
@@ -68,6 +74,8 @@
  * tau_inc (double)             No          Inclination axis exponential growth/damping timescale
  * tau_Omega (double)           No          Period of linear nodal precession/regression
  * tau_omega (double)           No          Period of linear apsidal precession/regression
+ * tau_afin (double)            No          Timescale for the semimajor axis to relax toward afin
+ * afin (double)                No          Final semimajor axis (only used with tau_afin)
  * ============================ =========== ==================================================================
  * 
  */
@@ -108,13 +116,13 @@ static struct reb_particle rebx_calculate_modify_orbits_direct(struct reb_simula
         if ((dedge!=NULL)&(hedge!=NULL)){
             invtau_a *= rebx_calculate_planet_trap(a0, *dedge, *hedge);
         }
-    	o.a += a0*dt*invtau_a;
+    	o.a = a0*exp(dt*invtau_a);
 	}
 	if(tau_e != NULL){
-    	o.e += e0*dt/(*tau_e);
+    	o.e = e0*exp(dt/(*tau_e));
 	}
 	if(tau_inc != NULL){
-    	o.inc += inc0*dt/(*tau_inc);
+    	o.inc = inc0*exp(dt/(*tau_inc));
 	}
 	if(tau_omega != NULL){
     	o.omega += 2.*M_PI*dt/(*tau_omega);
@@ -126,9 +134,15 @@ static struct reb_particle rebx_calculate_modify_orbits_direct(struct reb_simula
     if(tau_e != NULL){
         const double* const p_param = rebx_get_param(sim->extras, operator->ap, "p");
         if(p_param != NULL){
-			o.a += 2.*a0*e0*e0*(*p_param)*dt/(*tau_e); // Coupling term between e and a
+			o.a *= pow((1.-e0*e0)/(1.-o.e*o.e), *p_param); // Coupling term between e and a. da/a = p*d(-ln(1-e^2))
 		}
     }
+
+    const double* const tau_afin = rebx_get_param(rebx, p->ap, "tau_afin");
+    const double* const afin = rebx_get_param(rebx, p->ap, "afin");
+    if(tau_afin != NULL && afin != NULL){
+        o.a = *afin - (*afin - o.a)*exp(-dt/(*tau_afin));
+    }
     return reb_tools_orbit_to_particle(sim->G, *primary, p->m, o.a, o.e, o.inc, o.Omega, o.omega, o.f);
 }
 
@@ -23,6 +23,7 @@
  *
  */
 
+#include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include "reboundx.h"
@@ -131,8 +132,35 @@ static void rebx_write_force_param(struct rebx_extras* rebx, struct rebx_param*
     REBX_END_OBJECT_FIELD(force_param);
 }
 
+// Interpolators are written as a nested object in the PARAM_VALUE field, including the spline coefficients so they don't need to be recomputed on load
+static void rebx_write_interpolator_param(struct rebx_extras* rebx, struct rebx_param* param, FILE* of){
+    const struct rebx_interpolator* const interp = param->value;
+    const size_t size = interp->Nvalues*sizeof(double);
+    REBX_START_OBJECT_FIELD(interpolator_param, PARAM);
+    REBX_WRITE_DATA_FIELD(PARAM_TYPE, &param->type,     sizeof(param->type));
+    REBX_WRITE_DATA_FIELD(NAME,       param->name,      strlen(param->name) + 1);
+    REBX_START_OBJECT_FIELD(interpolator, PARAM_VALUE);
+    REBX_WRITE_DATA_FIELD(INTERPOLATION,    &interp->interpolation, sizeof(interp->interpolation));
+    REBX_WRITE_DATA_FIELD(NVALUES,          &interp->Nvalues,       sizeof(interp->Nvalues));
+    REBX_WRITE_DATA_FIELD(TIMES,            interp->times,          size);
+    REBX_WRITE_DATA_FIELD(VALUES,           interp->values,         size);
+    if (interp->y2 != NULL){
+        REBX_WRITE_DATA_FIELD(Y2,           interp->y2,             size);
+    }
+    REBX_WRITE_DATA_FIELD(KLO,              &interp->klo,           sizeof(interp->klo));
+    REBX_END_OBJECT_FIELD(interpolator);
+    REBX_END_OBJECT_FIELD(interpolator_param);
+}
+
 static void rebx_write_param(struct rebx_extras* rebx, struct rebx_param* param, FILE* of){
-    if (param->type == REBX_TYPE_POINTER){ // Don't write pointers because we won't know how to load them when we read binary. Need to add type to store in binaries.
+    if (param->type == REBX_TYPE_POINTER){ // Don't write pointers because we won't know how to load them when we read binary. Caches (e.g. integrator workspaces) are rebuilt from the other params on the first step after loading.
+        return;
+    }
+    
+    if (param->type == REBX_TYPE_INTERPOLATOR){
+        if (param->value != NULL){
+            rebx_write_interpolator_param(rebx, param, of);
+        }
         return;
     }
     
@@ -154,6 +182,16 @@ static void rebx_write_registered_param(struct rebx_extras* rebx, struct rebx_pa
     REBX_END_OBJECT_FIELD(registered_param);
 }
 
+// Built-in params aren't in rebx->registered_params, but we still write them so older versions can read the binary
+static void rebx_write_builtin_params(struct rebx_extras* rebx, FILE* of){
+    const int N = rebx_registry_N_params();
+    for (int i=0; i<N; i++){
+        const struct rebx_registry_param* const entry = rebx_registry_param_at(i);
+        struct rebx_param param = {.name = (char*)entry->name, .type = entry->type, .value = NULL};
+        rebx_write_registered_param(rebx, &param, of);
+    }
+}
+
 static void rebx_write_force(struct rebx_extras* rebx, struct rebx_force* force, FILE* of){
     REBX_START_OBJECT_FIELD(force, FORCE);
     // must write name first so that force can be loaded on read
@@ -193,7 +231,10 @@ static void rebx_write_particle(struct rebx_extras* rebx, struct reb_particle* p
 
 static void rebx_write_rebx(struct rebx_extras* rebx, FILE* of){
     REBX_START_OBJECT_FIELD(rebx_structure, REBX_STRUCTURE);
-    REBX_WRITE_LIST_FIELD(REGISTERED_PARAMETERS, REGISTERED_PARAM, rebx->registered_params);
+    REBX_START_OBJECT_FIELD(registered_params, REGISTERED_PARAMETERS);
+    rebx_write_builtin_params(rebx, of);
+    rebx_write_list(rebx, REBX_BINARY_FIELD_TYPE_REGISTERED_PARAM, rebx->registered_params, of);
+    REBX_END_OBJECT_FIELD(registered_params);
     REBX_WRITE_LIST_FIELD(ALLOCATED_FORCES, FORCE, rebx->allocated_forces);
     REBX_WRITE_LIST_FIELD(ALLOCATED_OPERATORS, OPERATOR, rebx->allocated_operators);
     REBX_WRITE_LIST_FIELD(ADDITIONAL_FORCES, ADDITIONAL_FORCE, rebx->additional_forces);
@@ -265,15 +306,7 @@ static void rebx_write_snapshot(struct rebx_extras* rebx, FILE* of){
     REBX_END_OBJECT_FIELD(snapshot);
 }
 
-void rebx_output_binary(struct rebx_extras* rebx, char* filename){
-    FILE* of = fopen(filename,"wb");
-    if (of==NULL){
-        rebx_error(rebx, "REBOUNDx error: Can not open file passed to rebx_output_binary.");
-    }
-    if (rebx->sim == NULL){
-        rebx_error(rebx, ""); // rebx_error gives meaningful err
-        return;
-    }
+static void rebx_write_binary(struct rebx_extras* rebx, FILE* of){
     // Write header.
     const char str[] = "REBOUNDx Binary File. Version: ";
     char zero = '\0';
@@ -285,5 +318,61 @@ void rebx_output_binary(struct rebx_extras* rebx, char* filename){
     fwrite(&zero,sizeof(char),1,of);
 
     rebx_write_snapshot(rebx, of);
+}
+
+void rebx_output_binary(struct rebx_extras* rebx, char* filename){
+    if (rebx->sim == NULL){
+        rebx_error(rebx, ""); // rebx_error gives meaningful err
+        return;
+    }
+    FILE* of = fopen(filename,"wb");
+    if (of==NULL){
+        rebx_error(rebx, "REBOUNDx error: Can not open file passed to rebx_output_binary.");
+        return;
+    }
+    rebx_write_binary(rebx, of);
     fclose(of);
 }
+
+// Same as above, but writes into a newly allocated memory buffer (e.g. for pickling) instead of a file
+void rebx_output_binary_to_stream(struct rebx_extras* rebx, char** bufp, size_t* sizep){
+    *bufp = NULL;
+    *sizep = 0;
+    if (rebx->sim == NULL){
+        rebx_error(rebx, ""); // rebx_error gives meaningful err
+        return;
+    }
+#if defined(_WIN32)
+    // open_memstream is POSIX. Elsewhere, go through an anonymous temporary file (as rebx_open_buffer in input.c)
+    FILE* of = tmpfile();
+    if (of==NULL){
+        rebx_error(rebx, "REBOUNDx error: Could not open a temporary file in rebx_output_binary_to_stream.");
+        return;
+    }
+    rebx_write_binary(rebx, of);
+    const long size = ftell(of);
+    char* const buf = (size > 0) ? malloc(size) : NULL;
+    rewind(of);
+    if (buf == NULL || fread(buf, 1, size, of) != (size_t)size){
+        free(buf);
+        fclose(of);
+        rebx_error(rebx, "REBOUNDx error: Could not allocate memory in rebx_output_binary_to_stream.");
+        return;
+    }
+    fclose(of);
+    *bufp = buf;
+    *sizep = size;
+#else
+    FILE* of = open_memstream(bufp, sizep);
+    if (of==NULL){
+        rebx_error(rebx, "REBOUNDx error: Could not allocate memory in rebx_output_binary_to_stream.");
+        return;
+    }
+    rebx_write_binary(rebx, of);
+    fclose(of); // sets *bufp and *sizep
+#endif
+}
+
+void rebx_output_free_stream(char* buf){
+    free(buf);
+}
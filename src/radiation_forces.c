@@ -65,17 +65,15 @@
 #include <math.h>
 #include <stdlib.h>
 #include "reboundx.h"
+#include "core.h"
 
-static void rebx_calculate_radiation_forces(struct rebx_extras* const rebx, struct reb_simulation* const sim, const double c, const int source_index, struct reb_particle* const particles, const int N){
+// beta[i] is 0 for particles without beta set, which don't feel radiation forces
+REBX_KERNEL void rebx_calculate_radiation_forces_kernel_body(const double* const beta, const double mu, const double c, const int source_index, struct reb_particle* const particles, const int N){
     const struct reb_particle source = particles[source_index];
-    const double mu = sim->G*source.m;
 
     for (int i=0;i<N;i++){
         
-        if(i == source_index) continue;
-        
-        const double* beta = rebx_get_param(rebx, particles[i].ap, "beta");
-        if(beta == NULL) continue; // only particles with beta set feel radiation forces
+        if(i == source_index || beta[i] == 0.) continue;
         
         const struct reb_particle p = particles[i];
         const double dx = p.x - source.x; 
@@ -87,7 +85,7 @@ static void rebx_calculate_radiation_forces(struct rebx_extras* const rebx, stru
         const double dvy = p.vy - source.vy;
         const double dvz = p.vz - source.vz;
         const double rdot = (dx*dvx + dy*dvy + dz*dvz)/dr; // radial velocity
-        const double a_rad = *beta*mu/(dr*dr);
+        const double a_rad = beta[i]*mu/(dr*dr);
 
         // Equation (5) of Burns, Lamy & Soter (1979)
 
@@ -97,6 +95,20 @@ static void rebx_calculate_radiation_forces(struct rebx_extras* const rebx, stru
 	}
 }
 
+REBX_MULTIVERSION(rebx_calculate_radiation_forces_kernel, (const double* const beta, const double mu, const double c, const int source_index, struct reb_particle* const particles, const int N), (beta, mu, c, source_index, particles, N))
+
+static void rebx_calculate_radiation_forces(struct rebx_extras* const rebx, struct reb_simulation* const sim, const double c, const int source_index, struct reb_particle* const particles, const int N){
+    double* const beta = rebx_get_workspace(rebx, N*sizeof(*beta));
+    if (beta == NULL){
+        return;
+    }
+    for (int i=0; i<N; i++){
+        const double* const b = rebx_get_param(rebx, particles[i].ap, "beta");
+        beta[i] = (b == NULL) ? 0. : *b;
+    }
+    rebx_calculate_radiation_forces_kernel(beta, sim->G*particles[source_index].m, c, source_index, particles, N);
+}
+
 void rebx_radiation_forces(struct reb_simulation* const sim, struct rebx_force* const radiation_forces, struct reb_particle* const particles, const int N){
     struct rebx_extras* const rebx = sim->extras;
     double* c = rebx_get_param(rebx, radiation_forces->ap, "c");
@@ -56,6 +56,7 @@ enum rebx_param_type{
     REBX_TYPE_FORCE,
     REBX_TYPE_UINT32,
     REBX_TYPE_ORBIT,
+    REBX_TYPE_INTERPOLATOR,
 };
 
 /**
@@ -124,6 +125,12 @@ enum rebx_binary_field_type{
     REBX_BINARY_FIELD_TYPE_PARTICLES=24,
     REBX_BINARY_FIELD_TYPE_FORCE=25,
     REBX_BINARY_FIELD_TYPE_SNAPSHOT=26,
+    REBX_BINARY_FIELD_TYPE_INTERPOLATION=27,
+    REBX_BINARY_FIELD_TYPE_NVALUES=28,
+    REBX_BINARY_FIELD_TYPE_TIMES=29,
+    REBX_BINARY_FIELD_TYPE_VALUES=30,
+    REBX_BINARY_FIELD_TYPE_Y2=31,
+    REBX_BINARY_FIELD_TYPE_KLO=32,
 };
 
 /**
@@ -226,6 +233,17 @@ struct rebx_step{
     double dt_fraction;                 ///< Fraction of sim.dt to use each time it's called
 };
 
+/**
+ * @brief Quantities that conditions of the triggers operator can be placed on.
+ */
+enum rebx_trigger_quantity {
+    REBX_TRIGGER_TIME,          ///< Simulation time
+    REBX_TRIGGER_A,             ///< Semi-major axis of a particle relative to its primary
+    REBX_TRIGGER_E,             ///< Eccentricity of a particle relative to its primary
+    REBX_TRIGGER_INC,           ///< Inclination of a particle relative to its primary
+    REBX_TRIGGER_DISTANCE,      ///< Distance of a particle from its primary
+};
+
 /**
  * @brief Structure used as building block to save and load binary files.
  */
@@ -234,18 +252,46 @@ struct rebx_binary_field{
     long size;                          ///< Size in bytes of the object data (not including this structure). So you can skip ahead.
 };
 
+/**
+ * @brief Read-only interpolation table (times, values and spline coefficients) that can be shared by interpolators in many simulations.
+ * @details Reference counted. Create with rebx_create_interpolator_table and release with rebx_free_interpolator_table.
+ */
+struct rebx_interpolator_table{
+    int refcount;                       ///< Number of owners (the creator and every interpolator using it)
+    enum rebx_interpolation_type interpolation;
+    int Nvalues;
+    double* times;
+    double* values;
+    double* y2;
+};
+
 struct rebx_interpolator{
     enum rebx_interpolation_type interpolation;
     double* times;
     double* values;
     int Nvalues;
     double* y2;
-    int klo;
+    int klo;                                    ///< Cursor into the table. Always private to each interpolator
+    struct rebx_interpolator_table* table;      ///< Shared table the arrays above point into, or NULL if the interpolator owns them
+};
+
+/**
+ * @brief Close encounter recorded by the encounter_events operator.
+ */
+struct rebx_encounter_event{
+    double t;                           ///< Time of closest approach
+    uint32_t hash1;                     ///< Hash of the first particle
+    uint32_t hash2;                     ///< Hash of the second particle
+    double distance;                    ///< Distance at closest approach
+    double v_rel;                       ///< Relative speed
 };
 /**
  * @brief Main REBOUNDx structure.
  * @details These fields are used internally by REBOUNDx and generally should not be changed manually by the user. Use the API instead.
  */
+struct rebx_trace; // opaque, defined in trace.c
+struct rebx_source_geometry; // defined in core.h
+
 struct rebx_extras {	
 	struct reb_simulation* sim;					    ///< Pointer to the simulation REBOUNDx is linked to.
     
@@ -256,6 +302,15 @@ struct rebx_extras {
     struct rebx_node* registered_params;            ///< Linked list of rebx_params with all the parameter names registered with their type (for type safety)
     struct rebx_node* allocated_forces;             ///< For memory management
     struct rebx_node* allocated_operators;          ///< For memory management
+    void* workspace;                                ///< Scratch memory reused across calls (e.g., by potential and Hamiltonian functions). See rebx_get_workspace
+    size_t workspace_size;                          ///< Size of workspace in bytes
+    struct reb_vec3d* gravity_acc;                  ///< Copy of REBOUND's gravitational accelerations, taken before any additional forces are applied (only if an effect uses it)
+    int gravity_acc_N;                              ///< Number of particles gravity_acc is allocated for
+    int gravity_acc_valid;                          ///< 1 while gravity_acc holds the accelerations for the current force evaluation, 0 otherwise
+    struct reb_particle* dense_particles;           ///< Particle states at the end of a step and at a grid time, for operators applied on a fixed time grid
+    int dense_particles_N;                          ///< Number of particles dense_particles is allocated for
+    struct rebx_trace* trace;                       ///< Timeline of force and operator execution, or NULL if not tracing. See rebx_trace_start
+    struct rebx_source_geometry* geometry;          ///< Distances from a source particle shared by potentials while rebx_energy runs
 };
 
 /****************************************
@@ -302,6 +357,54 @@ int rebx_remove_operator(struct rebx_extras* rebx, struct rebx_operator* operato
  */
 void rebx_output_binary(struct rebx_extras* rebx, char* filename);
 
+/**
+ * @brief Same as rebx_output_binary, but writes the binary into a newly allocated memory buffer instead of a file.
+ * @details The buffer can be loaded with rebx_init_extras_from_buffer. Free it with rebx_output_free_stream.
+ * @param rebx Pointer to the rebx_extras instance
+ * @param bufp Set to the allocated buffer (NULL on failure).
+ * @param sizep Set to the size of the buffer in bytes.
+ */
+void rebx_output_binary_to_stream(struct rebx_extras* rebx, char** bufp, size_t* sizep);
+
+/**
+ * @brief Frees a buffer returned by rebx_output_binary_to_stream.
+ */
+void rebx_output_free_stream(char* buf);
+
+/**
+ * @brief Starts recording a timeline of every force evaluation and every pre/post timestep operator step.
+ * @details Each thread records into its own buffer of capacity events; later events are counted as dropped.
+ * Force events include the index of the force evaluation within the timestep, counting every call (with IAS15, all substeps of all
+ * predictor-corrector iterations, so this is not the substep index). Restarting discards earlier events.
+ * @param rebx Pointer to the rebx_extras instance
+ * @param capacity Maximum number of events stored per thread.
+ * @return 1 on success, 0 on failure.
+ */
+int rebx_trace_start(struct rebx_extras* const rebx, const int capacity);
+
+/**
+ * @brief Stops recording events. Recorded events are kept until rebx_trace_start is called again or rebx is freed.
+ */
+void rebx_trace_stop(struct rebx_extras* const rebx);
+
+/**
+ * @brief Writes the recorded events to a file in Chrome Trace Event JSON format (viewable in chrome://tracing or Perfetto).
+ * @param rebx Pointer to the rebx_extras instance
+ * @param filename File to write.
+ * @return 1 on success, 0 on failure.
+ */
+int rebx_trace_export(struct rebx_extras* const rebx, const char* const filename);
+
+/**
+ * @brief Returns the number of events recorded so far.
+ */
+int rebx_trace_N(struct rebx_extras* const rebx);
+
+/**
+ * @brief Returns the number of events that were not recorded because a thread's buffer was full.
+ */
+long rebx_trace_Ndropped(struct rebx_extras* const rebx);
+
 /**
  * @brief Reads a REBOUNDx binary file, loads all effects and parameters.
  * @param sim Pointer to the simulation to which the effects and parameters should be added.
@@ -316,6 +419,17 @@ struct rebx_extras* rebx_create_extras_from_binary(struct reb_simulation* sim, c
  * @param warnings Pointer to an array of warnings to be populated during loading. 
  */
 void rebx_init_extras_from_binary(struct rebx_extras* rebx, const char* const filename, enum rebx_input_binary_messages* warnings);
+
+/**
+ * @brief Same as rebx_init_extras_from_binary(), but reads the binary from a buffer in memory rather than from disk.
+ * @details Useful when the same binary is loaded many times (e.g., for every snapshot in a SimulationArchive), since the file only has to be read once.
+ * The buffer is still parsed on every call (only file access is saved), since effects and their parameters can't be cloned between simulations.
+ * @param rebx Pointer to a rebx_extras instance to be updated.
+ * @param buffer Pointer to the contents of a REBOUNDx binary file.
+ * @param size Size of buffer in bytes.
+ * @param warnings Pointer to an array of warnings to be populated during loading. 
+ */
+void rebx_init_extras_from_buffer(struct rebx_extras* rebx, const char* const buffer, const size_t size, enum rebx_input_binary_messages* warnings);
 /** @} */
 /** @} */
 
@@ -341,6 +455,21 @@ void rebx_init_extras_from_binary(struct rebx_extras* rebx, const char* const fi
 //struct rebx_effect* rebx_add(struct rebx_extras* rebx, const char* name);
 int rebx_add_operator(struct rebx_extras* rebx, struct rebx_operator* operator);
 int rebx_add_operator_step(struct rebx_extras* rebx, struct rebx_operator* operator, const double dt_fraction, enum rebx_timing timing);
+/**
+ * @brief Adds an operator that is applied at fixed intervals in simulation time, independent of the integrator's timestep.
+ * @details The operator is called once for every grid time sim->t + k*interval crossed by a timestep, with dt = interval.
+ * The particle states at the grid time are evaluated with IAS15's interpolating polynomial, so adaptive timesteps can be kept.
+ * The operator's changes are then carried over to the end of the timestep to first order: position changes are added directly,
+ * and velocity kicks are drifted along a straight line over the rest of the step. The gravitational response to a kick within
+ * that remainder is neglected, which gives an error of order dv*(t_end-t_grid)^2 per kick. Keep the timesteps short compared to
+ * the dynamical times if the operator imparts large kicks.
+ * Only IAS15 is supported; for other integrators this returns 0 with an error. Use rebx_add_operator_step instead.
+ * @param rebx Pointer to the rebx_extras instance
+ * @param operator Operator to add
+ * @param interval Spacing of the time grid (must be positive)
+ * @return 1 on success, 0 otherwise.
+ */
+int rebx_add_operator_interval(struct rebx_extras* rebx, struct rebx_operator* operator, const double interval);
 int rebx_add_force(struct rebx_extras* rebx, struct rebx_force* force);
 struct rebx_operator* rebx_load_operator(struct rebx_extras* const rebx, const char* name);
 struct rebx_force* rebx_load_force(struct rebx_extras* const rebx, const char* name);
@@ -418,6 +547,11 @@ struct rebx_param* rebx_get_param_struct(struct rebx_extras* rebx, struct rebx_n
 void rebx_set_param_pointer(struct rebx_extras* const rebx, struct rebx_node** apptr, const char* const param_name, void* val);
 void rebx_set_param_double(struct rebx_extras* const rebx, struct rebx_node** apptr, const char* const param_name, double val);
 void rebx_set_param_int(struct rebx_extras* const rebx, struct rebx_node** apptr, const char* const param_name, int val);
+/**
+ * @brief Sets a parameter of type REBX_TYPE_INTERPOLATOR to a copy of the passed interpolator.
+ * @details REBOUNDx owns the copy (including the spline coefficients) and frees it with the parameter. Interpolator parameters are saved to binary files.
+ */
+void rebx_set_param_interpolator(struct rebx_extras* const rebx, struct rebx_node** apptr, const char* const param_name, const struct rebx_interpolator* const interpolator);
 void rebx_set_param_uint32(struct rebx_extras* const rebx, struct rebx_node** apptr, const char* const param_name, uint32_t val);
 void rebx_register_param(struct rebx_extras* const rebx, const char* name, enum rebx_param_type type);
 /** @} */
@@ -519,6 +653,136 @@ double rebx_central_force_potential(struct rebx_extras* const rebx);
  */
 double rebx_gravitational_harmonics_potential(struct rebx_extras* const rebx);
 
+/**
+ * @brief Calculates the total energy, including the Newtonian energy and the potentials of all conservative effects added to the simulation.
+ * @details Effects can be added either as forces or through integrate_force operators. For gr and gr_full, their Hamiltonians replace the Newtonian energy.
+ * @param rebx pointer to the REBOUNDx extras instance.
+ * @return Total energy (double).
+ */
+double rebx_energy(struct rebx_extras* const rebx);
+
+/**
+ * @brief Sets a binary file to which the energy_monitor operator appends (time, relative energy error) pairs of doubles.
+ * @param rebx pointer to the REBOUNDx extras instance.
+ * @param operator energy_monitor operator returned by rebx_load_operator.
+ * @param filename File to append records to. The file is closed when the operator is freed.
+ * @return 1 on success, 0 if the file could not be opened.
+ */
+int rebx_energy_monitor_set_output(struct rebx_extras* const rebx, struct rebx_operator* const operator, const char* const filename);
+
+/**
+ * @brief Calculates the largest timestep that resolves the intrinsic timescale of the tides_constant_time_lag effect.
+ * @details Inverse of the largest tidal damping rate of any pair's relative velocity. Infinite if no tctl_tau is set.
+ * @param rebx pointer to the REBOUNDx extras instance.
+ * @param tides Force structure returned by rebx_load_force
+ * @return Maximum timestep (double).
+ */
+double rebx_tides_constant_time_lag_max_dt(struct rebx_extras* const rebx, struct rebx_force* const tides);
+
+/**
+ * @brief Calculates the largest timestep that resolves the auto-correlation times of the stochastic_forces effect.
+ * @param rebx pointer to the REBOUNDx extras instance.
+ * @param force Force structure returned by rebx_load_force
+ * @return Shortest auto-correlation time of any particle's stochastic force (double).
+ */
+double rebx_stochastic_forces_max_dt(struct rebx_extras* const rebx, const struct rebx_force* const force);
+
+/**
+ * @brief Calculates the largest timestep that resolves the damping timescales of the type_I_migration effect.
+ * @param rebx pointer to the REBOUNDx extras instance.
+ * @param force Force structure returned by rebx_load_force
+ * @return Shortest semi-major axis, eccentricity or inclination damping timescale of any particle (double).
+ */
+double rebx_type_I_migration_max_dt(struct rebx_extras* const rebx, const struct rebx_force* const force);
+
+/**
+ * @brief Calculates the largest timestep that resolves the intrinsic timescales of all effects added to the simulation.
+ * @details Minimum over all forces and operators (including forces of integrate_force operators). Effects without an intrinsic timescale are ignored.
+ * @param rebx pointer to the REBOUNDx extras instance.
+ * @return Maximum timestep (double). INFINITY if no effect reports one.
+ */
+double rebx_max_dt(struct rebx_extras* const rebx);
+
+/**
+ * @brief Number of events currently stored in the ring buffer of an encounter_events operator.
+ * @param rebx pointer to the REBOUNDx extras instance.
+ * @param operator encounter_events operator returned by rebx_load_operator.
+ * @return Number of events that can be drained.
+ */
+int rebx_encounter_events_N(struct rebx_extras* const rebx, struct rebx_operator* const operator);
+
+/**
+ * @brief Copies the oldest events of an encounter_events operator into arrays and removes them from its ring buffer.
+ * @details Any of the arrays can be NULL if that field is not needed. Otherwise they need room for Nmax entries.
+ * @param rebx pointer to the REBOUNDx extras instance.
+ * @param operator encounter_events operator returned by rebx_load_operator.
+ * @param t Times of closest approach.
+ * @param hash1 Hashes of the first particle in each pair.
+ * @param hash2 Hashes of the second particle in each pair.
+ * @param distance Distances at closest approach.
+ * @param v_rel Relative speeds.
+ * @param Nmax Maximum number of events to drain.
+ * @return Number of events copied.
+ */
+int rebx_encounter_events_drain(struct rebx_extras* const rebx, struct rebx_operator* const operator, double* const t, uint32_t* const hash1, uint32_t* const hash2, double* const distance, double* const v_rel, const int Nmax);
+
+/**
+ * @brief Adds a condition to a triggers operator.
+ * @details Actions to carry out when the condition is first met are added with rebx_trigger_enable_force, rebx_trigger_disable_force and rebx_trigger_set_param.
+ * @param rebx pointer to the REBOUNDx extras instance.
+ * @param operator triggers operator returned by rebx_load_operator.
+ * @param quantity Quantity to monitor.
+ * @param threshold Value of the quantity at which the condition is met.
+ * @param above 1 if the condition is met once quantity >= threshold, 0 if once quantity <= threshold.
+ * @param particle_hash Hash of the particle whose orbit is monitored (ignored for REBX_TRIGGER_TIME).
+ * @param primary_hash Hash of the primary that orbital elements are calculated relative to. 0 for sim->particles[0].
+ * @return Index of the new condition, to pass to the functions adding actions. -1 on error.
+ */
+int rebx_trigger_add(struct rebx_extras* const rebx, struct rebx_operator* const operator, const enum rebx_trigger_quantity quantity, const double threshold, const int above, const uint32_t particle_hash, const uint32_t primary_hash);
+
+/**
+ * @brief Adds a force to the simulation when a condition of a triggers operator is met (if it isn't already acting).
+ * @param rebx pointer to the REBOUNDx extras instance.
+ * @param operator triggers operator returned by rebx_load_operator.
+ * @param trigger Index returned by rebx_trigger_add.
+ * @param force Force returned by rebx_load_force.
+ * @return 1 on success, 0 otherwise.
+ */
+int rebx_trigger_enable_force(struct rebx_extras* const rebx, struct rebx_operator* const operator, const int trigger, struct rebx_force* const force);
+
+/**
+ * @brief Stops a force from acting on the simulation when a condition of a triggers operator is met. The force is not freed.
+ * @param rebx pointer to the REBOUNDx extras instance.
+ * @param operator triggers operator returned by rebx_load_operator.
+ * @param trigger Index returned by rebx_trigger_add.
+ * @param force Force returned by rebx_load_force.
+ * @return 1 on success, 0 otherwise.
+ */
+int rebx_trigger_disable_force(struct rebx_extras* const rebx, struct rebx_operator* const operator, const int trigger, struct rebx_force* const force);
+
+/**
+ * @brief Sets a parameter when a condition of a triggers operator is met.
+ * @details The parameter has to be registered with type REBX_TYPE_DOUBLE or REBX_TYPE_INT (value is truncated for the latter).
+ * @param rebx pointer to the REBOUNDx extras instance.
+ * @param operator triggers operator returned by rebx_load_operator.
+ * @param trigger Index returned by rebx_trigger_add.
+ * @param apptr Pointer to the ap field of the force or operator whose parameter to set, e.g. &force->ap. NULL to set a particle parameter.
+ * @param particle_hash Hash of the particle whose parameter to set if apptr is NULL. Must be nonzero in that case.
+ * @param param_name Name of the parameter.
+ * @param value Value to set.
+ * @return 1 on success, 0 otherwise.
+ */
+int rebx_trigger_set_param(struct rebx_extras* const rebx, struct rebx_operator* const operator, const int trigger, struct rebx_node** apptr, const uint32_t particle_hash, const char* const param_name, const double value);
+
+/**
+ * @brief Returns whether a condition of a triggers operator has been met (and its actions carried out).
+ * @param rebx pointer to the REBOUNDx extras instance.
+ * @param operator triggers operator returned by rebx_load_operator.
+ * @param trigger Index returned by rebx_trigger_add.
+ * @return 1 if it fired, 0 otherwise.
+ */
+int rebx_trigger_fired(struct rebx_extras* const rebx, struct rebx_operator* const operator, const int trigger);
+
 /** @} */
 /** @} */
 
@@ -642,6 +906,35 @@ struct rebx_interpolator* rebx_create_interpolator(struct rebx_extras* const reb
  * @brief Frees the memory for a rebx_interpolator structure.
  */
 void rebx_free_interpolator(struct rebx_interpolator* const interpolator);
+/**
+ * @brief Returns a newly allocated copy of an interpolator, including its spline coefficients (which are not recomputed).
+ * @details If the interpolator uses a shared table, the copy shares it too and only gets its own cursor.
+ */
+struct rebx_interpolator* rebx_copy_interpolator(struct rebx_extras* const rebx, const struct rebx_interpolator* const interpolator);
+
+/**
+ * @brief Creates a reference-counted, read-only interpolation table that interpolators in many simulations can share.
+ * @details Copies the arrays and computes the spline coefficients once. The caller owns one reference, released with rebx_free_interpolator_table.
+ * @param Nvalues Length of times and values arrays (must be equal for both).
+ * @param times Array of times at which the corresponding values are supplied.
+ * @param values Array of values at each corresponding time.
+ * @param interpolation Enum specifying the interpolation method.
+ * @return Pointer to the table, or NULL if out of memory.
+ */
+struct rebx_interpolator_table* rebx_create_interpolator_table(const int Nvalues, const double* times, const double* values, enum rebx_interpolation_type interpolation);
+
+/**
+ * @brief Releases a reference to a shared interpolation table. The table is freed once no interpolator uses it anymore.
+ */
+void rebx_free_interpolator_table(struct rebx_interpolator_table* const table);
+
+/**
+ * @brief Creates an interpolator that reads from a shared table, with its own private cursor.
+ * @param rebx pointer to the REBOUNDx extras instance.
+ * @param table Table returned by rebx_create_interpolator_table.
+ * @return Pointer to a rebx_interpolator structure. Free with rebx_free_interpolator, which releases its reference to the table.
+ */
+struct rebx_interpolator* rebx_create_interpolator_from_table(struct rebx_extras* const rebx, struct rebx_interpolator_table* const table);
 
 /**
  * @brief Interpolate value at arbitrary times.
@@ -652,6 +945,17 @@ void rebx_free_interpolator(struct rebx_interpolator* const interpolator);
  * @return Interpolated value at passed time.
  */
 double rebx_interpolate(struct rebx_extras* const rebx, struct rebx_interpolator* const interpolator, const double time);
+
+/**
+ * @brief Interpolate values at an array of times with a single call.
+ * @details If times is sorted (increasing or decreasing), the table is traversed once for the whole array. Otherwise each time is located by bisection.
+ * @param rebx Pointer to the REBOUNDx extras instance.
+ * @param interpolator Pointer to the rebx_interpolator structure to interpolate from.
+ * @param times Array of N times at which to interpolate.
+ * @param values Array of length N to store the interpolated values in.
+ * @param N Number of times.
+ */
+void rebx_interpolate_array(struct rebx_extras* const rebx, struct rebx_interpolator* const interpolator, const double* const times, double* const values, const int N);
 /** @} */
 /** @} */
 
@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include "rebxtools.h"
 #include "reboundx.h"
+#include "core.h"
 
 /* only accepts one reference particle if coordinates=REBX_COORDINATES_PARTICLE.
  * calculate_effect function should check for edge case where particle and reference are the same
@@ -61,6 +62,15 @@ void rebx_calculate_jacobi_masses(const struct reb_particle* const ps, double* c
     m_j[0] = eta;
 }
 
+double rebx_compensated_sum(const double* const x, const int N){
+    double sum = 0.;
+    double c = 0.;
+    for (int i=0; i<N; i++){
+        rebx_neumaier_add(&sum, &c, x[i]);
+    }
+    return sum + c;
+}
+
 double rebx_Edot(struct reb_particle* const ps, const int N){
     double Edot = 0.;
     for(int i=0; i<N; i++){
@@ -69,6 +79,24 @@ double rebx_Edot(struct reb_particle* const ps, const int N){
     return Edot;
 }
 
+// Back reaction of a force on the first N particles
+REBX_KERNEL void rebx_subtract_acceleration_body(struct reb_particle* const particles, const int N, const double massratio, const struct reb_vec3d a){
+    for(int j=0; j < N; j++){
+        particles[j].ax -= massratio*a.x;
+        particles[j].ay -= massratio*a.y;
+        particles[j].az -= massratio*a.z;
+    }
+}
+
+REBX_MULTIVERSION(rebx_subtract_acceleration, (struct reb_particle* const particles, const int N, const double massratio, const struct reb_vec3d a), (particles, N, massratio, a))
+
+int rebx_get_N_massive(const struct reb_simulation* const sim, const int N){
+    if (sim->N_active >= 0 && sim->N_active < N && sim->testparticle_type == 0){
+        return sim->N_active;
+    }
+    return N;
+}
+
 void rebx_com_force(struct reb_simulation* const sim, struct rebx_force* const force, const enum REBX_COORDINATES coordinates, const int back_reactions_inclusive, const char* reference_name, struct reb_vec3d (*calculate_force) (struct reb_simulation* const sim, struct rebx_force* const force, struct reb_particle* p, struct reb_particle* source), struct reb_particle* const particles, const int N){
     struct rebx_extras* const rebx = sim->extras;
     struct reb_particle com = reb_get_com(sim); // Start with full com for jacobi and barycentric coordinates.
@@ -94,8 +122,28 @@ void rebx_com_force(struct reb_simulation* const sim, struct rebx_force* const f
         }
     }
 
-    
-    for(int i=N-1; i>=0; i--){ // Run through backwards so each iteration does not depend on previous ones in Jacobi coordinates.
+    int N_massive = rebx_get_N_massive(sim, N);
+    if (N_massive < N && refindex < N_massive){
+        // Test particles (i >= N_massive) don't perturb the massive bodies, so they all see the same com and need no back reactions.
+        if (coordinates == REBX_COORDINATES_JACOBI){
+            for (int i=N-1; i>=N_massive; i--){
+                com = rebx_get_com_without_particle(com, particles[i]);
+            }
+        }
+        #pragma omp parallel for schedule(guided)
+        for (int i=N_massive; i<N; i++){
+            struct reb_particle* p = &particles[i];
+            struct reb_vec3d a = calculate_force(sim, force, p, &com);
+            p->ax += a.x;
+            p->ay += a.y;
+            p->az += a.z;
+        }
+    }
+    else{
+        N_massive = N;
+    }
+
+    for(int i=N_massive-1; i>=0; i--){ // Run through backwards so each iteration does not depend on previous ones in Jacobi coordinates.
         if (i==refindex){
             continue;
         }
@@ -113,11 +161,7 @@ void rebx_com_force(struct reb_simulation* const sim, struct rebx_force* const f
         switch(coordinates){
             case REBX_COORDINATES_BARYCENTRIC:
                 massratio = p->m/com.m;
-                for(int j=0; j < N; j++){
-                    particles[j].ax -= massratio*a.x;
-                    particles[j].ay -= massratio*a.y;
-                    particles[j].az -= massratio*a.z;
-                }
+                rebx_subtract_acceleration(particles, N, massratio, a);
                 break;
             case REBX_COORDINATES_JACOBI:
                 if(back_reactions_inclusive){
@@ -126,11 +170,7 @@ void rebx_com_force(struct reb_simulation* const sim, struct rebx_force* const f
                 else{
                     massratio = p->m/com.m;
                 }
-                for(int j=0; j < i + back_reactions_inclusive; j++){    // stop at j=i if inclusive, at i-1 if not
-                    particles[j].ax -= massratio*a.x;
-                    particles[j].ay -= massratio*a.y;
-                    particles[j].az -= massratio*a.z;
-                }
+                rebx_subtract_acceleration(particles, i + back_reactions_inclusive, massratio, a); // stop at j=i if inclusive, at i-1 if not
                 break;
             case REBX_COORDINATES_PARTICLE:
                 if(back_reactions_inclusive){
@@ -187,8 +227,31 @@ void rebxtools_com_ptm(struct reb_simulation* const sim, struct rebx_operator* c
         }
     }
 
-    
-    for(int i=N_real-1; i>=0; i--){ // Run through backwards so each iteration does not depend on previous ones in Jacobi coordinates.
+    int N_massive = rebx_get_N_massive(sim, N_real);
+    if (N_massive < N_real && refindex < N_massive){
+        // Test particles (i >= N_massive) don't perturb the massive bodies, so they all see the same com and need no back reactions.
+        if (coordinates == REBX_COORDINATES_JACOBI){
+            for (int i=N_real-1; i>=N_massive; i--){
+                com = rebx_get_com_without_particle(com, sim->particles[i]);
+            }
+        }
+        #pragma omp parallel for schedule(guided)
+        for (int i=N_massive; i<N_real; i++){
+            struct reb_particle* p = &sim->particles[i];
+            struct reb_particle modified_particle = calculate_step(sim, operator, p, &com, dt);
+            p->x = modified_particle.x;
+            p->y = modified_particle.y;
+            p->z = modified_particle.z;
+            p->vx = modified_particle.vx;
+            p->vy = modified_particle.vy;
+            p->vz = modified_particle.vz;
+        }
+    }
+    else{
+        N_massive = N_real;
+    }
+
+    for(int i=N_massive-1; i>=0; i--){ // Run through backwards so each iteration does not depend on previous ones in Jacobi coordinates.
         if (i==refindex){
             continue;
         }
@@ -449,6 +512,13 @@ void rebxtools_move_to_com(struct reb_simulation* const sim){
     }
 }
 
+void rebxtools_get_com(const struct reb_simulation* const sim, const int first_N, struct reb_particle* com){
+    struct reb_particle* particles = sim->particles;
+    for (int i=0;i<first_N;i++){
+        rebxtools_update_com_with_particle(com, &particles[i]);
+    }
+}*/
+
 void rebxtools_update_com_with_particle(struct reb_particle* const com, const struct reb_particle* const p){
     com->x   = com->x*com->m + p->x*p->m;
     com->y   = com->y*com->m + p->y*p->m;
@@ -485,9 +555,3 @@ void rebxtools_update_com_without_particle(struct reb_particle* const com, const
     }
 }
 
-void rebxtools_get_com(const struct reb_simulation* const sim, const int first_N, struct reb_particle* com){
-    struct reb_particle* particles = sim->particles;
-    for (int i=0;i<first_N;i++){
-        rebxtools_update_com_with_particle(com, &particles[i]);
-    }
-}*/
@@ -26,6 +26,8 @@
 #ifndef _REBXTOOLS_H
 #define _REBXTOOLS_H
 
+#include <math.h>
+
 struct reb_simulation;
 struct reb_particle;
 struct reb_orbit;
@@ -34,6 +36,10 @@ struct rebx_force;
 struct rebx_operator;
 enum REBX_COORDINATES;
 
+// Number of leading particles whose effects on other bodies must be included. Returns sim->N_active when the remaining particles are test particles
+// that don't perturb the massive bodies (testparticle_type = 0), so their back reactions can be skipped. Otherwise returns N.
+int rebx_get_N_massive(const struct reb_simulation* const sim, const int N);
+
 void rebx_com_force(struct reb_simulation* const sim, struct rebx_force* const force, const enum REBX_COORDINATES coordinates, const int back_reactions_inclusive, const char* reference_name, struct reb_vec3d (*calculate_force) (struct reb_simulation* const sim, struct rebx_force* const force, struct reb_particle* p, struct reb_particle* source), struct reb_particle* const particles, const int N);
 
 void rebxtools_com_ptm(struct reb_simulation* const sim, struct rebx_operator* const operator, const enum REBX_COORDINATES coordinates, const int back_reactions_inclusive, const char* reference_name, struct reb_particle (*calculate_step) (struct reb_simulation* const sim, struct rebx_operator* const operator, struct reb_particle* p, struct reb_particle* source, const double dt), const double dt);
@@ -42,6 +48,24 @@ double rebx_Edot(struct reb_particle* const ps, const int N);
 
 void rebx_calculate_jacobi_masses(const struct reb_particle* const ps, double* const m_j, const int N);
 
+// Compensated (Neumaier) summation. Add x to the running sum, accumulating the lost low-order bits in c. Total is sum + c.
+static inline void rebx_neumaier_add(double* const sum, double* const c, const double x){
+    const double t = *sum + x;
+    if (fabs(*sum) >= fabs(x)){
+        *c += (*sum - t) + x;
+    }
+    else{
+        *c += (x - t) + *sum;
+    }
+    *sum = t;
+}
+
+double rebx_compensated_sum(const double* const x, const int N); // Compensated sum of x[0]...x[N-1] in index order (independent of number of threads).
+
+// Add/remove particle p's contribution to the center of mass com (positions, velocities and mass)
+void rebxtools_update_com_with_particle(struct reb_particle* const com, const struct reb_particle* const p);
+void rebxtools_update_com_without_particle(struct reb_particle* const com, const struct reb_particle* const p);
+
 /****************************************
 Effect helper functions
 ****************************************/
@@ -58,10 +82,6 @@ void rebxtools_orbit_to_particle(double G, struct reb_particle* p, struct reb_pa
 
 void rebxtools_move_to_com(struct reb_simulation* const sim);
 
-void rebxtools_update_com_with_particle(struct reb_particle* const com, const struct reb_particle* p);
-
-void rebxtools_update_com_without_particle(struct reb_particle* const com, const struct reb_particle* p);
-
 void rebxtools_get_com(const struct reb_simulation* const sim, const int first_N, struct reb_particle* com);
 */
 #endif
@@ -0,0 +1,143 @@
+/**
+ * @file    registry.c
+ * @brief   Static tables of the built-in parameters, forces and operators, with perfect hash lookup.
+ * @author  Dan Tamayo <tamayo.daniel@gmail.com>
+ *
+ * @section     LICENSE
+ * Copyright (c) 2015 Dan Tamayo, Hanno Rein
+ *
+ * This file is part of reboundx.
+ *
+ * reboundx is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * reboundx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with rebound.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "rebound.h"
+#include "reboundx.h"
+#include "core.h"
+#include "registry_hash.h"
+
+// The tables are read-only data shared by all rebx_extras instances, so attaching REBOUNDx needs no registration work.
+static const struct rebx_registry_param rebx_param_table[] = {
+#define REBX_PARAM(name, type) {name, type},
+#define REBX_FORCE(name, update_accelerations, force_type)
+#define REBX_OPERATOR(name, step_function, operator_type)
+#include "registry.h"
+#undef REBX_PARAM
+#undef REBX_FORCE
+#undef REBX_OPERATOR
+};
+
+static const struct rebx_registry_force rebx_force_table[] = {
+#define REBX_PARAM(name, type)
+#define REBX_FORCE(name, update_accelerations, force_type) {name, update_accelerations, force_type},
+#define REBX_OPERATOR(name, step_function, operator_type)
+#include "registry.h"
+#undef REBX_PARAM
+#undef REBX_FORCE
+#undef REBX_OPERATOR
+};
+
+static const struct rebx_registry_operator rebx_operator_table[] = {
+#define REBX_PARAM(name, type)
+#define REBX_FORCE(name, update_accelerations, force_type)
+#define REBX_OPERATOR(name, step_function, operator_type) {name, step_function, operator_type},
+#include "registry.h"
+#undef REBX_PARAM
+#undef REBX_FORCE
+#undef REBX_OPERATOR
+};
+
+// Fail to compile if entries were added to or removed from registry.h without regenerating registry_hash.h.
+// Renamed or reordered entries keep the counts, so those are caught by rebx_registry_check below.
+typedef char rebx_param_table_check[(sizeof(rebx_param_table)/sizeof(rebx_param_table[0]) == REBX_PARAM_TABLE_N) ? 1 : -1];
+typedef char rebx_force_table_check[(sizeof(rebx_force_table)/sizeof(rebx_force_table[0]) == REBX_FORCE_TABLE_N) ? 1 : -1];
+typedef char rebx_operator_table_check[(sizeof(rebx_operator_table)/sizeof(rebx_operator_table[0]) == REBX_OPERATOR_TABLE_N) ? 1 : -1];
+
+// 32 bit FNV-1a hash with the offset basis perturbed by seed. Must match fnv1a in scripts/generate_registry.py
+static uint32_t rebx_registry_hash(const char* name, const uint32_t seed){
+    uint32_t h = 2166136261u ^ seed;
+    for (; *name != '\0'; name++){
+        h ^= (unsigned char)*name;
+        h *= 16777619u;
+    }
+    // The low bits of FNV-1a only depend on the low bits of the input, so mix the high bits down before masking
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    return h;
+}
+
+// Returns the table index for name (if it is in the table, otherwise an index whose name has to be compared), or -1
+static int rebx_registry_slot(const char* const name, const uint32_t* const displacements, const int G, const int16_t* const slots, const int M){
+    const uint32_t d = displacements[rebx_registry_hash(name, 0) & (uint32_t)(G-1)];
+    return slots[rebx_registry_hash(name, d) & (uint32_t)(M-1)];
+}
+
+const struct rebx_registry_param* rebx_registry_get_param(const char* const name){
+    if (name == NULL){
+        return NULL;
+    }
+    const int i = rebx_registry_slot(name, rebx_param_hash_displacements, REBX_PARAM_HASH_G, rebx_param_hash_slots, REBX_PARAM_HASH_M);
+    if (i < 0 || strcmp(rebx_param_table[i].name, name) != 0){
+        return NULL;
+    }
+    return &rebx_param_table[i];
+}
+
+const struct rebx_registry_force* rebx_registry_get_force(const char* const name){
+    if (name == NULL){
+        return NULL;
+    }
+    const int i = rebx_registry_slot(name, rebx_force_hash_displacements, REBX_FORCE_HASH_G, rebx_force_hash_slots, REBX_FORCE_HASH_M);
+    if (i < 0 || strcmp(rebx_force_table[i].name, name) != 0){
+        return NULL;
+    }
+    return &rebx_force_table[i];
+}
+
+const struct rebx_registry_operator* rebx_registry_get_operator(const char* const name){
+    if (name == NULL){
+        return NULL;
+    }
+    const int i = rebx_registry_slot(name, rebx_operator_hash_displacements, REBX_OPERATOR_HASH_G, rebx_operator_hash_slots, REBX_OPERATOR_HASH_M);
+    if (i < 0 || strcmp(rebx_operator_table[i].name, name) != 0){
+        return NULL;
+    }
+    return &rebx_operator_table[i];
+}
+
+int rebx_registry_N_params(void){
+    return REBX_PARAM_TABLE_N;
+}
+
+const struct rebx_registry_param* rebx_registry_param_at(const int i){
+    return &rebx_param_table[i];
+}
+
+int rebx_registry_check(void){
+    int Nfailed = 0;
+    for (int i=0; i<REBX_PARAM_TABLE_N; i++){
+        Nfailed += (rebx_registry_get_param(rebx_param_table[i].name) != &rebx_param_table[i]);
+    }
+    for (int i=0; i<REBX_FORCE_TABLE_N; i++){
+        Nfailed += (rebx_registry_get_force(rebx_force_table[i].name) != &rebx_force_table[i]);
+    }
+    for (int i=0; i<REBX_OPERATOR_TABLE_N; i++){
+        Nfailed += (rebx_registry_get_operator(rebx_operator_table[i].name) != &rebx_operator_table[i]);
+    }
+    return Nfailed;
+}
@@ -0,0 +1,169 @@
+/**
+ * @file    registry.h
+ * @brief   Built-in parameters, forces and operators of REBOUNDx.
+ * @author  Dan Tamayo <tamayo.daniel@gmail.com>
+ *
+ * @section     LICENSE
+ * Copyright (c) 2015 Dan Tamayo, Hanno Rein
+ *
+ * This file is part of reboundx.
+ *
+ * reboundx is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * reboundx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with rebound.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* X-macro lists, expanded into static tables in registry.c (no include guard on purpose).
+ * After adding, removing or renaming an entry, regenerate the perfect hash tables in registry_hash.h with
+ *     cd scripts && python generate_registry.py
+ */
+
+/* REBX_PARAM(name, type) */
+REBX_PARAM("c",                            REBX_TYPE_DOUBLE)
+REBX_PARAM("gr_source",                    REBX_TYPE_INT)
+REBX_PARAM("tau_mass",                     REBX_TYPE_DOUBLE)
+REBX_PARAM("mm_exact",                     REBX_TYPE_INT)
+REBX_PARAM("mm_full_com",                  REBX_TYPE_INT)
+REBX_PARAM("mm_list",                      REBX_TYPE_POINTER)
+REBX_PARAM("force",                        REBX_TYPE_FORCE)
+REBX_PARAM("particle",                     REBX_TYPE_POINTER)
+REBX_PARAM("Acentral",                     REBX_TYPE_DOUBLE)
+REBX_PARAM("gammacentral",                 REBX_TYPE_DOUBLE)
+REBX_PARAM("max_iterations",               REBX_TYPE_INT)
+REBX_PARAM("gr_full_theta",                REBX_TYPE_DOUBLE)
+REBX_PARAM("gr_iterations",                REBX_TYPE_DOUBLE)
+REBX_PARAM("gr_solves",                    REBX_TYPE_DOUBLE)
+REBX_PARAM("gr_unconverged",               REBX_TYPE_DOUBLE)
+REBX_PARAM("gr_full_tree",                 REBX_TYPE_POINTER)
+REBX_PARAM("gr_reuse_gravity",             REBX_TYPE_INT)
+REBX_PARAM("J2",                           REBX_TYPE_DOUBLE)
+REBX_PARAM("J4",                           REBX_TYPE_DOUBLE)
+REBX_PARAM("R_eq",                         REBX_TYPE_DOUBLE)
+REBX_PARAM("coordinates",                  REBX_TYPE_INT)
+REBX_PARAM("p",                            REBX_TYPE_DOUBLE)
+REBX_PARAM("tau_a",                        REBX_TYPE_DOUBLE)
+REBX_PARAM("tau_e",                        REBX_TYPE_DOUBLE)
+REBX_PARAM("tau_inc",                      REBX_TYPE_DOUBLE)
+REBX_PARAM("tau_omega",                    REBX_TYPE_DOUBLE)
+REBX_PARAM("tau_Omega",                    REBX_TYPE_DOUBLE)
+REBX_PARAM("tau_afin",                     REBX_TYPE_DOUBLE)
+REBX_PARAM("afin",                         REBX_TYPE_DOUBLE)
+REBX_PARAM("em_tau_a",                     REBX_TYPE_DOUBLE)
+REBX_PARAM("em_aini",                      REBX_TYPE_DOUBLE)
+REBX_PARAM("em_afin",                      REBX_TYPE_DOUBLE)
+REBX_PARAM("primary",                      REBX_TYPE_INT)
+REBX_PARAM("radiation_source",             REBX_TYPE_INT)
+REBX_PARAM("kappa",                        REBX_TYPE_DOUBLE)
+REBX_PARAM("kappa_x",                      REBX_TYPE_DOUBLE)
+REBX_PARAM("kappa_y",                      REBX_TYPE_DOUBLE)
+REBX_PARAM("kappa_z",                      REBX_TYPE_DOUBLE)
+REBX_PARAM("tau_kappa",                    REBX_TYPE_DOUBLE)
+REBX_PARAM("tau_kappa_x",                  REBX_TYPE_DOUBLE)
+REBX_PARAM("tau_kappa_y",                  REBX_TYPE_DOUBLE)
+REBX_PARAM("tau_kappa_z",                  REBX_TYPE_DOUBLE)
+REBX_PARAM("stochastic_force_r",           REBX_TYPE_DOUBLE)
+REBX_PARAM("stochastic_force_phi",         REBX_TYPE_DOUBLE)
+REBX_PARAM("stochastic_force_x",           REBX_TYPE_DOUBLE)
+REBX_PARAM("stochastic_force_y",           REBX_TYPE_DOUBLE)
+REBX_PARAM("stochastic_force_z",           REBX_TYPE_DOUBLE)
+REBX_PARAM("beta",                         REBX_TYPE_DOUBLE)
+REBX_PARAM("tides_primary",                REBX_TYPE_INT)
+REBX_PARAM("R_tides",                      REBX_TYPE_DOUBLE)
+REBX_PARAM("tctl_k2",                      REBX_TYPE_DOUBLE)
+REBX_PARAM("tctl_tau",                     REBX_TYPE_DOUBLE)
+REBX_PARAM("Omega",                        REBX_TYPE_DOUBLE)
+REBX_PARAM("tctl_cutoff",                  REBX_TYPE_DOUBLE)
+REBX_PARAM("tctl_skin",                    REBX_TYPE_DOUBLE)
+REBX_PARAM("tctl_neighbors",               REBX_TYPE_POINTER)
+REBX_PARAM("integrator",                   REBX_TYPE_INT)
+REBX_PARAM("free_arrays",                  REBX_TYPE_POINTER)
+REBX_PARAM("im_ps_final",                  REBX_TYPE_POINTER)
+REBX_PARAM("im_ps_prev",                   REBX_TYPE_POINTER)
+REBX_PARAM("im_ps_avg",                    REBX_TYPE_POINTER)
+REBX_PARAM("rk2_k2",                       REBX_TYPE_POINTER)
+REBX_PARAM("rk4_k2",                       REBX_TYPE_POINTER)
+REBX_PARAM("rk4_k3",                       REBX_TYPE_POINTER)
+REBX_PARAM("min_distance",                 REBX_TYPE_DOUBLE)
+REBX_PARAM("min_distance_from",            REBX_TYPE_UINT32)
+REBX_PARAM("min_distance_orbit",           REBX_TYPE_ORBIT)
+REBX_PARAM("luminosity",                   REBX_TYPE_DOUBLE)
+REBX_PARAM("ide_position",                 REBX_TYPE_DOUBLE)
+REBX_PARAM("ide_width",                    REBX_TYPE_DOUBLE)
+REBX_PARAM("tIm_flaring_index",            REBX_TYPE_DOUBLE)
+REBX_PARAM("tIm_scale_height_1",           REBX_TYPE_DOUBLE)
+REBX_PARAM("tIm_surface_density_1",        REBX_TYPE_DOUBLE)
+REBX_PARAM("tIm_surface_density_exponent", REBX_TYPE_DOUBLE)
+REBX_PARAM("ye_c",                         REBX_TYPE_DOUBLE)
+REBX_PARAM("ye_body_density",              REBX_TYPE_DOUBLE)
+REBX_PARAM("ye_lstar",                     REBX_TYPE_DOUBLE)
+REBX_PARAM("ye_flag",                      REBX_TYPE_INT)
+REBX_PARAM("ye_rotation_period",           REBX_TYPE_DOUBLE)
+REBX_PARAM("ye_thermal_inertia",           REBX_TYPE_DOUBLE)
+REBX_PARAM("ye_albedo",                    REBX_TYPE_DOUBLE)
+REBX_PARAM("ye_emissivity",                REBX_TYPE_DOUBLE)
+REBX_PARAM("ye_k",                         REBX_TYPE_DOUBLE)
+REBX_PARAM("ye_stef_boltz",                REBX_TYPE_DOUBLE)
+REBX_PARAM("ye_spin_axis_x",               REBX_TYPE_DOUBLE)
+REBX_PARAM("ye_spin_axis_y",               REBX_TYPE_DOUBLE)
+REBX_PARAM("ye_spin_axis_z",               REBX_TYPE_DOUBLE)
+REBX_PARAM("ye_cache",                     REBX_TYPE_POINTER)
+REBX_PARAM("emon_interval",                REBX_TYPE_DOUBLE)
+REBX_PARAM("emon_next_output",             REBX_TYPE_DOUBLE)
+REBX_PARAM("operator_interval",            REBX_TYPE_DOUBLE)
+REBX_PARAM("operator_next_time",           REBX_TYPE_DOUBLE)
+REBX_PARAM("max_dt_function",              REBX_TYPE_POINTER)
+REBX_PARAM("tc_safety_factor",             REBX_TYPE_DOUBLE)
+REBX_PARAM("tc_suggest",                   REBX_TYPE_INT)
+REBX_PARAM("tc_max_dt",                    REBX_TYPE_DOUBLE)
+REBX_PARAM("emon_E0",                      REBX_TYPE_DOUBLE)
+REBX_PARAM("emon_dE",                      REBX_TYPE_DOUBLE)
+REBX_PARAM("emon_Nrecords",                REBX_TYPE_INT)
+REBX_PARAM("emon_file",                    REBX_TYPE_POINTER)
+REBX_PARAM("ee_distance",                  REBX_TYPE_DOUBLE)
+REBX_PARAM("ee_skin",                      REBX_TYPE_DOUBLE)
+REBX_PARAM("ee_capacity",                  REBX_TYPE_INT)
+REBX_PARAM("ee_Nevents",                   REBX_TYPE_INT)
+REBX_PARAM("ee_Ndropped",                  REBX_TYPE_INT)
+REBX_PARAM("ee_track",                     REBX_TYPE_INT)
+REBX_PARAM("ee_buffer",                    REBX_TYPE_POINTER)
+REBX_PARAM("trig_list",                    REBX_TYPE_POINTER)
+
+/* REBX_FORCE(name, update_accelerations, force_type) */
+REBX_FORCE("gr",                      rebx_gr, REBX_FORCE_VEL)
+REBX_FORCE("central_force",           rebx_central_force, REBX_FORCE_POS)
+REBX_FORCE("modify_orbits_forces",    rebx_modify_orbits_forces, REBX_FORCE_VEL)
+REBX_FORCE("exponential_migration",   rebx_exponential_migration, REBX_FORCE_VEL)
+REBX_FORCE("gr_full",                 rebx_gr_full, REBX_FORCE_VEL)
+REBX_FORCE("gravitational_harmonics", rebx_gravitational_harmonics, REBX_FORCE_POS)
+REBX_FORCE("gr_potential",            rebx_gr_potential, REBX_FORCE_POS)
+REBX_FORCE("radiation_forces",        rebx_radiation_forces, REBX_FORCE_VEL)
+REBX_FORCE("stochastic_forces",       rebx_stochastic_forces, REBX_FORCE_VEL)
+REBX_FORCE("tides_constant_time_lag", rebx_tides_constant_time_lag, REBX_FORCE_VEL)
+REBX_FORCE("type_I_migration",        rebx_modify_orbits_with_type_I_migration, REBX_FORCE_VEL)
+REBX_FORCE("yarkovsky_effect",        rebx_yarkovsky_effect, REBX_FORCE_VEL)
+
+/* REBX_OPERATOR(name, step_function, operator_type) */
+REBX_OPERATOR("modify_mass",          rebx_modify_mass, REBX_OPERATOR_UPDATER)
+REBX_OPERATOR("integrate_force",      rebx_integrate_force, REBX_OPERATOR_UPDATER)
+REBX_OPERATOR("drift",                rebx_drift_step, REBX_OPERATOR_UPDATER)
+REBX_OPERATOR("kick",                 rebx_kick_step, REBX_OPERATOR_UPDATER)
+REBX_OPERATOR("kepler",               rebx_kepler_step, REBX_OPERATOR_UPDATER)
+REBX_OPERATOR("jump",                 rebx_jump_step, REBX_OPERATOR_UPDATER)
+REBX_OPERATOR("interaction",          rebx_interaction_step, REBX_OPERATOR_UPDATER)
+REBX_OPERATOR("ias15",                rebx_ias15_step, REBX_OPERATOR_UPDATER)
+REBX_OPERATOR("modify_orbits_direct", rebx_modify_orbits_direct, REBX_OPERATOR_UPDATER)
+REBX_OPERATOR("track_min_distance",   rebx_track_min_distance, REBX_OPERATOR_RECORDER)
+REBX_OPERATOR("energy_monitor",       rebx_energy_monitor, REBX_OPERATOR_RECORDER)
+REBX_OPERATOR("timestep_control",     rebx_timestep_control, REBX_OPERATOR_RECORDER)
+REBX_OPERATOR("encounter_events",     rebx_encounter_events, REBX_OPERATOR_RECORDER)
+REBX_OPERATOR("triggers",             rebx_triggers, REBX_OPERATOR_RECORDER)
@@ -0,0 +1,49 @@
+/* Generated by scripts/generate_registry.py from registry.h. Do not edit manually. */
+
+#define REBX_PARAM_TABLE_N 108
+#define REBX_PARAM_HASH_M 128
+#define REBX_PARAM_HASH_G 64
+static const uint32_t rebx_param_hash_displacements[64] = {
+    6, 1, 3, 3, 2, 11, 9, 2, 5, 1, 10, 4,
+    7, 2, 2, 2, 1, 2, 4, 1, 6, 7, 2, 1,
+    0, 3, 0, 0, 3, 2, 0, 2, 0, 1, 2, 1,
+    10, 4, 1, 0, 1, 0, 0, 0, 1, 10, 2, 2,
+    16, 1, 5, 1, 0, 0, 1, 4, 2, 18, 2, 3,
+    14, 15, 1, 3
+};
+static const int16_t rebx_param_hash_slots[128] = {
+    59, -1, 64, 77, 100, 7, 34, 26, 91, -1, 14, 55,
+    53, 67, 18, 10, 76, 69, -1, 83, 47, 12, 103, 25,
+    44, 22, 30, 0, 19, 74, 42, 36, 21, -1, -1, 45,
+    35, 84, 57, 2, -1, 52, 28, 106, 4, 105, 104, 65,
+    11, 73, -1, 13, 62, 23, 60, 49, 40, 94, 88, 46,
+    27, 37, 107, -1, 39, 80, 93, 31, 56, 29, 97, 98,
+    8, 6, 87, 33, 17, 90, 54, 15, 68, 101, 41, 79,
+    -1, -1, 92, 5, 32, 48, 24, -1, 50, -1, -1, 86,
+    82, -1, 72, 81, 95, 78, 89, 38, 61, 43, 102, -1,
+    -1, 16, -1, 3, 20, 70, -1, 1, 75, 71, 58, 96,
+    51, -1, 9, 66, -1, 63, 99, 85
+};
+
+#define REBX_FORCE_TABLE_N 12
+#define REBX_FORCE_HASH_M 16
+#define REBX_FORCE_HASH_G 8
+static const uint32_t rebx_force_hash_displacements[8] = {
+    1, 1, 1, 3, 1, 0, 1, 0
+};
+static const int16_t rebx_force_hash_slots[16] = {
+    7, 9, 11, 3, 1, 4, -1, 10, -1, 5, -1, 0,
+    -1, 8, 2, 6
+};
+
+#define REBX_OPERATOR_TABLE_N 14
+#define REBX_OPERATOR_HASH_M 16
+#define REBX_OPERATOR_HASH_G 8
+static const uint32_t rebx_operator_hash_displacements[8] = {
+    0, 1, 1, 4, 4, 3, 1, 2
+};
+static const int16_t rebx_operator_hash_slots[16] = {
+    12, 6, 0, 8, 3, 9, 1, 4, 2, 7, -1, 13,
+    5, 10, -1, 11
+};
+
@@ -250,3 +250,44 @@ void rebx_stochastic_forces(struct reb_simulation* const sim, struct rebx_force*
     }
 }
 
+
+double rebx_stochastic_forces_max_dt(struct rebx_extras* const rebx, const struct rebx_force* const force){
+    if (rebx->sim == NULL){
+        rebx_error(rebx, ""); // rebx_error gives meaningful err
+        return INFINITY;
+    }
+    struct reb_simulation* const sim = rebx->sim;
+    const int N_real = sim->N - sim->N_var;
+    struct reb_particle* const particles = sim->particles;
+    struct reb_particle com = particles[0];
+    double max_dt = INFINITY;
+    const char* const tau_names[3] = {"tau_kappa_x", "tau_kappa_y", "tau_kappa_z"};
+    const char* const kappa_names[3] = {"kappa_x", "kappa_y", "kappa_z"};
+
+    for (int i=0; i<N_real; i++){
+        double* kappa = rebx_get_param(rebx, particles[i].ap, "kappa");
+        if (i>0 && kappa != NULL){
+            // Same auto-correlation time as in rebx_stochastic_forces
+            int err=0;
+            struct reb_orbit o = reb_tools_particle_to_orbit_err(sim->G, particles[i], com, &err);
+            if (!err){
+                double tau = o.P;
+                double* tau_kappa = rebx_get_param(rebx, particles[i].ap, "tau_kappa");
+                if (tau_kappa != NULL){
+                    tau *= *tau_kappa;
+                }
+                max_dt = fmin(max_dt, fabs(tau));
+            }
+            com = reb_get_com_of_pair(com, particles[i]);
+        }
+        for (int k=0; k<3; k++){
+            if (rebx_get_param(rebx, particles[i].ap, kappa_names[k]) != NULL){
+                double* tau = rebx_get_param(rebx, particles[i].ap, tau_names[k]);
+                if (tau != NULL){
+                    max_dt = fmin(max_dt, fabs(*tau));
+                }
+            }
+        }
+    }
+    return max_dt;
+}
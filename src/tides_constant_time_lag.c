@@ -39,10 +39,25 @@
  * In all cases, we need to set masses for all the particles that will feel these tidal forces. After that, we can choose to include tides raised on the primary, on the "planets", or both, by setting the respective bodies' physical radius particles[i].r, k2 (potential Love number of degree 2), constant time lag tau, and rotation rate Omega. See Baronett et al. (2021), Hut (1981), and Bolmont et al. 2015 above.
  *
  * If tau is not set, it will default to zero and yield the conservative piece of the tidal potential.
+ *
+ * By default only tides between the primary and the other bodies are included. Setting tctl_cutoff additionally includes tides between
+ * all other pairs of bodies (e.g., in compact satellite or planetary systems) that are closer than tctl_cutoff. Since tidal forces fall off
+ * as r^-7, a cutoff of a few times the largest physical radius is typically sufficient. Candidate pairs are kept in a neighbor list of pairs closer
+ * than tctl_cutoff + tctl_skin, which is only rebuilt (in O(N) using a spatial hash) once some body has moved more than tctl_skin/2, so the cost stays near O(N).
+ *
+ * The cutoff is sharp: the body-body tidal force and the corresponding terms in rebx_tides_constant_time_lag_potential drop to zero
+ * discontinuously when a pair crosses r = tctl_cutoff. Each crossing therefore changes the total energy by up to the pair's tidal potential at the cutoff,
+ * G*m_i*m_j*k2*R^5/(2*tctl_cutoff^6) (in the notation of Hut 1981, for each body with k2 and R set), so energy conservation is only as good as that
+ * term is small. Choose tctl_cutoff large enough that it is negligible for your accuracy requirements if you track the energy (e.g., with energy_monitor).
  * 
  * **Effect Parameters**
  * 
- * None
+ * ============================ =========== ==================================================================
+ * Field (C type)               Required    Description
+ * ============================ =========== ==================================================================
+ * tctl_cutoff (double)         No          If set, include tides between all pairs of bodies separated by less than tctl_cutoff.
+ * tctl_skin (double)           No          Extra distance for the neighbor list (>= 0). Defaults to 0.1*tctl_cutoff.
+ * ============================ =========== ==================================================================
  *
  * **Particle Parameters**
  *
@@ -61,7 +76,23 @@
 #include <math.h>
 #include <stdlib.h>
 #include <float.h>
+#include <stdint.h>
 #include "reboundx.h"
+#include "core.h"
+
+// Verlet neighbor list of body-body pairs (excluding the primary) closer than rlist = cutoff + skin when it was built
+struct rebx_tctl_neighbors {
+    int N;                  // Number of particles when list was built
+    double rlist;           // cutoff + skin used to build list
+    double skin;
+    int Npairs;
+    int Npairs_max;
+    int* pairs;             // pairs[2*k], pairs[2*k+1] are the particle indices of the kth pair
+    double* x0;             // Positions (3N) when list was built, to check how far bodies have moved
+    int Nbuckets;           // Spatial hash used to build the list
+    int* bucket_head;
+    int* next;
+};
 
 static void rebx_calculate_tides(struct reb_particle* source, struct reb_particle* target, const double G, const double k2, const double tau, const double Omega){
     const double ms = source->m;
@@ -116,6 +147,202 @@ static void rebx_calculate_tides(struct reb_particle* source, struct reb_particl
 }
 
 
+static void rebx_tctl_get_lag(struct rebx_extras* const rebx, struct reb_particle* const target, double* const tau, double* const Omega){
+    *tau = 0.;
+    *Omega = 0.;
+    double* tauptr = rebx_get_param(rebx, target->ap, "tctl_tau");
+    if (tauptr){
+        *tau = *tauptr;
+        double* Omegaptr = rebx_get_param(rebx, target->ap, "Omega");
+        if (Omegaptr){
+            *Omega = *Omegaptr;
+        }
+    }
+}
+
+void rebx_tctl_free_arrays(struct rebx_extras* rebx, struct rebx_force* force){
+    struct rebx_tctl_neighbors* const nl = rebx_get_param(rebx, force->ap, "tctl_neighbors");
+    if (nl != NULL){
+        free(nl->pairs);
+        free(nl->x0);
+        free(nl->bucket_head);
+        free(nl->next);
+        free(nl);
+    }
+}
+
+static inline int rebx_tctl_hash(const int64_t ix, const int64_t iy, const int64_t iz, const int Nbuckets){
+    const uint64_t h = (uint64_t)ix*73856093u ^ (uint64_t)iy*19349663u ^ (uint64_t)iz*83492791u;
+    return (int)(h & (uint64_t)(Nbuckets-1)); // Nbuckets is a power of 2
+}
+
+// Returns 1 if the neighbor list needs to be rebuilt
+static int rebx_tctl_needs_rebuild(const struct rebx_tctl_neighbors* const nl, const struct reb_particle* const particles, const int N, const double rlist){
+    if (nl->N != N || nl->rlist != rlist){
+        return 1;
+    }
+    const double maxd2 = 0.25*nl->skin*nl->skin;
+    for (int i=1; i<N; i++){
+        const double dx = particles[i].x - nl->x0[3*i];
+        const double dy = particles[i].y - nl->x0[3*i+1];
+        const double dz = particles[i].z - nl->x0[3*i+2];
+        if (dx*dx + dy*dy + dz*dz > maxd2){
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int rebx_tctl_build_neighbors(struct rebx_extras* const rebx, struct rebx_tctl_neighbors* const nl, const struct reb_particle* const particles, const int N, const double rlist, const double skin){
+    if (nl->N != N){
+        int Nbuckets = 1;
+        while (Nbuckets < 2*N){
+            Nbuckets *= 2;
+        }
+        free(nl->x0);
+        free(nl->bucket_head);
+        free(nl->next);
+        nl->x0 = rebx_malloc(rebx, 3*N*sizeof(*nl->x0));
+        nl->bucket_head = rebx_malloc(rebx, Nbuckets*sizeof(*nl->bucket_head));
+        nl->next = rebx_malloc(rebx, N*sizeof(*nl->next));
+        if (nl->x0 == NULL || nl->bucket_head == NULL || nl->next == NULL){
+            nl->N = -1;
+            return 0;
+        }
+        nl->Nbuckets = Nbuckets;
+        nl->N = N;
+    }
+    nl->rlist = rlist;
+    nl->skin = skin;
+    nl->Npairs = 0;
+
+    // Bin bodies (not the primary) into cells of size rlist, hashed into buckets
+    for (int b=0; b<nl->Nbuckets; b++){
+        nl->bucket_head[b] = -1;
+    }
+    for (int i=1; i<N; i++){
+        nl->x0[3*i] = particles[i].x;
+        nl->x0[3*i+1] = particles[i].y;
+        nl->x0[3*i+2] = particles[i].z;
+        const int b = rebx_tctl_hash((int64_t)floor(particles[i].x/rlist), (int64_t)floor(particles[i].y/rlist), (int64_t)floor(particles[i].z/rlist), nl->Nbuckets);
+        nl->next[i] = nl->bucket_head[b];
+        nl->bucket_head[b] = i;
+    }
+
+    const double rlist2 = rlist*rlist;
+    for (int i=1; i<N; i++){
+        const int64_t ix = (int64_t)floor(particles[i].x/rlist);
+        const int64_t iy = (int64_t)floor(particles[i].y/rlist);
+        const int64_t iz = (int64_t)floor(particles[i].z/rlist);
+        int visited[27];
+        int Nvisited = 0;
+        for (int dix=-1; dix<=1; dix++){
+        for (int diy=-1; diy<=1; diy++){
+        for (int diz=-1; diz<=1; diz++){
+            const int b = rebx_tctl_hash(ix+dix, iy+diy, iz+diz, nl->Nbuckets);
+            int seen = 0;
+            for (int v=0; v<Nvisited; v++){ // different cells can hash to the same bucket. Only visit each once
+                if (visited[v] == b){
+                    seen = 1;
+                    break;
+                }
+            }
+            if (seen){
+                continue;
+            }
+            visited[Nvisited++] = b;
+            for (int j=nl->bucket_head[b]; j!=-1; j=nl->next[j]){
+                if (j <= i){
+                    continue;
+                }
+                const double dx = particles[j].x - particles[i].x;
+                const double dy = particles[j].y - particles[i].y;
+                const double dz = particles[j].z - particles[i].z;
+                if (dx*dx + dy*dy + dz*dz > rlist2){
+                    continue;
+                }
+                if (nl->Npairs == nl->Npairs_max){
+                    const int Npairs_max = nl->Npairs_max ? 2*nl->Npairs_max : N;
+                    int* const pairs = realloc(nl->pairs, 2*Npairs_max*sizeof(*pairs));
+                    if (pairs == NULL){
+                        rebx_error(rebx, "REBOUNDx Error: Could not allocate memory.\n");
+                        nl->N = -1;
+                        return 0;
+                    }
+                    nl->pairs = pairs;
+                    nl->Npairs_max = Npairs_max;
+                }
+                nl->pairs[2*nl->Npairs] = i;
+                nl->pairs[2*nl->Npairs+1] = j;
+                nl->Npairs++;
+            }
+        }
+        }
+        }
+    }
+    return 1;
+}
+
+static struct rebx_tctl_neighbors* rebx_tctl_get_neighbors(struct rebx_extras* const rebx, struct rebx_force* const tides, const struct reb_particle* const particles, const int N, const double cutoff){
+    const double* const skinptr = rebx_get_param(rebx, tides->ap, "tctl_skin");
+    const double skin = skinptr ? *skinptr : 0.1*cutoff;
+    if (!(cutoff > 0.) || !(skin >= 0.)){ // a negative skin would drop pairs within the cutoff, and the cell size must be positive
+        rebx_error(rebx, "REBOUNDx Error: tctl_cutoff must be positive and tctl_skin can't be negative.\n");
+        return NULL;
+    }
+    const double rlist = cutoff + skin;
+    struct rebx_tctl_neighbors* nl = rebx_get_param(rebx, tides->ap, "tctl_neighbors");
+    if (nl == NULL){
+        nl = calloc(1, sizeof(*nl));
+        if (nl == NULL){
+            rebx_error(rebx, "REBOUNDx Error: Could not allocate memory.\n");
+            return NULL;
+        }
+        nl->N = -1;
+        rebx_set_param_pointer(rebx, &tides->ap, "tctl_neighbors", nl);
+        rebx_set_param_pointer(rebx, &tides->ap, "free_arrays", rebx_tctl_free_arrays);
+    }
+    if (rebx_tctl_needs_rebuild(nl, particles, N, rlist)){
+        if (!rebx_tctl_build_neighbors(rebx, nl, particles, N, rlist, skin)){
+            return NULL;
+        }
+    }
+    return nl;
+}
+
+// Tides between all pairs of bodies other than the primary closer than cutoff
+static void rebx_tides_pairs(struct rebx_extras* const rebx, struct rebx_force* const tides, struct reb_particle* const particles, const int N, const double G, const double cutoff){
+    struct rebx_tctl_neighbors* const nl = rebx_tctl_get_neighbors(rebx, tides, particles, N, cutoff);
+    if (nl == NULL){
+        return;
+    }
+    const double cutoff2 = cutoff*cutoff;
+    for (int k=0; k<nl->Npairs; k++){
+        struct reb_particle* const pi = &particles[nl->pairs[2*k]];
+        struct reb_particle* const pj = &particles[nl->pairs[2*k+1]];
+        if (pi->m == 0 || pj->m == 0){
+            continue;
+        }
+        const double dx = pj->x - pi->x;
+        const double dy = pj->y - pi->y;
+        const double dz = pj->z - pi->z;
+        if (dx*dx + dy*dy + dz*dz > cutoff2){
+            continue;
+        }
+        double tau, Omega;
+        double* k2 = rebx_get_param(rebx, pj->ap, "tctl_k2");
+        if (k2 != NULL && pj->r != 0){ // tides raised on j by i
+            rebx_tctl_get_lag(rebx, pj, &tau, &Omega);
+            rebx_calculate_tides(pi, pj, G, *k2, tau, Omega);
+        }
+        k2 = rebx_get_param(rebx, pi->ap, "tctl_k2");
+        if (k2 != NULL && pi->r != 0){ // tides raised on i by j
+            rebx_tctl_get_lag(rebx, pi, &tau, &Omega);
+            rebx_calculate_tides(pj, pi, G, *k2, tau, Omega);
+        }
+    }
+}
+
 void rebx_tides_constant_time_lag(struct reb_simulation* const sim, struct rebx_force* const tides, struct reb_particle* const particles, const int N){
     struct rebx_extras* const rebx = sim->extras;
     const double G = sim->G;
@@ -167,10 +394,24 @@ void rebx_tides_constant_time_lag(struct reb_simulation* const sim, struct rebx_
         }
         rebx_calculate_tides(source, target, G, *k2, tau, Omega);
     }
+
+    // Calculate tides between all other pairs of bodies if requested
+    double* cutoff = rebx_get_param(rebx, tides->ap, "tctl_cutoff");
+    if (cutoff != NULL){
+        rebx_tides_pairs(rebx, tides, particles, N, G, *cutoff);
+    }
 }
 
 // Calculate potential of conservative piece of tidal interaction
-static double rebx_calculate_tides_potential(struct reb_particle* source, struct reb_particle* target, const double G, const double k2){
+static double rebx_tides_r2(const struct reb_particle* const source, const struct reb_particle* const target){
+    const double dx = target->x - source->x; 
+    const double dy = target->y - source->y;
+    const double dz = target->z - source->z;
+    return dx*dx + dy*dy + dz*dz; 
+}
+
+// dr2 is the squared distance between source and target
+static double rebx_calculate_tides_potential(struct reb_particle* source, struct reb_particle* target, const double G, const double k2, const double dr2){
     const double ms = source->m;
     const double mt = target->m;
     const double Rt = target->r;
@@ -178,11 +419,6 @@ static double rebx_calculate_tides_potential(struct reb_particle* source, struct
     const double mratio = ms/mt; // have already checked for 0 and inf
     const double fac = mratio*k2*Rt*Rt*Rt*Rt*Rt; 
     
-    const double dx = target->x - source->x; 
-    const double dy = target->y - source->y;
-    const double dz = target->z - source->z;
-    const double dr2 = dx*dx + dy*dy + dz*dz; 
-    
     return -1./2.*G*ms*mt/(dr2*dr2*dr2)*fac;
 }
 
@@ -202,6 +438,7 @@ double rebx_tides_constant_time_lag_potential(struct rebx_extras* const rebx){
     if (target->m == 0){                        // No potential with massless primary
         return 0.;
     }
+    const struct rebx_source_geometry* const geometry = rebx_get_source_geometry(rebx, 0); // distances from the star, if shared with other effects
     double* k2 = rebx_get_param(rebx, target->ap, "tctl_k2");
     if (k2 != NULL && target->r != 0){  // tides on star only nonzero if k2 and finite size are set
         for (int i=1; i<N_real; i++){
@@ -209,7 +446,7 @@ double rebx_tides_constant_time_lag_potential(struct rebx_extras* const rebx){
             if (source->m == 0){
                 continue;
             }
-            H += rebx_calculate_tides_potential(source, target, G, *k2);
+            H += rebx_calculate_tides_potential(source, target, G, *k2, geometry ? geometry->r2[i] : rebx_tides_r2(source, target));
         }
     }
 
@@ -221,8 +458,115 @@ double rebx_tides_constant_time_lag_potential(struct rebx_extras* const rebx){
         if (k2 == NULL || target->r == 0 || target->m == 0){
             continue;
         }
-        H += rebx_calculate_tides_potential(source, target, G, *k2);
+        H += rebx_calculate_tides_potential(source, target, G, *k2, geometry ? geometry->r2[i] : rebx_tides_r2(source, target));
+    }
+
+    // Tides between other pairs of bodies if tctl_cutoff is set
+    struct rebx_force* const tides = rebx_get_force(rebx, "tides_constant_time_lag");
+    double* const cutoff = tides ? rebx_get_param(rebx, tides->ap, "tctl_cutoff") : NULL;
+    if (cutoff != NULL){
+        struct rebx_tctl_neighbors* const nl = rebx_tctl_get_neighbors(rebx, tides, particles, N_real, *cutoff);
+        if (nl == NULL){
+            return H;
+        }
+        const double cutoff2 = (*cutoff)*(*cutoff);
+        for (int k=0; k<nl->Npairs; k++){
+            struct reb_particle* const pi = &particles[nl->pairs[2*k]];
+            struct reb_particle* const pj = &particles[nl->pairs[2*k+1]];
+            const double dx = pj->x - pi->x;
+            const double dy = pj->y - pi->y;
+            const double dz = pj->z - pi->z;
+            if (pi->m == 0 || pj->m == 0 || dx*dx + dy*dy + dz*dz > cutoff2){
+                continue;
+            }
+            double* k2 = rebx_get_param(rebx, pj->ap, "tctl_k2");
+            if (k2 != NULL && pj->r != 0){
+                H += rebx_calculate_tides_potential(pi, pj, G, *k2, rebx_tides_r2(pi, pj));
+            }
+            k2 = rebx_get_param(rebx, pi->ap, "tctl_k2");
+            if (k2 != NULL && pi->r != 0){
+                H += rebx_calculate_tides_potential(pj, pi, G, *k2, rebx_tides_r2(pj, pi));
+            }
+        }
     }
 
     return H;
 }
+
+// Inverse of the rate at which the dissipative piece of the tides raised on target by source damps their relative velocity
+static double rebx_tctl_damping_time(const struct reb_particle* const source, const struct reb_particle* const target, const double G, const double k2, const double tau){
+    if (tau == 0. || source->m == 0. || target->m == 0.){
+        return INFINITY;
+    }
+    const double ms = source->m;
+    const double mt = target->m;
+    const double Rt = target->r;
+    const double fac = ms/mt*k2*Rt*Rt*Rt*Rt*Rt;
+    const double dx = target->x - source->x;
+    const double dy = target->y - source->y;
+    const double dz = target->z - source->z;
+    const double dr2 = dx*dx + dy*dy + dz*dz;
+    const double prefac = 3*G/(dr2*dr2*dr2*dr2)*fabs(fac);
+    return 1./(3.*prefac*fabs(tau)*(ms + mt)); // radial term dominates (factor 3 relative to tangential)
+}
+
+double rebx_tides_constant_time_lag_max_dt(struct rebx_extras* const rebx, struct rebx_force* const tides){
+    if (rebx->sim == NULL){
+        rebx_error(rebx, ""); // rebx_error gives meaningful err
+        return INFINITY;
+    }
+    struct reb_simulation* const sim = rebx->sim;
+    const int N_real = sim->N - sim->N_var;
+    struct reb_particle* const particles = sim->particles;
+    const double G = sim->G;
+    double max_dt = INFINITY;
+    double tau, Omega;
+
+    // Tides raised on and by the primary
+    const double* const k2_primary = rebx_get_param(rebx, particles[0].ap, "tctl_k2");
+    double tau_primary = 0.;
+    if (k2_primary != NULL && particles[0].r != 0){
+        rebx_tctl_get_lag(rebx, &particles[0], &tau_primary, &Omega);
+    }
+    for (int i=1; i<N_real; i++){
+        if (k2_primary != NULL && particles[0].r != 0){
+            max_dt = fmin(max_dt, rebx_tctl_damping_time(&particles[i], &particles[0], G, *k2_primary, tau_primary));
+        }
+        const double* const k2 = rebx_get_param(rebx, particles[i].ap, "tctl_k2");
+        if (k2 != NULL && particles[i].r != 0){
+            rebx_tctl_get_lag(rebx, &particles[i], &tau, &Omega);
+            max_dt = fmin(max_dt, rebx_tctl_damping_time(&particles[0], &particles[i], G, *k2, tau));
+        }
+    }
+
+    // Tides between other pairs of bodies if tctl_cutoff is set, from the same neighbor list the force uses
+    double* const cutoff = rebx_get_param(rebx, tides->ap, "tctl_cutoff");
+    if (cutoff != NULL){
+        struct rebx_tctl_neighbors* const nl = rebx_tctl_get_neighbors(rebx, tides, particles, N_real, *cutoff);
+        if (nl == NULL){
+            return max_dt;
+        }
+        const double cutoff2 = (*cutoff)*(*cutoff);
+        for (int k=0; k<nl->Npairs; k++){
+            struct reb_particle* const pi = &particles[nl->pairs[2*k]];
+            struct reb_particle* const pj = &particles[nl->pairs[2*k+1]];
+            const double dx = pj->x - pi->x;
+            const double dy = pj->y - pi->y;
+            const double dz = pj->z - pi->z;
+            if (dx*dx + dy*dy + dz*dz > cutoff2){
+                continue;
+            }
+            double* k2 = rebx_get_param(rebx, pj->ap, "tctl_k2");
+            if (k2 != NULL && pj->r != 0){
+                rebx_tctl_get_lag(rebx, pj, &tau, &Omega);
+                max_dt = fmin(max_dt, rebx_tctl_damping_time(pi, pj, G, *k2, tau));
+            }
+            k2 = rebx_get_param(rebx, pi->ap, "tctl_k2");
+            if (k2 != NULL && pi->r != 0){
+                rebx_tctl_get_lag(rebx, pi, &tau, &Omega);
+                max_dt = fmin(max_dt, rebx_tctl_damping_time(pj, pi, G, *k2, tau));
+            }
+        }
+    }
+    return max_dt;
+}
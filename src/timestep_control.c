@@ -0,0 +1,157 @@
+/**
+ * @file    timestep_control.c
+ * @brief   Limit the simulation timestep to the intrinsic timescales of the REBOUNDx effects that have been added.
+ * @author  Dan Tamayo <tamayo.daniel@gmail.com>
+ *
+ * @section     LICENSE
+ * Copyright (c) 2015 Dan Tamayo, Hanno Rein
+ *
+ * This file is part of reboundx.
+ *
+ * reboundx is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * reboundx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with rebound.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$
+ *
+ * $Miscellaneous Utilities$     // Effect category (must be the first non-blank line after dollar signs and between dollar signs to be detected by script).
+ *
+ * ======================= ===============================================
+ * Authors                 D. Tamayo
+ * Implementation Paper    None
+ * Based on                None
+ * C Example               None
+ * Python Example          None
+ * ======================= ===============================================
+ *
+ * Several effects have intrinsic timescales that REBOUND's timestep choice does not see. This operator asks every force and operator
+ * that has been added (directly, or as the force of an integrate_force operator) for the largest timestep that resolves its timescale,
+ * and caps sim->dt to tc_safety_factor times the smallest of these after every timestep. Effects that report a maximum timestep are
+ * tides_constant_time_lag (inverse of the tidal damping rate of the relative velocity, only if tctl_tau is set),
+ * stochastic_forces (the auto-correlation time of each particle's stochastic force) and type_I_migration (the semi-major axis,
+ * eccentricity and inclination damping timescales). Custom effects can report their own by setting a max_dt_function parameter,
+ * a pointer to a function double f(struct rebx_extras* rebx, struct rebx_force* force) (or struct rebx_operator* for operators).
+ *
+ * Only adaptive integrators (IAS15 with nonzero epsilon) have their timestep capped. The cap applies to the next trial timestep,
+ * so the adaptive timestep is never allowed above it. For integrators with a fixed timestep, changing sim->dt mid-integration would
+ * break e.g. symplecticity, so the operator instead records the suggested maximum in tc_max_dt and warns if sim->dt exceeds it.
+ * If tc_suggest is set, the timestep is left unchanged for all integrators and the operator only records tc_max_dt.
+ * The same value can be obtained at any time with rebx_max_dt, e.g., to choose a fixed timestep before integrating.
+ *
+ * **Effect Parameters**
+ *
+ * ============================ =========== ==================================================================
+ * Field (C type)               Required    Description
+ * ============================ =========== ==================================================================
+ * tc_safety_factor (double)    No          Fraction of the smallest reported timescale to use as maximum timestep. Defaults to 1.
+ * tc_suggest (int)             No          If set to a nonzero value, don't change the timestep or warn. Defaults to 0.
+ * tc_max_dt (double)           No          Most recent maximum timestep (including tc_safety_factor, set by the operator).
+ * ============================ =========== ==================================================================
+ *
+ * **Particle Parameters**
+ *
+ * *None*
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "rebound.h"
+#include "reboundx.h"
+#include "core.h"
+
+static double rebx_tc_force_max_dt(struct rebx_extras* const rebx, struct rebx_force* const force){
+    if (force == NULL){
+        return INFINITY;
+    }
+    double (*max_dt_function)(struct rebx_extras* rebx, struct rebx_force* force) = rebx_get_param(rebx, force->ap, "max_dt_function");
+    if (max_dt_function != NULL){
+        return max_dt_function(rebx, force);
+    }
+    if (force->name == NULL){
+        return INFINITY;
+    }
+    if (strcmp(force->name, "tides_constant_time_lag") == 0){
+        return rebx_tides_constant_time_lag_max_dt(rebx, force);
+    }
+    if (strcmp(force->name, "stochastic_forces") == 0){
+        return rebx_stochastic_forces_max_dt(rebx, force);
+    }
+    if (strcmp(force->name, "type_I_migration") == 0){
+        return rebx_type_I_migration_max_dt(rebx, force);
+    }
+    return INFINITY; // no intrinsic timescale
+}
+
+static double rebx_tc_operator_max_dt(struct rebx_extras* const rebx, struct rebx_operator* const operator){
+    double (*max_dt_function)(struct rebx_extras* rebx, struct rebx_operator* operator) = rebx_get_param(rebx, operator->ap, "max_dt_function");
+    if (max_dt_function != NULL){
+        return max_dt_function(rebx, operator);
+    }
+    struct rebx_force* const force = rebx_get_param(rebx, operator->ap, "force"); // e.g., integrate_force
+    return rebx_tc_force_max_dt(rebx, force);
+}
+
+double rebx_max_dt(struct rebx_extras* const rebx){
+    if (rebx->sim == NULL){
+        rebx_error(rebx, ""); // rebx_error gives meaningful err
+        return INFINITY;
+    }
+    double max_dt = INFINITY;
+    for (struct rebx_node* node = rebx->additional_forces; node != NULL; node = node->next){
+        max_dt = fmin(max_dt, rebx_tc_force_max_dt(rebx, node->object));
+    }
+    struct rebx_node* lists[2] = {rebx->pre_timestep_modifications, rebx->post_timestep_modifications};
+    for (int l=0; l<2; l++){
+        for (struct rebx_node* node = lists[l]; node != NULL; node = node->next){
+            const struct rebx_step* const step = node->object;
+            max_dt = fmin(max_dt, rebx_tc_operator_max_dt(rebx, step->operator));
+        }
+    }
+    return max_dt;
+}
+
+void rebx_timestep_control(struct reb_simulation* const sim, struct rebx_operator* const operator, const double dt){
+    struct rebx_extras* const rebx = sim->extras;
+    double safety_factor = 1.;
+    const double* const safety_factor_ptr = rebx_get_param(rebx, operator->ap, "tc_safety_factor");
+    if (safety_factor_ptr != NULL){
+        safety_factor = *safety_factor_ptr;
+    }
+    const double max_dt = safety_factor*rebx_max_dt(rebx);
+    double* const max_dt_ptr = rebx_get_param(rebx, operator->ap, "tc_max_dt");
+    const double previous_max_dt = (max_dt_ptr != NULL) ? *max_dt_ptr : INFINITY;
+    if (max_dt_ptr != NULL){
+        *max_dt_ptr = max_dt; // output only, so write in place
+    }
+    else{
+        rebx_set_param_double(rebx, &operator->ap, "tc_max_dt", max_dt);
+    }
+
+    const int* const suggest = rebx_get_param(rebx, operator->ap, "tc_suggest");
+    if ((suggest != NULL && *suggest) || !(max_dt > 0.) || isinf(max_dt)){
+        return;
+    }
+    const int adaptive = (sim->integrator == REB_INTEGRATOR_IAS15 && sim->ri_ias15.epsilon != 0);
+    if (!adaptive){
+        // Changing a fixed timestep mid-integration breaks e.g. symplectic integrators, so only warn, once each time the cap drops below dt.
+        if (fabs(sim->dt) > max_dt && !(fabs(sim->dt) > previous_max_dt)){
+            reb_warning(sim, "REBOUNDx Warning: The timestep is larger than the maximum timestep reported by timestep_control, which only changes the timestep for adaptive integrators. Choose a smaller dt (see tc_max_dt or rebx_max_dt).\n");
+        }
+        return;
+    }
+    if (fabs(sim->dt) > max_dt){
+        sim->dt = copysign(max_dt, sim->dt); // keep direction for backwards integrations
+    }
+}
@@ -0,0 +1,263 @@
+/**
+ * @file    trace.c
+ * @brief   Timeline of force evaluations and operator steps, exported in Chrome Trace Event format
+ * @author  Dan Tamayo <tamayo.daniel@gmail.com>
+ *
+ * @section     LICENSE
+ * Copyright (c) 2015 Dan Tamayo, Hanno Rein
+ *
+ * This file is part of reboundx.
+ *
+ * reboundx is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * reboundx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with rebound.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * The exported JSON can be opened in chrome://tracing or https://ui.perfetto.dev.
+ * Each thread records into its own fixed-size buffer, so recording needs no locks. Once a buffer is full,
+ * further events from that thread are counted as dropped.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "rebound.h"
+#include "reboundx.h"
+#include "core.h"
+
+#define REBX_TRACE_NAME_LENGTH 32
+
+struct rebx_trace_event{
+    double ts;                              // Wall clock time at start of event (seconds since rebx_trace_start)
+    double dur;                             // Duration (seconds)
+    double t;                               // Simulation time
+    char name[REBX_TRACE_NAME_LENGTH];
+    enum rebx_trace_category category;
+    int evaluation;                         // Number of earlier force evaluations in the same timestep, -1 for operators
+};
+
+struct rebx_trace_buffer{
+    struct rebx_trace_event* events;
+    int N;
+    long Ndropped;
+    char padding[64];                       // keep threads' counters on separate cache lines
+};
+
+struct rebx_trace{
+    int capacity;                           // Events per thread
+    int Nthreads;
+    struct rebx_trace_buffer* buffers;
+    double t0;                              // Wall clock time when tracing started
+    unsigned long long steps_done;          // sim->steps_done at the last force evaluation, to count evaluations per timestep
+    int evaluation;
+    int recording;
+};
+
+static double rebx_trace_clock(void){
+#if defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1.e-9*ts.tv_nsec;
+#else
+    return (double)clock()/CLOCKS_PER_SEC;
+#endif
+}
+
+static int rebx_trace_thread(void){
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+void rebx_trace_free(struct rebx_extras* const rebx){
+    struct rebx_trace* const trace = rebx->trace;
+    if (trace == NULL){
+        return;
+    }
+    for (int i=0; i<trace->Nthreads; i++){
+        free(trace->buffers[i].events);
+    }
+    free(trace->buffers);
+    free(trace);
+    rebx->trace = NULL;
+}
+
+int rebx_trace_start(struct rebx_extras* const rebx, const int capacity){
+    if (capacity <= 0){
+        rebx_error(rebx, "REBOUNDx Error: Trace capacity must be positive.\n");
+        return 0;
+    }
+    rebx_trace_free(rebx); // restarting discards previous events
+    struct rebx_trace* const trace = rebx_malloc(rebx, sizeof(*trace));
+    if (trace == NULL){
+        return 0;
+    }
+#ifdef _OPENMP
+    trace->Nthreads = omp_get_max_threads();
+#else
+    trace->Nthreads = 1;
+#endif
+    trace->capacity = capacity;
+    trace->buffers = calloc(trace->Nthreads, sizeof(*trace->buffers));
+    if (trace->buffers == NULL){
+        free(trace);
+        rebx_error(rebx, "REBOUNDx Error: Could not allocate memory.\n");
+        return 0;
+    }
+    rebx->trace = trace;
+    for (int i=0; i<trace->Nthreads; i++){
+        trace->buffers[i].events = rebx_malloc(rebx, capacity*sizeof(struct rebx_trace_event));
+        if (trace->buffers[i].events == NULL){
+            rebx_trace_free(rebx);
+            return 0;
+        }
+    }
+    trace->t0 = rebx_trace_clock();
+    trace->steps_done = 0;
+    trace->evaluation = 0;
+    trace->recording = 1;
+    return 1;
+}
+
+void rebx_trace_stop(struct rebx_extras* const rebx){
+    if (rebx->trace != NULL){
+        rebx->trace->recording = 0;
+    }
+}
+
+double rebx_trace_begin(void){
+    return rebx_trace_clock();
+}
+
+// Counts every call of the additional forces. With IAS15 this runs over the substeps of all predictor-corrector iterations
+// (and of rejected trial steps), so it is not the substep index.
+int rebx_trace_next_evaluation(struct rebx_extras* const rebx){
+    struct rebx_trace* const trace = rebx->trace;
+    const struct reb_simulation* const sim = rebx->sim;
+    if (sim->steps_done != trace->steps_done){
+        trace->steps_done = sim->steps_done;
+        trace->evaluation = 0;
+    }
+    return trace->evaluation++;
+}
+
+void rebx_trace_end(struct rebx_extras* const rebx, const double begin, const char* const name, const enum rebx_trace_category category, const int evaluation){
+    struct rebx_trace* const trace = rebx->trace;
+    const double end = rebx_trace_clock();
+    if (!trace->recording){
+        return;
+    }
+    const int thread = rebx_trace_thread();
+    if (thread >= trace->Nthreads){
+        return;
+    }
+    struct rebx_trace_buffer* const buffer = &trace->buffers[thread];
+    if (buffer->N >= trace->capacity){
+        buffer->Ndropped++;
+        return;
+    }
+    struct rebx_trace_event* const event = &buffer->events[buffer->N++];
+    event->ts = begin - trace->t0;
+    event->dur = end - begin;
+    event->t = rebx->sim->t;
+    event->category = category;
+    event->evaluation = evaluation;
+    if (name == NULL){
+        strcpy(event->name, "unnamed");
+    }
+    else{
+        strncpy(event->name, name, REBX_TRACE_NAME_LENGTH-1);
+        event->name[REBX_TRACE_NAME_LENGTH-1] = '\0';
+    }
+}
+
+int rebx_trace_N(struct rebx_extras* const rebx){
+    if (rebx->trace == NULL){
+        return 0;
+    }
+    int N = 0;
+    for (int i=0; i<rebx->trace->Nthreads; i++){
+        N += rebx->trace->buffers[i].N;
+    }
+    return N;
+}
+
+long rebx_trace_Ndropped(struct rebx_extras* const rebx){
+    if (rebx->trace == NULL){
+        return 0;
+    }
+    long N = 0;
+    for (int i=0; i<rebx->trace->Nthreads; i++){
+        N += rebx->trace->buffers[i].Ndropped;
+    }
+    return N;
+}
+
+// Names come from force and operator names, so escape anything JSON can't hold verbatim
+static void rebx_trace_write_name(FILE* of, const char* name){
+    fputc('"', of);
+    for (; *name != '\0'; name++){
+        const unsigned char c = *name;
+        if (c == '"' || c == '\\'){
+            fputc('\\', of);
+            fputc(c, of);
+        }
+        else if (c < 0x20){
+            fprintf(of, "\\u%04x", c);
+        }
+        else{
+            fputc(c, of);
+        }
+    }
+    fputc('"', of);
+}
+
+int rebx_trace_export(struct rebx_extras* const rebx, const char* const filename){
+    const struct rebx_trace* const trace = rebx->trace;
+    if (trace == NULL){
+        rebx_error(rebx, "REBOUNDx Error: No trace to export. Call rebx_trace_start first.\n");
+        return 0;
+    }
+    FILE* of = fopen(filename, "w");
+    if (of == NULL){
+        char str[300];
+        sprintf(str, "REBOUNDx Error: Could not open file '%.200s' for trace output.\n", filename);
+        rebx_error(rebx, str);
+        return 0;
+    }
+    const char* const categories[] = {"force", "pre_timestep", "post_timestep"};
+    fprintf(of, "{\"traceEvents\":[\n");
+    int first = 1;
+    for (int i=0; i<trace->Nthreads; i++){
+        const struct rebx_trace_buffer* const buffer = &trace->buffers[i];
+        for (int j=0; j<buffer->N; j++){
+            const struct rebx_trace_event* const event = &buffer->events[j];
+            fprintf(of, "%s{\"name\":", first ? "" : ",\n");
+            rebx_trace_write_name(of, event->name);
+            // timestamps in microseconds, as the format requires
+            fprintf(of, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d,\"args\":{\"t\":%.17g", categories[event->category], 1.e6*event->ts, 1.e6*event->dur, i, event->t);
+            if (event->evaluation >= 0){
+                fprintf(of, ",\"evaluation\":%d", event->evaluation);
+            }
+            fprintf(of, "}}");
+            first = 0;
+        }
+    }
+    fprintf(of, "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped\":%ld}}\n", rebx_trace_Ndropped(rebx));
+    fclose(of);
+    return 1;
+}
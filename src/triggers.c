@@ -0,0 +1,347 @@
+/**
+ * @file    triggers.c
+ * @brief   Switch forces on or off and change parameters when declarative conditions on the time or orbital elements are met.
+ * @author  Dan Tamayo <tamayo.daniel@gmail.com>
+ *
+ * @section     LICENSE
+ * Copyright (c) 2015 Dan Tamayo, Hanno Rein
+ *
+ * This file is part of reboundx.
+ *
+ * reboundx is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * reboundx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with rebound.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$
+ *
+ * $Miscellaneous Utilities$     // Effect category (must be the first non-blank line after dollar signs and between dollar signs to be detected by script).
+ *
+ * ======================= ===============================================
+ * Authors                 D. Tamayo
+ * Implementation Paper    None
+ * Based on                None
+ * C Example               None
+ * Python Example          None
+ * ======================= ===============================================
+ *
+ * This operator checks a list of conditions after every timestep and carries out the corresponding actions the first time each one is met,
+ * without having to stop the integration and call back into Python. Typical uses are stopping migration when a planet reaches a target
+ * semi-major axis, removing gas disk forces at a disk dispersal time, or changing a mass loss timescale between stellar phases.
+ *
+ * Conditions are added with rebx_trigger_add, and compare a quantity (the simulation time, or a particle's semi-major axis, eccentricity, inclination
+ * or distance from its primary) against a threshold. Each condition can have any number of actions, added with rebx_trigger_enable_force,
+ * rebx_trigger_disable_force and rebx_trigger_set_param. Each condition fires only once. Conditions are checked at the end of each timestep
+ * (or on the time grid passed to rebx_add_operator_interval), so actions take effect at most one step after the threshold is crossed.
+ *
+ * Disabled forces are only removed from the list of forces acting on the simulation and can be enabled again. The list of triggers is not saved to binary files.
+ *
+ * **Effect Parameters**
+ *
+ * *None*
+ *
+ * **Particle Parameters**
+ *
+ * *None*
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "rebound.h"
+#include "reboundx.h"
+#include "core.h"
+#include "linkedlist.h"
+
+enum rebx_trigger_action_type {
+    REBX_TRIGGER_ENABLE_FORCE,
+    REBX_TRIGGER_DISABLE_FORCE,
+    REBX_TRIGGER_SET_PARAM,
+};
+
+struct rebx_trigger_action {
+    enum rebx_trigger_action_type type;
+    struct rebx_force* force;
+    struct rebx_node** apptr;               // Parameter list of a force or operator to modify, or NULL for a particle's
+    uint32_t particle_hash;
+    char* param_name;
+    double value;
+};
+
+struct rebx_trigger {
+    enum rebx_trigger_quantity quantity;
+    double threshold;
+    int above;                              // Fire when quantity >= threshold if 1, <= threshold if 0
+    uint32_t particle_hash;
+    uint32_t primary_hash;                  // 0 for sim->particles[0]
+    int particle_index;                     // Cached indices, checked against the hashes before use
+    int primary_index;
+    int fired;
+    int Nactions;
+    struct rebx_trigger_action* actions;
+};
+
+struct rebx_trigger_list {
+    int N;
+    struct rebx_trigger* triggers;
+};
+
+void rebx_triggers_free_arrays(struct rebx_extras* rebx, struct rebx_operator* operator){
+    struct rebx_trigger_list* const list = rebx_get_param(rebx, operator->ap, "trig_list");
+    if (list != NULL){
+        for (int i=0; i<list->N; i++){
+            for (int j=0; j<list->triggers[i].Nactions; j++){
+                free(list->triggers[i].actions[j].param_name);
+            }
+            free(list->triggers[i].actions);
+        }
+        free(list->triggers);
+        free(list);
+        rebx_set_param_pointer(rebx, &operator->ap, "trig_list", NULL);
+    }
+}
+
+static struct rebx_trigger* rebx_get_trigger(struct rebx_extras* const rebx, struct rebx_operator* const operator, const int trigger){
+    struct rebx_trigger_list* const list = rebx_get_param(rebx, operator->ap, "trig_list");
+    if (list == NULL || trigger < 0 || trigger >= list->N){
+        rebx_error(rebx, "REBOUNDx Error: Trigger not found. Pass the index returned by rebx_trigger_add.\n");
+        return NULL;
+    }
+    return &list->triggers[trigger];
+}
+
+int rebx_trigger_add(struct rebx_extras* const rebx, struct rebx_operator* const operator, const enum rebx_trigger_quantity quantity, const double threshold, const int above, const uint32_t particle_hash, const uint32_t primary_hash){
+    if (quantity != REBX_TRIGGER_TIME && particle_hash == 0){
+        rebx_error(rebx, "REBOUNDx Error: Triggers on orbital elements need the hash of the particle to monitor.\n");
+        return -1;
+    }
+    struct rebx_trigger_list* list = rebx_get_param(rebx, operator->ap, "trig_list");
+    if (list == NULL){
+        list = rebx_malloc(rebx, sizeof(*list));
+        if (list == NULL){
+            return -1;
+        }
+        list->N = 0;
+        list->triggers = NULL;
+        rebx_set_param_pointer(rebx, &operator->ap, "trig_list", list);
+        rebx_set_param_pointer(rebx, &operator->ap, "free_arrays", rebx_triggers_free_arrays);
+    }
+    struct rebx_trigger* const triggers = realloc(list->triggers, (list->N+1)*sizeof(*triggers));
+    if (triggers == NULL){
+        rebx_error(rebx, "REBOUNDx Error: Could not allocate memory.\n");
+        return -1;
+    }
+    list->triggers = triggers;
+    struct rebx_trigger* const trigger = &triggers[list->N];
+    trigger->quantity = quantity;
+    trigger->threshold = threshold;
+    trigger->above = above;
+    trigger->particle_hash = particle_hash;
+    trigger->primary_hash = primary_hash;
+    trigger->particle_index = 0;
+    trigger->primary_index = 0;
+    trigger->fired = 0;
+    trigger->Nactions = 0;
+    trigger->actions = NULL;
+    return list->N++;
+}
+
+static struct rebx_trigger_action* rebx_trigger_add_action(struct rebx_extras* const rebx, struct rebx_operator* const operator, const int trigger_index){
+    struct rebx_trigger* const trigger = rebx_get_trigger(rebx, operator, trigger_index);
+    if (trigger == NULL){
+        return NULL;
+    }
+    struct rebx_trigger_action* const actions = realloc(trigger->actions, (trigger->Nactions+1)*sizeof(*actions));
+    if (actions == NULL){
+        rebx_error(rebx, "REBOUNDx Error: Could not allocate memory.\n");
+        return NULL;
+    }
+    trigger->actions = actions;
+    struct rebx_trigger_action* const action = &actions[trigger->Nactions++];
+    memset(action, 0, sizeof(*action));
+    return action;
+}
+
+int rebx_trigger_enable_force(struct rebx_extras* const rebx, struct rebx_operator* const operator, const int trigger, struct rebx_force* const force){
+    if (force == NULL){
+        rebx_error(rebx, "REBOUNDx Error: Passed NULL force to rebx_trigger_enable_force.\n");
+        return 0;
+    }
+    struct rebx_trigger_action* const action = rebx_trigger_add_action(rebx, operator, trigger);
+    if (action == NULL){
+        return 0;
+    }
+    action->type = REBX_TRIGGER_ENABLE_FORCE;
+    action->force = force;
+    return 1;
+}
+
+int rebx_trigger_disable_force(struct rebx_extras* const rebx, struct rebx_operator* const operator, const int trigger, struct rebx_force* const force){
+    if (force == NULL){
+        rebx_error(rebx, "REBOUNDx Error: Passed NULL force to rebx_trigger_disable_force.\n");
+        return 0;
+    }
+    struct rebx_trigger_action* const action = rebx_trigger_add_action(rebx, operator, trigger);
+    if (action == NULL){
+        return 0;
+    }
+    action->type = REBX_TRIGGER_DISABLE_FORCE;
+    action->force = force;
+    return 1;
+}
+
+int rebx_trigger_set_param(struct rebx_extras* const rebx, struct rebx_operator* const operator, const int trigger, struct rebx_node** apptr, const uint32_t particle_hash, const char* const param_name, const double value){
+    if (apptr == NULL && particle_hash == 0){
+        rebx_error(rebx, "REBOUNDx Error: Triggers setting a particle parameter need the hash of the particle.\n");
+        return 0;
+    }
+    const enum rebx_param_type type = rebx_get_type(rebx, param_name);
+    if (type != REBX_TYPE_DOUBLE && type != REBX_TYPE_INT){
+        char str[300];
+        sprintf(str, "REBOUNDx Error: Triggers can only set registered parameters of type REBX_TYPE_DOUBLE or REBX_TYPE_INT, not '%.100s'.\n", param_name);
+        rebx_error(rebx, str);
+        return 0;
+    }
+    struct rebx_trigger_action* const action = rebx_trigger_add_action(rebx, operator, trigger);
+    if (action == NULL){
+        return 0;
+    }
+    action->param_name = rebx_malloc(rebx, strlen(param_name) + 1);
+    if (action->param_name == NULL){
+        rebx_get_trigger(rebx, operator, trigger)->Nactions--;
+        return 0;
+    }
+    strcpy(action->param_name, param_name);
+    action->type = REBX_TRIGGER_SET_PARAM;
+    action->apptr = apptr;
+    action->particle_hash = particle_hash;
+    action->value = value;
+    return 1;
+}
+
+int rebx_trigger_fired(struct rebx_extras* const rebx, struct rebx_operator* const operator, const int trigger_index){
+    const struct rebx_trigger* const trigger = rebx_get_trigger(rebx, operator, trigger_index);
+    return trigger == NULL ? 0 : trigger->fired;
+}
+
+// Looks particles up by hash, trying the index where it was found last time first
+static struct reb_particle* rebx_trigger_particle(struct reb_simulation* const sim, const uint32_t hash, int* const index){
+    const int N = sim->N - sim->N_var;
+    if (hash == 0){
+        return &sim->particles[0];
+    }
+    if (*index < N && sim->particles[*index].hash == hash){
+        return &sim->particles[*index];
+    }
+    for (int i=0; i<N; i++){
+        if (sim->particles[i].hash == hash){
+            *index = i;
+            return &sim->particles[i];
+        }
+    }
+    return NULL;
+}
+
+static int rebx_trigger_met(struct reb_simulation* const sim, struct rebx_trigger* const trigger){
+    double q;
+    if (trigger->quantity == REBX_TRIGGER_TIME){
+        q = sim->t;
+    }
+    else{
+        const struct reb_particle* const p = rebx_trigger_particle(sim, trigger->particle_hash, &trigger->particle_index);
+        const struct reb_particle* const primary = rebx_trigger_particle(sim, trigger->primary_hash, &trigger->primary_index);
+        if (p == NULL || primary == NULL){ // e.g., particle was removed
+            return 0;
+        }
+        if (trigger->quantity == REBX_TRIGGER_DISTANCE){
+            const double dx = p->x - primary->x;
+            const double dy = p->y - primary->y;
+            const double dz = p->z - primary->z;
+            q = sqrt(dx*dx + dy*dy + dz*dz);
+        }
+        else{
+            const struct reb_orbit o = reb_tools_particle_to_orbit(sim->G, *p, *primary);
+            switch (trigger->quantity){
+                case REBX_TRIGGER_A:
+                    q = o.a;
+                    break;
+                case REBX_TRIGGER_E:
+                    q = o.e;
+                    break;
+                case REBX_TRIGGER_INC:
+                    q = o.inc;
+                    break;
+                default:
+                    return 0;
+            }
+        }
+    }
+    return trigger->above ? (q >= trigger->threshold) : (q <= trigger->threshold);
+}
+
+static void rebx_trigger_apply(struct reb_simulation* const sim, struct rebx_trigger_action* const action){
+    struct rebx_extras* const rebx = sim->extras;
+    switch (action->type){
+        case REBX_TRIGGER_ENABLE_FORCE:
+        {
+            for (struct rebx_node* node = rebx->additional_forces; node != NULL; node = node->next){
+                if (node->object == action->force){
+                    return; // already enabled
+                }
+            }
+            rebx_add_force(rebx, action->force);
+            return;
+        }
+        case REBX_TRIGGER_DISABLE_FORCE:
+            rebx_remove_node(&rebx->additional_forces, action->force); // Force stays allocated so it can be enabled again
+            return;
+        case REBX_TRIGGER_SET_PARAM:
+        {
+            struct rebx_node** apptr = action->apptr;
+            if (apptr == NULL){
+                int index = 0;
+                struct reb_particle* const p = rebx_trigger_particle(sim, action->particle_hash, &index);
+                if (p == NULL){
+                    return;
+                }
+                apptr = (struct rebx_node**)&p->ap;
+            }
+            if (rebx_get_type(rebx, action->param_name) == REBX_TYPE_INT){
+                rebx_set_param_int(rebx, apptr, action->param_name, (int)action->value);
+            }
+            else{
+                rebx_set_param_double(rebx, apptr, action->param_name, action->value);
+            }
+            return;
+        }
+    }
+}
+
+void rebx_triggers(struct reb_simulation* const sim, struct rebx_operator* const operator, const double dt){
+    struct rebx_extras* const rebx = sim->extras;
+    struct rebx_trigger_list* const list = rebx_get_param(rebx, operator->ap, "trig_list");
+    if (list == NULL){
+        return;
+    }
+    for (int i=0; i<list->N; i++){
+        struct rebx_trigger* const trigger = &list->triggers[i];
+        if (trigger->fired || !rebx_trigger_met(sim, trigger)){
+            continue;
+        }
+        trigger->fired = 1;
+        for (int j=0; j<trigger->Nactions; j++){
+            rebx_trigger_apply(sim, &trigger->actions[j]);
+        }
+    }
+}
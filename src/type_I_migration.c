@@ -112,11 +112,8 @@ const double rebx_calculate_inclination_damping_timescale(const double wave, con
     return t_i;
 }
 
-static struct reb_vec3d rebx_calculate_modify_orbits_with_type_I_migration(struct reb_simulation* const sim, struct rebx_force* const force, struct reb_particle* p, struct reb_particle* source){
-    double invtau_a;
-    double tau_e;
-    double tau_inc;
-
+// Inverse semi-major axis damping timescale and eccentricity and inclination damping timescales of p orbiting source
+static void rebx_type_I_migration_timescales(struct reb_simulation* const sim, const struct rebx_force* const force, const struct reb_particle* const p, const struct reb_particle* const source, double* const invtau_a, double* const tau_e, double* const tau_inc){
     /* Default values for the parameters in case the user forgets to define them when using this code */
     double beta = 0.0;
     double h0 = 0.01;
@@ -143,9 +140,6 @@ static struct reb_vec3d rebx_calculate_modify_orbits_with_type_I_migration(struc
     const double mp = p->m;  
     const double ms = source->m;
 
-    const double dvx = p->vx - source->vx;
-    const double dvy = p->vy - source->vy;
-    const double dvz = p->vz - source->vz;
     const double dx = p->x-source->x;
     const double dy = p->y-source->y;
     const double dz = p->z-source->z;
@@ -180,9 +174,24 @@ static struct reb_vec3d rebx_calculate_modify_orbits_with_type_I_migration(struc
 
     const double G = sim->G;
     const double wave = rebx_calculate_damping_timescale(G, sd0, sqrt(r2), s, ms, mp, a0, h2);
-    invtau_a = rebx_calculate_planet_trap(a0, dedge, hedge)/(rebx_calculate_semi_major_axis_damping_timescale(wave, eh, ih, h2, s));
-    tau_e = rebx_calculate_eccentricity_damping_timescale(wave, eh, ih);
-    tau_inc = rebx_calculate_inclination_damping_timescale(wave, eh, ih);
+    *invtau_a = rebx_calculate_planet_trap(a0, dedge, hedge)/(rebx_calculate_semi_major_axis_damping_timescale(wave, eh, ih, h2, s));
+    *tau_e = rebx_calculate_eccentricity_damping_timescale(wave, eh, ih);
+    *tau_inc = rebx_calculate_inclination_damping_timescale(wave, eh, ih);
+}
+
+static struct reb_vec3d rebx_calculate_modify_orbits_with_type_I_migration(struct reb_simulation* const sim, struct rebx_force* const force, struct reb_particle* p, struct reb_particle* source){
+    double invtau_a;
+    double tau_e;
+    double tau_inc;
+    rebx_type_I_migration_timescales(sim, force, p, source, &invtau_a, &tau_e, &tau_inc);
+
+    const double dvx = p->vx - source->vx;
+    const double dvy = p->vy - source->vy;
+    const double dvz = p->vz - source->vz;
+    const double dx = p->x-source->x;
+    const double dy = p->y-source->y;
+    const double dz = p->z-source->z;
+    const double r2 = dx*dx + dy*dy + dz*dz;
 
     struct reb_vec3d a = {0};
 
@@ -212,3 +221,54 @@ void rebx_modify_orbits_with_type_I_migration(struct reb_simulation* const sim,
     const char* reference_name = "primary";
     rebx_com_force(sim, force, coordinates, back_reactions_inclusive, reference_name, rebx_calculate_modify_orbits_with_type_I_migration, particles, N);
 }
+
+double rebx_type_I_migration_max_dt(struct rebx_extras* const rebx, const struct rebx_force* const force){
+    if (rebx->sim == NULL){
+        rebx_error(rebx, ""); // rebx_error gives meaningful err
+        return INFINITY;
+    }
+    struct reb_simulation* const sim = rebx->sim;
+    const int N_real = sim->N - sim->N_var;
+    struct reb_particle* const particles = sim->particles;
+    const int* const ptr = rebx_get_param(rebx, force->ap, "coordinates");
+    enum REBX_COORDINATES coordinates = REBX_COORDINATES_JACOBI; // Default, as in the force
+    if (ptr != NULL){
+        coordinates = *ptr;
+    }
+    // Timescales relative to the same reference as rebx_com_force uses for the force
+    struct reb_particle com = particles[0];
+    int refindex = 0;
+    if (coordinates == REBX_COORDINATES_BARYCENTRIC){
+        com = reb_get_com(sim);
+        refindex = -1;
+    }
+    else if (coordinates == REBX_COORDINATES_PARTICLE){
+        refindex = -1;
+        for (int i=0; i<N_real; i++){
+            if (rebx_get_param(rebx, particles[i].ap, "primary") != NULL){
+                com = particles[i];
+                refindex = i;
+                break;
+            }
+        }
+        if (refindex == -1){
+            return INFINITY; // the force itself reports the missing primary
+        }
+    }
+    double max_dt = INFINITY;
+    for (int i=0; i<N_real; i++){
+        if (i == refindex){
+            continue;
+        }
+        double invtau_a, tau_e, tau_inc;
+        rebx_type_I_migration_timescales(sim, force, &particles[i], &com, &invtau_a, &tau_e, &tau_inc);
+        if (invtau_a != 0.){
+            max_dt = fmin(max_dt, 1./fabs(invtau_a));
+        }
+        max_dt = fmin(max_dt, fmin(fabs(tau_e), fabs(tau_inc)));
+        if (coordinates == REBX_COORDINATES_JACOBI){
+            com = reb_get_com_of_pair(com, particles[i]); // com of interior bodies
+        }
+    }
+    return max_dt;
+}
@@ -65,15 +65,316 @@
  * ye_spin_axis_z (float)       No          The z value for the spin axis vector of an object (Required for full version)
  * ============================ =========== ==================================================================
  *
+ * Quantities that only depend on these parameters (the thermal prefactors and the spin-axis rotation matrices) are computed once and cached on the force.
+ * The cache remembers which parameters and values it was built from, and is rebuilt whenever one of them is added or changed
+ * (whether through rebx_set_param_* or through a pointer from rebx_get_param), or particles are added or removed.
+ * Particles are then processed in batches over contiguous coefficient arrays, threaded with OpenMP, with the rotation matrix products fused into
+ * vector operations (see examples/yarkovsky_benchmark for a comparison with the original implementation).
+ * For testing, the one-particle-at-a-time path over the same cached records is used instead if the environment variable REBX_YE_SCALAR is set to 1
+ * when the force is first evaluated.
+ *
  */
 
 #include <stdio.h>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 #include <float.h>
 #include "reboundx.h"
+#include "core.h"
+
+// A double param a record was built from, so we can tell if it changed (including through a pointer from rebx_get_param)
+struct rebx_ye_input{
+    const double* ptr;          // NULL if the param wasn't set
+    double val;
+};
+
+enum {REBX_YE_DENSITY, REBX_YE_ROTATION_PERIOD, REBX_YE_THERMAL_INERTIA, REBX_YE_ALBEDO, REBX_YE_EMISSIVITY, REBX_YE_K, REBX_YE_SX, REBX_YE_SY, REBX_YE_SZ, REBX_YE_NINPUTS};
+enum {REBX_YE_LSTAR, REBX_YE_C, REBX_YE_STEF_BOLTZ, REBX_YE_NFORCE_INPUTS};
+
+// Everything about a particle's Yarkovsky force that doesn't depend on its position and velocity
+struct rebx_ye_record{
+    struct rebx_node* ap;       // particle's param list the record was built from (changes when a param is added)
+    struct rebx_ye_input inputs[REBX_YE_NINPUTS];
+    const int* flag_ptr;        // ye_flag the record was built from
+    int flag_val;
+    int status;                 // 0: effect not applied, 1: apply, -1: full version with missing params
+    int flag;                   // ye_flag
+    double mag_coeff;           // 3*k*q_yar*lstar/(16*pi*density*c) (k=1/4 for simple version). Magnitude is mag_coeff/(r*distance^2)
+    double flux_coeff;          // (lstar*q_yar)^(3/4)
+    double diurnal_coeff;       // 0.5*(stef_boltz*emissivity/pi^5)^(1/4)*sqrt(rotation_period/Gamma^2)
+    double seasonal_coeff;      // 0.5*(stef_boltz*emissivity/pi^5)^(1/4)/sqrt(Gamma^2). Multiplied by sqrt of orbital period
+    double R1s[3][3];
+    double R2s[3][3];
+    double shat[3];             // unit spin axis (R1s is its cross-product matrix, R2s its outer product)
+};
+
+// Particles the batched kernels act on, as SoA arrays built from the records
+struct rebx_ye_batch{
+    int Nsimple;
+    int* simple_idx;
+    int* simple_flag;
+    double* simple_mag;
+    int Nfull;
+    int* full_idx;
+    double* full_mag;
+    double* full_flux;
+    double* full_diurnal;
+    double* full_seasonal;
+    double* full_sx;
+    double* full_sy;
+    double* full_sz;
+    int Nmissing;               // number of full version particles with missing params
+};
+
+struct rebx_ye_cache{
+    int N;                      // number of records
+    struct rebx_node* force_ap; // force's param list the records were built from
+    struct rebx_ye_input force_inputs[REBX_YE_NFORCE_INPUTS];
+    double inv_c;
+    int scalar;                 // 1 to use the one-particle-at-a-time path (REBX_YE_SCALAR environment variable, for testing)
+    struct rebx_ye_record* records;
+    struct rebx_ye_batch batch;
+    int* ibuf;                  // storage for batch index arrays
+    double* dbuf;               // storage for batch coefficient arrays
+};
+
+static void rebx_ye_set_input(struct rebx_ye_input* const input, const double* const ptr){
+    input->ptr = ptr;
+    input->val = (ptr == NULL) ? 0. : *ptr;
+}
+
+static int rebx_ye_inputs_changed(const struct rebx_ye_input* const inputs, const int N){
+    for (int i=0; i<N; i++){
+        if (inputs[i].ptr != NULL && *inputs[i].ptr != inputs[i].val){
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void rebx_ye_build_record(struct rebx_extras* const rebx, const struct rebx_ye_cache* const cache, struct reb_particle* const target, struct rebx_ye_record* const rec){
+    double* density = rebx_get_param(rebx, target->ap, "ye_body_density");
+    const double* lstar = cache->force_inputs[REBX_YE_LSTAR].ptr;
+    double* rotation_period = rebx_get_param(rebx, target->ap, "ye_rotation_period");
+    double* Gamma = rebx_get_param(rebx, target->ap, "ye_thermal_inertia");
+    double* albedo = rebx_get_param(rebx, target->ap, "ye_albedo");
+    double* emissivity = rebx_get_param(rebx, target->ap, "ye_emissivity");
+    double* k = rebx_get_param(rebx, target->ap, "ye_k");
+    const double* c = cache->force_inputs[REBX_YE_C].ptr;
+    const double* stef_boltz = cache->force_inputs[REBX_YE_STEF_BOLTZ].ptr;
+    int* yark_flag = rebx_get_param(rebx, target->ap, "ye_flag");
+    double* sx = rebx_get_param(rebx, target->ap, "ye_spin_axis_x");
+    double* sy = rebx_get_param(rebx, target->ap, "ye_spin_axis_y");
+    double* sz = rebx_get_param(rebx, target->ap, "ye_spin_axis_z");
+
+    rec->ap = target->ap;
+    rebx_ye_set_input(&rec->inputs[REBX_YE_DENSITY], density);
+    rebx_ye_set_input(&rec->inputs[REBX_YE_ROTATION_PERIOD], rotation_period);
+    rebx_ye_set_input(&rec->inputs[REBX_YE_THERMAL_INERTIA], Gamma);
+    rebx_ye_set_input(&rec->inputs[REBX_YE_ALBEDO], albedo);
+    rebx_ye_set_input(&rec->inputs[REBX_YE_EMISSIVITY], emissivity);
+    rebx_ye_set_input(&rec->inputs[REBX_YE_K], k);
+    rebx_ye_set_input(&rec->inputs[REBX_YE_SX], sx);
+    rebx_ye_set_input(&rec->inputs[REBX_YE_SY], sy);
+    rebx_ye_set_input(&rec->inputs[REBX_YE_SZ], sz);
+    rec->flag_ptr = yark_flag;
+    rec->flag_val = (yark_flag == NULL) ? 0 : *yark_flag;
+    rec->status = 0;
+    //if these necessary conditions are met the Yarkovsky effect will be calculated for a particle in the sim
+    if (density == NULL || albedo == NULL || lstar == NULL || c == NULL || yark_flag == NULL){
+        return;
+    }
+    if (*yark_flag != 1 && *yark_flag != -1 && *yark_flag != 0){
+        return;
+    }
+    rec->flag = *yark_flag;
+    rec->status = 1;
 
-static void rebx_calculate_yarkovsky_effect(struct reb_simulation* sim, struct reb_particle* target, struct reb_particle* star, double G, double *density, double *lstar, double *rotation_period, double *Gamma, double *albedo, double *emissivity, double *k, double *c, double *stef_boltz, int *yark_flag, double *sx, double *sy, double *sz){
+    const double q_yar = 1.0-(*albedo);
+    
+    if (*yark_flag != 0){
+        rec->mag_coeff = (3*q_yar*(*lstar))/(64*M_PI*(*density)*(*c));
+        return;
+    }
+    
+    //makes sure all necessary parameters have been entered
+    if (stef_boltz == NULL || rotation_period == NULL || Gamma == NULL || emissivity == NULL || k == NULL || sx == NULL || sy == NULL || sz == NULL) {
+        rec->status = -1;
+        return;
+    }
+    
+    rec->mag_coeff = (3*(*k)*q_yar*(*lstar))/(16*M_PI*(*density)*(*c));
+    rec->flux_coeff = pow((*lstar)*q_yar, .75);
+    const double thermal = .5*pow(((*stef_boltz)*(*emissivity))/(M_PI*M_PI*M_PI*M_PI*M_PI), .25);
+    rec->diurnal_coeff = thermal*sqrt((*rotation_period)/((*Gamma)*(*Gamma)));
+    rec->seasonal_coeff = thermal/sqrt((*Gamma)*(*Gamma));
+
+    const double Smag = sqrt(((*sx)*(*sx))+ (*sy)*(*sy) + (*sz)*(*sz));
+    const double inv_smag = 1.0/Smag;
+    const double inv_mag_sqrd = 1.0/(Smag*Smag);
+    
+    const double R1s[3][3] = {{0.0, -(*sz)*inv_smag, (*sy)*inv_smag},{(*sz)*inv_smag, 0.0, -(*sx)*inv_smag},{-(*sy)*inv_smag, (*sx)*inv_smag, 0.0}};
+    
+    const double R2s[3][3] = {{(*sx)*(*sx)*inv_mag_sqrd, (*sx)*(*sy)*inv_mag_sqrd, (*sx)*(*sz)*inv_mag_sqrd},{(*sx)*(*sy)*inv_mag_sqrd, (*sy)*(*sy)*inv_mag_sqrd, (*sy)*(*sz)*inv_mag_sqrd},{(*sx)*(*sz)*inv_mag_sqrd, (*sy)*(*sz)*inv_mag_sqrd, (*sz)*(*sz)*inv_mag_sqrd}};
+    
+    for (int i=0; i<3; i++){
+        for (int j=0; j<3; j++){
+            rec->R1s[i][j] = R1s[i][j];
+            rec->R2s[i][j] = R2s[i][j];
+        }
+    }
+    rec->shat[0] = (*sx)*inv_smag;
+    rec->shat[1] = (*sy)*inv_smag;
+    rec->shat[2] = (*sz)*inv_smag;
+}
+
+// Returns 0 if the batch arrays couldn't be allocated
+static int rebx_ye_build_batch(struct rebx_extras* const rebx, struct rebx_ye_cache* const cache){
+    struct rebx_ye_batch* const b = &cache->batch;
+    const int N = cache->N;
+    b->Nsimple = 0;
+    b->Nfull = 0;
+    b->Nmissing = 0;
+    for (int i=1; i<N; i++){
+        const struct rebx_ye_record* const rec = &cache->records[i];
+        if (rec->status == 1){
+            if (rec->flag == 0){
+                b->Nfull++;
+            }
+            else{
+                b->Nsimple++;
+            }
+        }
+        if (rec->status == -1){
+            b->Nmissing++;
+        }
+    }
+    free(cache->ibuf);
+    free(cache->dbuf);
+    cache->ibuf = rebx_malloc(rebx, (2*b->Nsimple + b->Nfull + 1)*sizeof(*cache->ibuf));
+    cache->dbuf = rebx_malloc(rebx, (b->Nsimple + 7*b->Nfull + 1)*sizeof(*cache->dbuf));
+    if (cache->ibuf == NULL || cache->dbuf == NULL){
+        return 0;
+    }
+    b->simple_idx = cache->ibuf;
+    b->simple_flag = cache->ibuf + b->Nsimple;
+    b->full_idx = cache->ibuf + 2*b->Nsimple;
+    b->simple_mag = cache->dbuf;
+    b->full_mag = cache->dbuf + b->Nsimple;
+    b->full_flux = b->full_mag + b->Nfull;
+    b->full_diurnal = b->full_flux + b->Nfull;
+    b->full_seasonal = b->full_diurnal + b->Nfull;
+    b->full_sx = b->full_seasonal + b->Nfull;
+    b->full_sy = b->full_sx + b->Nfull;
+    b->full_sz = b->full_sy + b->Nfull;
+
+    int ks = 0;
+    int kf = 0;
+    for (int i=1; i<N; i++){
+        const struct rebx_ye_record* const rec = &cache->records[i];
+        if (rec->status != 1){
+            continue;
+        }
+        if (rec->flag == 0){
+            b->full_idx[kf] = i;
+            b->full_mag[kf] = rec->mag_coeff;
+            b->full_flux[kf] = rec->flux_coeff;
+            b->full_diurnal[kf] = rec->diurnal_coeff;
+            b->full_seasonal[kf] = rec->seasonal_coeff;
+            b->full_sx[kf] = rec->shat[0];
+            b->full_sy[kf] = rec->shat[1];
+            b->full_sz[kf] = rec->shat[2];
+            kf++;
+        }
+        else{
+            b->simple_idx[ks] = i;
+            b->simple_flag[ks] = rec->flag;
+            b->simple_mag[ks] = rec->mag_coeff;
+            ks++;
+        }
+    }
+    return 1;
+}
+
+void rebx_yarkovsky_effect_free_arrays(struct rebx_extras* rebx, struct rebx_force* force){
+    struct rebx_ye_cache* const cache = rebx_get_param(rebx, force->ap, "ye_cache");
+    if (cache != NULL){
+        free(cache->records);
+        free(cache->ibuf);
+        free(cache->dbuf);
+        free(cache);
+        rebx_set_param_pointer(rebx, &force->ap, "ye_cache", NULL);
+    }
+}
+
+// Checks whether the records were built from the current params. The records remember which params (and values) they were built from,
+// so changes are caught both through rebx_set_param_* and through pointers returned by rebx_get_param, without any param lookups.
+static int rebx_ye_cache_valid(const struct rebx_ye_cache* const cache, const struct rebx_force* const force, const struct reb_particle* const particles, const int N){
+    if (cache->N != N || cache->force_ap != force->ap || rebx_ye_inputs_changed(cache->force_inputs, REBX_YE_NFORCE_INPUTS)){
+        return 0;
+    }
+    for (int i=1; i<N; i++){
+        const struct rebx_ye_record* const rec = &cache->records[i];
+        if (rec->ap != particles[i].ap || rebx_ye_inputs_changed(rec->inputs, REBX_YE_NINPUTS)){
+            return 0;
+        }
+        if (rec->flag_ptr != NULL && *rec->flag_ptr != rec->flag_val){
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Returns the per-particle records, rebuilding them if any parameter they depend on has changed or particles were added/removed.
+// Returns NULL if memory couldn't be allocated.
+static struct rebx_ye_cache* rebx_ye_get_cache(struct rebx_extras* const rebx, struct rebx_force* const force, struct reb_particle* const particles, const int N){
+    struct rebx_ye_cache* cache = rebx_get_param(rebx, force->ap, "ye_cache");
+    if (cache == NULL){
+        cache = rebx_malloc(rebx, sizeof(*cache));
+        if (cache == NULL){
+            return NULL;
+        }
+        cache->N = 0;
+        const char* const scalar = getenv("REBX_YE_SCALAR");
+        cache->scalar = (scalar != NULL && strcmp(scalar, "1") == 0);
+        cache->records = NULL;
+        cache->ibuf = NULL;
+        cache->dbuf = NULL;
+        // Adding params changes force->ap, so do this before building the records
+        rebx_set_param_pointer(rebx, &force->ap, "ye_cache", cache);
+        rebx_set_param_pointer(rebx, &force->ap, "free_arrays", rebx_yarkovsky_effect_free_arrays);
+    }
+    else if (rebx_ye_cache_valid(cache, force, particles, N)){
+        return cache;
+    }
+
+    if (cache->N != N){
+        free(cache->records);
+        cache->N = 0;
+        cache->records = rebx_malloc(rebx, N*sizeof(*cache->records));
+        if (cache->records == NULL){
+            return NULL;
+        }
+        cache->N = N;
+    }
+    cache->force_ap = force->ap;
+    rebx_ye_set_input(&cache->force_inputs[REBX_YE_LSTAR], rebx_get_param(rebx, force->ap, "ye_lstar"));
+    rebx_ye_set_input(&cache->force_inputs[REBX_YE_C], rebx_get_param(rebx, force->ap, "ye_c"));
+    rebx_ye_set_input(&cache->force_inputs[REBX_YE_STEF_BOLTZ], rebx_get_param(rebx, force->ap, "ye_stef_boltz"));
+    for (int i=1; i<N; i++){
+        rebx_ye_build_record(rebx, cache, &particles[i], &cache->records[i]);
+    }
+    if (!rebx_ye_build_batch(rebx, cache)){
+        cache->N = 0; // force a rebuild next time
+        return NULL;
+    }
+    const double* const c = cache->force_inputs[REBX_YE_C].ptr;
+    cache->inv_c = (c == NULL) ? 0. : 1./(*c);
+    return cache;
+}
+
+static void rebx_calculate_yarkovsky_effect(struct reb_particle* target, struct reb_particle* star, double G, const struct rebx_ye_record* const rec, const double inv_c){
     
     int i; //variables needed for future iteration loops
     int j;
@@ -81,8 +382,6 @@ static void rebx_calculate_yarkovsky_effect(struct reb_simulation* sim, struct r
 
     double radius = target->r;
     
-    double q_yar = 1.0-(*albedo);
-    
     double dx = target->x - star->x;
     double dy = target->y - star->y;
     double dz = target->z - star->z;
@@ -93,156 +392,224 @@ static void rebx_calculate_yarkovsky_effect(struct reb_simulation* sim, struct r
     
     double distance = sqrt((dx*dx)+(dy*dy)+(dz*dz)); //distance of asteroid from the star
     
-    double rdotv = ((dx*dvx)+(dy*dvy)+(dz*dvz))/((*c)*distance); //dot product of position and velocity vectors- the term in the denominator is needed when calculating the i-vector
+    double rdotv = ((dx*dvx)+(dy*dvy)+(dz*dvz))*inv_c/distance; //dot product of position and velocity vectors- the term in the denominator is needed when calculating the i-vector
     
     double i_vector[3][1];
     
-    i_vector[0][0] = ((1-rdotv)*(dx/distance))-(dvx/(*c));
-    i_vector[1][0] = ((1-rdotv)*(dy/distance))-(dvy/(*c));
-    i_vector[2][0] = ((1-rdotv)*(dz/distance))-(dvz/(*c));
+    i_vector[0][0] = ((1-rdotv)*(dx/distance))-(dvx*inv_c);
+    i_vector[1][0] = ((1-rdotv)*(dy/distance))-(dvy*inv_c);
+    i_vector[2][0] = ((1-rdotv)*(dz/distance))-(dvz*inv_c);
     
-    double yarkovsky_magnitude; //magnitude of force created by the effect
+    double yarkovsky_magnitude = rec->mag_coeff/(radius*distance*distance); //magnitude of force created by the effect
 
-    double yark_matrix[3][3] = {{0.0, 0.0, 0.0},{0.0, 0.0, 0.0},{0.0, 0.0, 0.0}};
-    
-    
-    if (*yark_flag == 1) {
-        
-        yark_matrix[1][0] = 1.0; // maximizes the effect pushing outwards
-        
-        yarkovsky_magnitude = (3*q_yar*(*lstar))/(64*M_PI*radius*(*density)*(*c)*distance*distance);
+    if (rec->flag == 1) { // maximizes the effect pushing outwards (yark_matrix[1][0] = 1)
+        target->ay += yarkovsky_magnitude*i_vector[0][0];
+        return;
     }
     
-    if (*yark_flag == -1) {
-        
-        yark_matrix[0][1] = 1.0; //maximizes the effect pushing inwards
-        
-        yarkovsky_magnitude = (3*q_yar*(*lstar))/(64*M_PI*radius*(*density)*(*c)*distance*distance);
+    if (rec->flag == -1) { //maximizes the effect pushing inwards (yark_matrix[0][1] = 1)
+        target->ax += yarkovsky_magnitude*i_vector[1][0];
+        return;
     }
     
     //will run through full equations to create the yark_matrix
-    if (*yark_flag == 0) {
+    double yark_matrix[3][3];
         
-        //makes sure all necessary parameters have been entered
-        if (stef_boltz == NULL || rotation_period == NULL || Gamma == NULL || albedo == NULL || emissivity == NULL || k == NULL || sx == NULL || sy == NULL || sz == NULL) {
-            reb_error(sim, "REBOUNDx Error: One or more parameters missing for this version of the Yarkovsky effect in Rebx. Please make sure you've given values to all variables for this version before running simulations. See documentation and YarkovskyEffect.ipynb. If you'd rather use the simplified version of this effect (requires fewer parameters), then please set 'yark_flag' to -1 or 1.\n\n");
-            return;
-        }
-        
-        struct reb_orbit o = reb_tools_particle_to_orbit(G, *target, *star);
-        
-        yarkovsky_magnitude = (3*(*k)*q_yar*(*lstar))/(16*M_PI*radius*(*density)*(*c)*distance*distance);
-
-        double Smag = sqrt(((*sx)*(*sx))+ (*sy)*(*sy) + (*sz)*(*sz));
+    struct reb_orbit o = reb_tools_particle_to_orbit(G, *target, *star);
     
-        double hx = (dy*dvz)-(dz*dvy);
-        double hy = (dz*dvx)-(dx*dvz);
-        double hz = (dx*dvy)-(dy*dvx);
-        double Hmag = sqrt((hx*hx)+ (hy*hy) + (hz*hz));
+    double hx = (dy*dvz)-(dz*dvy);
+    double hy = (dz*dvx)-(dx*dvz);
+    double hz = (dx*dvy)-(dy*dvx);
+    double Hmag = sqrt((hx*hx)+ (hy*hy) + (hz*hz));
     
-        double inv_smag = 1.0/Smag;
-        double inv_mag_sqrd = 1.0/(Smag*Smag);
-        double inv_hmag = 1.0/Hmag;
-        double inv_hmag_sqrd = 1.0/(Hmag*Hmag);
+    double inv_hmag = 1.0/Hmag;
+    double inv_hmag_sqrd = 1.0/(Hmag*Hmag);
     
-        double R1s[3][3] = {{0.0, -(*sz)*inv_smag, (*sy)*inv_smag},{(*sz)*inv_smag, 0.0, -(*sx)*inv_smag},{-(*sy)*inv_smag, (*sx)*inv_smag, 0.0}};
-        
-        double R2s[3][3] = {{(*sx)*(*sx)*inv_mag_sqrd, (*sx)*(*sy)*inv_mag_sqrd, (*sx)*(*sz)*inv_mag_sqrd},{(*sx)*(*sy)*inv_mag_sqrd, (*sy)*(*sy)*inv_mag_sqrd, (*sy)*(*sz)*inv_mag_sqrd},{(*sx)*(*sz)*inv_mag_sqrd, (*sy)*(*sz)*inv_mag_sqrd, (*sz)*(*sz)*inv_mag_sqrd}};
-        
-        double R1h[3][3] = {{0.0, -hz*inv_hmag, hy*inv_hmag},{hz*inv_hmag, 0.0, -hx*inv_hmag},{-hy*inv_hmag, hx*inv_hmag, 0.0}};
-        
-        double R2h[3][3] = {{hx*hx*inv_hmag_sqrd, hx*hy*inv_hmag_sqrd, hx*hz*inv_hmag_sqrd},{hx*hy*inv_hmag_sqrd, hy*hy*inv_hmag_sqrd, hy*hz*inv_hmag_sqrd},{hx*hz*inv_hmag_sqrd, hy*hz*inv_hmag_sqrd, hz*hz*inv_hmag_sqrd}};
+    double R1h[3][3] = {{0.0, -hz*inv_hmag, hy*inv_hmag},{hz*inv_hmag, 0.0, -hx*inv_hmag},{-hy*inv_hmag, hx*inv_hmag, 0.0}};
+    
+    double R2h[3][3] = {{hx*hx*inv_hmag_sqrd, hx*hy*inv_hmag_sqrd, hx*hz*inv_hmag_sqrd},{hx*hy*inv_hmag_sqrd, hy*hy*inv_hmag_sqrd, hy*hz*inv_hmag_sqrd},{hx*hz*inv_hmag_sqrd, hy*hz*inv_hmag_sqrd, hz*hz*inv_hmag_sqrd}};
 
-        double tanPhi = 1.0/(1.0+(.5*pow(((*stef_boltz)*(*emissivity))/(M_PI*M_PI*M_PI*M_PI*M_PI), .25))*sqrt((*rotation_period)/((*Gamma)*(*Gamma)))*pow((*lstar*q_yar)/(distance*distance), .75));
+    double flux = rec->flux_coeff/(distance*sqrt(distance)); // (lstar*q_yar/distance^2)^(3/4)
     
-        double tanEpsilon = 1.0/(1.0+(.5*pow((*stef_boltz*(*emissivity))/(M_PI*M_PI*M_PI*M_PI*M_PI), .25))*sqrt((o.P)/((*Gamma)*(*Gamma)))*pow((*lstar*q_yar)/(distance*distance), .75));
+    double tanPhi = 1.0/(1.0+rec->diurnal_coeff*flux);
     
-        double Phi = atan(tanPhi);
-        double Epsilon = atan(tanEpsilon);
-        
-        double cos_phi = cos(Phi);
-        double sin_phi = sin(Phi);
-        double cos_epsilon = cos(Epsilon);
-        double sin_epsilon = sin(Epsilon);
+    double tanEpsilon = 1.0/(1.0+rec->seasonal_coeff*sqrt(o.P)*flux);
     
-        double Rys[3][3]; //diurnal conntribution for effect
+    double Phi = atan(tanPhi);
+    double Epsilon = atan(tanEpsilon);
     
-        for (i=0; i<3; i++){
-            for (j=0; j<3; j++){
-                Rys[i][j] = (cos_phi*unit_matrix[i][j]) + (sin_phi*R1s[i][j]) + ((1.0-cos_phi)*R2s[i][j]);
-            }
+    double cos_phi = cos(Phi);
+    double sin_phi = sin(Phi);
+    double cos_epsilon = cos(Epsilon);
+    double sin_epsilon = sin(Epsilon);
+    
+    double Rys[3][3]; //diurnal conntribution for effect
+    
+    for (i=0; i<3; i++){
+        for (j=0; j<3; j++){
+            Rys[i][j] = (cos_phi*unit_matrix[i][j]) + (sin_phi*rec->R1s[i][j]) + ((1.0-cos_phi)*rec->R2s[i][j]);
         }
+    }
     
-        double Ryh[3][3];
+    double Ryh[3][3];
     
-        for (i=0; i<3; i++){ //seasonal contribution for effect
-            for (j=0; j<3; j++){
-                Ryh[i][j] = (cos_epsilon*unit_matrix[i][j]) - (sin_epsilon*R1h[i][j]) + ((1-cos_epsilon)*R2h[i][j]);
-            }
+    for (i=0; i<3; i++){ //seasonal contribution for effect
+        for (j=0; j<3; j++){
+            Ryh[i][j] = (cos_epsilon*unit_matrix[i][j]) - (sin_epsilon*R1h[i][j]) + ((1-cos_epsilon)*R2h[i][j]);
         }
+    }
     
-        for (i=0; i<3; i++){
-            for(j=0; j<3; j++){
-                yark_matrix[i][j] = (Rys[i][0]*Ryh[0][j]) + (Rys[i][1]*Ryh[1][j]) + (Rys[i][2]*Ryh[2][j]);
-            }
+    for (i=0; i<3; i++){
+        for(j=0; j<3; j++){
+            yark_matrix[i][j] = (Rys[i][0]*Ryh[0][j]) + (Rys[i][1]*Ryh[1][j]) + (Rys[i][2]*Ryh[2][j]);
         }
     }
     
     double direction_matrix[3][1];
     
- 
-    
     //calcuates a vector which gives the direction of the acceleration created by the effect
     for (i=0; i<3; i++){
         direction_matrix[i][0] = (yark_matrix[i][0]*i_vector[0][0]) + (yark_matrix[i][1]*i_vector[1][0]) + (yark_matrix[i][2]*i_vector[2][0]);
     }
     
-    double yarkovsky_acceleration[3][1];
-    
-    for (i=0; i<3; i++){
-     
-        //final result for particle's change in acceleration due to the effect
-        yarkovsky_acceleration[i][0] = (yarkovsky_magnitude*direction_matrix[i][0]);
-        
+    //adds Yarkovsky aceleration to the asteroid's acceleration in the sim
+    target->ax += yarkovsky_magnitude*direction_matrix[0][0];
+    target->ay += yarkovsky_magnitude*direction_matrix[1][0];
+    target->az += yarkovsky_magnitude*direction_matrix[2][0];
+}
+
+// Simple version for a batch of particles. yark_matrix has a single nonzero entry, so only one component is kicked
+static void rebx_ye_simple_kernel(struct reb_particle* const particles, const struct rebx_ye_batch* const b, const double inv_c){
+    const struct reb_particle star = particles[0];
+#pragma omp parallel for schedule(static)
+    for (int k=0; k<b->Nsimple; k++){
+        struct reb_particle* const p = &particles[b->simple_idx[k]];
+        const double r = p->r;
+        if (r == 0.){
+            continue;
+        }
+        const double dx = p->x - star.x;
+        const double dy = p->y - star.y;
+        const double dz = p->z - star.z;
+        const double dvx = p->vx - star.vx;
+        const double dvy = p->vy - star.vy;
+        const double dvz = p->vz - star.vz;
+        const double d2 = dx*dx + dy*dy + dz*dz;
+        const double inv_d = 1./sqrt(d2);
+        const double rdotv = (dx*dvx + dy*dvy + dz*dvz)*inv_c*inv_d;
+        const double mag = b->simple_mag[k]/(r*d2);
+        if (b->simple_flag[k] == 1){
+            p->ay += mag*((1.-rdotv)*dx*inv_d - dvx*inv_c);
+        }
+        else{
+            p->ax += mag*((1.-rdotv)*dy*inv_d - dvy*inv_c);
+        }
     }
-    
-        //adds Yarkovsky aceleration to the asteroid's acceleration in the sim
-        target->ax += yarkovsky_acceleration[0][0];
-        target->ay += yarkovsky_acceleration[1][0];
-        target->az += yarkovsky_acceleration[2][0];
-    
-    
-    
+}
+
+// Full version for a batch of particles. The products of the Rodrigues rotation matrices Rys*Ryh with the i vector are fused into
+// cross and dot products with the unit spin and orbit normal vectors, cos(atan(x)) and sin(atan(x)) are evaluated algebraically,
+// and the orbital period is obtained from the vis-viva equation rather than a full orbital element conversion.
+static void rebx_ye_full_kernel(struct reb_particle* const particles, const struct rebx_ye_batch* const b, const double G, const double inv_c){
+    const struct reb_particle star = particles[0];
+#pragma omp parallel for schedule(static)
+    for (int k=0; k<b->Nfull; k++){
+        struct reb_particle* const p = &particles[b->full_idx[k]];
+        const double r = p->r;
+        if (r == 0.){
+            continue;
+        }
+        const double dx = p->x - star.x;
+        const double dy = p->y - star.y;
+        const double dz = p->z - star.z;
+        const double dvx = p->vx - star.vx;
+        const double dvy = p->vy - star.vy;
+        const double dvz = p->vz - star.vz;
+        const double d2 = dx*dx + dy*dy + dz*dz;
+        const double d = sqrt(d2);
+        const double inv_d = 1./d;
+        const double v2 = dvx*dvx + dvy*dvy + dvz*dvz;
+        const double rdotv = (dx*dvx + dy*dvy + dz*dvz)*inv_c*inv_d;
+        
+        // i vector
+        const double ix = (1.-rdotv)*dx*inv_d - dvx*inv_c;
+        const double iy = (1.-rdotv)*dy*inv_d - dvy*inv_c;
+        const double iz = (1.-rdotv)*dz*inv_d - dvz*inv_c;
+
+        // orbital period (same convention as reb_tools_particle_to_orbit)
+        const double mu = G*(star.m + p->m);
+        const double a = -mu/(v2 - 2.*mu*inv_d);
+        const double P = copysign(2.*M_PI*sqrt(fabs(a*a*a/mu)), a);
+
+        const double flux = b->full_flux[k]*inv_d/sqrt(d);
+        const double tanPhi = 1./(1. + b->full_diurnal[k]*flux);
+        const double tanEpsilon = 1./(1. + b->full_seasonal[k]*sqrt(P)*flux);
+        const double cos_phi = 1./sqrt(1. + tanPhi*tanPhi);
+        const double sin_phi = tanPhi*cos_phi;
+        const double cos_epsilon = 1./sqrt(1. + tanEpsilon*tanEpsilon);
+        const double sin_epsilon = tanEpsilon*cos_epsilon;
+
+        // unit orbit normal
+        double hx = dy*dvz - dz*dvy;
+        double hy = dz*dvx - dx*dvz;
+        double hz = dx*dvy - dy*dvx;
+        const double inv_hmag = 1./sqrt(hx*hx + hy*hy + hz*hz);
+        hx *= inv_hmag;
+        hy *= inv_hmag;
+        hz *= inv_hmag;
+
+        // u = Ryh*i = cos(eps) i - sin(eps) h x i + (1-cos(eps)) h (h.i)
+        const double hdoti = hx*ix + hy*iy + hz*iz;
+        const double ux = cos_epsilon*ix - sin_epsilon*(hy*iz - hz*iy) + (1.-cos_epsilon)*hdoti*hx;
+        const double uy = cos_epsilon*iy - sin_epsilon*(hz*ix - hx*iz) + (1.-cos_epsilon)*hdoti*hy;
+        const double uz = cos_epsilon*iz - sin_epsilon*(hx*iy - hy*ix) + (1.-cos_epsilon)*hdoti*hz;
+
+        // Rys*u = cos(phi) u + sin(phi) s x u + (1-cos(phi)) s (s.u)
+        const double sx = b->full_sx[k];
+        const double sy = b->full_sy[k];
+        const double sz = b->full_sz[k];
+        const double sdotu = sx*ux + sy*uy + sz*uz;
+        const double mag = b->full_mag[k]/(r*d2);
+        p->ax += mag*(cos_phi*ux + sin_phi*(sy*uz - sz*uy) + (1.-cos_phi)*sdotu*sx);
+        p->ay += mag*(cos_phi*uy + sin_phi*(sz*ux - sx*uz) + (1.-cos_phi)*sdotu*sy);
+        p->az += mag*(cos_phi*uz + sin_phi*(sx*uy - sy*ux) + (1.-cos_phi)*sdotu*sz);
     }
+}
 
 void rebx_yarkovsky_effect(struct reb_simulation* const sim, struct rebx_force* const force, struct reb_particle* const particles, const int N){
         
     struct rebx_extras* const rebx = sim->extras;
     double G = sim->G;
     
+    const struct rebx_ye_cache* const cache = rebx_ye_get_cache(rebx, force, particles, N);
+    if (cache == NULL){
+        return;
+    }
+    
+    if (!cache->scalar){
+        if (cache->batch.Nmissing > 0){
+            reb_error(sim, "REBOUNDx Error: One or more parameters missing for this version of the Yarkovsky effect in Rebx. Please make sure you've given values to all variables for this version before running simulations. See documentation and YarkovskyEffect.ipynb. If you'd rather use the simplified version of this effect (requires fewer parameters), then please set 'yark_flag' to -1 or 1.\n\n");
+            return;
+        }
+        rebx_ye_simple_kernel(particles, &cache->batch, cache->inv_c);
+        rebx_ye_full_kernel(particles, &cache->batch, G, cache->inv_c);
+        return;
+    }
+
+    // Reference implementation, one particle at a time
+    struct reb_particle* star = &particles[0];
     
     for (int i=1; i<N; i++){
-        
         struct reb_particle* target = &particles[i];
-        struct reb_particle* star = &particles[0];
-        
-        double* density = rebx_get_param(rebx, target->ap, "ye_body_density");
-        double* lstar = rebx_get_param(rebx, force->ap, "ye_lstar");
-        double* rotation_period = rebx_get_param(rebx, target->ap, "ye_rotation_period");
-        double* Gamma = rebx_get_param(rebx, target->ap, "ye_thermal_inertia");
-        double* albedo = rebx_get_param(rebx, target->ap, "ye_albedo");
-        double* emissivity = rebx_get_param(rebx, target->ap, "ye_emissivity");
-        double* k = rebx_get_param(rebx, target->ap, "ye_k");
-        double* c = rebx_get_param(rebx, force->ap, "ye_c");
-        double* stef_boltz = rebx_get_param(rebx, force->ap, "ye_stef_boltz");
-        int* yark_flag = rebx_get_param(rebx, target->ap, "ye_flag");
-        double* sx = rebx_get_param(rebx, target->ap, "ye_spin_axis_x");
-        double* sy = rebx_get_param(rebx, target->ap, "ye_spin_axis_y");
-        double* sz = rebx_get_param(rebx, target->ap, "ye_spin_axis_z");
+        const struct rebx_ye_record* const rec = &cache->records[i];
         
-        //if these necessary conditions are met the Yarkovsky effect will be calculated for a particle in the sim
-        if (density != NULL && target->r != 0 && albedo != NULL && lstar != NULL && c != NULL && yark_flag != NULL){
-            rebx_calculate_yarkovsky_effect(sim, target, star, G, density, lstar, rotation_period, Gamma, albedo, emissivity, k, c, stef_boltz, yark_flag, sx, sy, sz);
+        if (rec->status == 0 || target->r == 0){
+            continue;
+        }
+        if (rec->status == -1){
+            reb_error(sim, "REBOUNDx Error: One or more parameters missing for this version of the Yarkovsky effect in Rebx. Please make sure you've given values to all variables for this version before running simulations. See documentation and YarkovskyEffect.ipynb. If you'd rather use the simplified version of this effect (requires fewer parameters), then please set 'yark_flag' to -1 or 1.\n\n");
+            return;
         }
+        rebx_calculate_yarkovsky_effect(target, star, G, rec, cache->inv_c);
     }
 }